@@ -0,0 +1,451 @@
+const char kBrowsePy[] =
+"\x23\x21\x2f\x75\x73\x72\x2f\x62\x69\x6e\x2f\x65\x6e\x76\x20\x70"
+"\x79\x74\x68\x6f\x6e\x0a\x23\x0a\x23\x20\x43\x6f\x70\x79\x72\x69"
+"\x67\x68\x74\x20\x32\x30\x30\x31\x20\x47\x6f\x6f\x67\x6c\x65\x20"
+"\x49\x6e\x63\x2e\x20\x41\x6c\x6c\x20\x52\x69\x67\x68\x74\x73\x20"
+"\x52\x65\x73\x65\x72\x76\x65\x64\x2e\x0a\x23\x0a\x23\x20\x4c\x69"
+"\x63\x65\x6e\x73\x65\x64\x20\x75\x6e\x64\x65\x72\x20\x74\x68\x65"
+"\x20\x41\x70\x61\x63\x68\x65\x20\x4c\x69\x63\x65\x6e\x73\x65\x2c"
+"\x20\x56\x65\x72\x73\x69\x6f\x6e\x20\x32\x2e\x30\x20\x28\x74\x68"
+"\x65\x20\x22\x4c\x69\x63\x65\x6e\x73\x65\x22\x29\x3b\x0a\x23\x20"
+"\x79\x6f\x75\x20\x6d\x61\x79\x20\x6e\x6f\x74\x20\x75\x73\x65\x20"
+"\x74\x68\x69\x73\x20\x66\x69\x6c\x65\x20\x65\x78\x63\x65\x70\x74"
+"\x20\x69\x6e\x20\x63\x6f\x6d\x70\x6c\x69\x61\x6e\x63\x65\x20\x77"
+"\x69\x74\x68\x20\x74\x68\x65\x20\x4c\x69\x63\x65\x6e\x73\x65\x2e"
+"\x0a\x23\x20\x59\x6f\x75\x20\x6d\x61\x79\x20\x6f\x62\x74\x61\x69"
+"\x6e\x20\x61\x20\x63\x6f\x70\x79\x20\x6f\x66\x20\x74\x68\x65\x20"
+"\x4c\x69\x63\x65\x6e\x73\x65\x20\x61\x74\x0a\x23\x0a\x23\x20\x20"
+"\x20\x20\x20\x68\x74\x74\x70\x3a\x2f\x2f\x77\x77\x77\x2e\x61\x70"
+"\x61\x63\x68\x65\x2e\x6f\x72\x67\x2f\x6c\x69\x63\x65\x6e\x73\x65"
+"\x73\x2f\x4c\x49\x43\x45\x4e\x53\x45\x2d\x32\x2e\x30\x0a\x23\x0a"
+"\x23\x20\x55\x6e\x6c\x65\x73\x73\x20\x72\x65\x71\x75\x69\x72\x65"
+"\x64\x20\x62\x79\x20\x61\x70\x70\x6c\x69\x63\x61\x62\x6c\x65\x20"
+"\x6c\x61\x77\x20\x6f\x72\x20\x61\x67\x72\x65\x65\x64\x20\x74\x6f"
+"\x20\x69\x6e\x20\x77\x72\x69\x74\x69\x6e\x67\x2c\x20\x73\x6f\x66"
+"\x74\x77\x61\x72\x65\x0a\x23\x20\x64\x69\x73\x74\x72\x69\x62\x75"
+"\x74\x65\x64\x20\x75\x6e\x64\x65\x72\x20\x74\x68\x65\x20\x4c\x69"
+"\x63\x65\x6e\x73\x65\x20\x69\x73\x20\x64\x69\x73\x74\x72\x69\x62"
+"\x75\x74\x65\x64\x20\x6f\x6e\x20\x61\x6e\x20\x22\x41\x53\x20\x49"
+"\x53\x22\x20\x42\x41\x53\x49\x53\x2c\x0a\x23\x20\x57\x49\x54\x48"
+"\x4f\x55\x54\x20\x57\x41\x52\x52\x41\x4e\x54\x49\x45\x53\x20\x4f"
+"\x52\x20\x43\x4f\x4e\x44\x49\x54\x49\x4f\x4e\x53\x20\x4f\x46\x20"
+"\x41\x4e\x59\x20\x4b\x49\x4e\x44\x2c\x20\x65\x69\x74\x68\x65\x72"
+"\x20\x65\x78\x70\x72\x65\x73\x73\x20\x6f\x72\x20\x69\x6d\x70\x6c"
+"\x69\x65\x64\x2e\x0a\x23\x20\x53\x65\x65\x20\x74\x68\x65\x20\x4c"
+"\x69\x63\x65\x6e\x73\x65\x20\x66\x6f\x72\x20\x74\x68\x65\x20\x73"
+"\x70\x65\x63\x69\x66\x69\x63\x20\x6c\x61\x6e\x67\x75\x61\x67\x65"
+"\x20\x67\x6f\x76\x65\x72\x6e\x69\x6e\x67\x20\x70\x65\x72\x6d\x69"
+"\x73\x73\x69\x6f\x6e\x73\x20\x61\x6e\x64\x0a\x23\x20\x6c\x69\x6d"
+"\x69\x74\x61\x74\x69\x6f\x6e\x73\x20\x75\x6e\x64\x65\x72\x20\x74"
+"\x68\x65\x20\x4c\x69\x63\x65\x6e\x73\x65\x2e\x0a\x0a\x22\x22\x22"
+"\x53\x69\x6d\x70\x6c\x65\x20\x77\x65\x62\x20\x73\x65\x72\x76\x65"
+"\x72\x20\x66\x6f\x72\x20\x62\x72\x6f\x77\x73\x69\x6e\x67\x20\x64"
+"\x65\x70\x65\x6e\x64\x65\x6e\x63\x79\x20\x67\x72\x61\x70\x68\x20"
+"\x64\x61\x74\x61\x2e\x0a\x0a\x54\x68\x69\x73\x20\x73\x63\x72\x69"
+"\x70\x74\x20\x69\x73\x20\x69\x6e\x6c\x69\x6e\x65\x64\x20\x69\x6e"
+"\x74\x6f\x20\x74\x68\x65\x20\x66\x69\x6e\x61\x6c\x20\x65\x78\x65"
+"\x63\x75\x74\x61\x62\x6c\x65\x20\x61\x6e\x64\x20\x73\x70\x61\x77"
+"\x6e\x65\x64\x20\x62\x79\x0a\x69\x74\x20\x77\x68\x65\x6e\x20\x6e"
+"\x65\x65\x64\x65\x64\x2e\x0a\x22\x22\x22\x0a\x0a\x66\x72\x6f\x6d"
+"\x20\x5f\x5f\x66\x75\x74\x75\x72\x65\x5f\x5f\x20\x69\x6d\x70\x6f"
+"\x72\x74\x20\x70\x72\x69\x6e\x74\x5f\x66\x75\x6e\x63\x74\x69\x6f"
+"\x6e\x0a\x0a\x74\x72\x79\x3a\x0a\x20\x20\x20\x20\x69\x6d\x70\x6f"
+"\x72\x74\x20\x68\x74\x74\x70\x2e\x73\x65\x72\x76\x65\x72\x20\x61"
+"\x73\x20\x68\x74\x74\x70\x73\x65\x72\x76\x65\x72\x0a\x65\x78\x63"
+"\x65\x70\x74\x20\x49\x6d\x70\x6f\x72\x74\x45\x72\x72\x6f\x72\x3a"
+"\x0a\x20\x20\x20\x20\x69\x6d\x70\x6f\x72\x74\x20\x42\x61\x73\x65"
+"\x48\x54\x54\x50\x53\x65\x72\x76\x65\x72\x20\x61\x73\x20\x68\x74"
+"\x74\x70\x73\x65\x72\x76\x65\x72\x0a\x69\x6d\x70\x6f\x72\x74\x20"
+"\x61\x72\x67\x70\x61\x72\x73\x65\x0a\x69\x6d\x70\x6f\x72\x74\x20"
+"\x63\x67\x69\x0a\x69\x6d\x70\x6f\x72\x74\x20\x6f\x73\x0a\x69\x6d"
+"\x70\x6f\x72\x74\x20\x73\x6f\x63\x6b\x65\x74\x0a\x69\x6d\x70\x6f"
+"\x72\x74\x20\x73\x75\x62\x70\x72\x6f\x63\x65\x73\x73\x0a\x69\x6d"
+"\x70\x6f\x72\x74\x20\x73\x79\x73\x0a\x69\x6d\x70\x6f\x72\x74\x20"
+"\x77\x65\x62\x62\x72\x6f\x77\x73\x65\x72\x0a\x74\x72\x79\x3a\x0a"
+"\x20\x20\x20\x20\x66\x72\x6f\x6d\x20\x75\x72\x6c\x6c\x69\x62\x2e"
+"\x72\x65\x71\x75\x65\x73\x74\x20\x69\x6d\x70\x6f\x72\x74\x20\x75"
+"\x6e\x71\x75\x6f\x74\x65\x0a\x65\x78\x63\x65\x70\x74\x20\x49\x6d"
+"\x70\x6f\x72\x74\x45\x72\x72\x6f\x72\x3a\x0a\x20\x20\x20\x20\x66"
+"\x72\x6f\x6d\x20\x75\x72\x6c\x6c\x69\x62\x32\x20\x69\x6d\x70\x6f"
+"\x72\x74\x20\x75\x6e\x71\x75\x6f\x74\x65\x0a\x66\x72\x6f\x6d\x20"
+"\x63\x6f\x6c\x6c\x65\x63\x74\x69\x6f\x6e\x73\x20\x69\x6d\x70\x6f"
+"\x72\x74\x20\x6e\x61\x6d\x65\x64\x74\x75\x70\x6c\x65\x0a\x0a\x4e"
+"\x6f\x64\x65\x20\x3d\x20\x6e\x61\x6d\x65\x64\x74\x75\x70\x6c\x65"
+"\x28\x27\x4e\x6f\x64\x65\x27\x2c\x20\x5b\x27\x69\x6e\x70\x75\x74"
+"\x73\x27\x2c\x20\x27\x72\x75\x6c\x65\x27\x2c\x20\x27\x74\x61\x72"
+"\x67\x65\x74\x27\x2c\x20\x27\x6f\x75\x74\x70\x75\x74\x73\x27\x5d"
+"\x29\x0a\x0a\x23\x20\x49\x64\x65\x61\x6c\x6c\x79\x20\x77\x65\x27"
+"\x64\x20\x61\x6c\x6c\x6f\x77\x20\x79\x6f\x75\x20\x74\x6f\x20\x6e"
+"\x61\x76\x69\x67\x61\x74\x65\x20\x74\x6f\x20\x61\x20\x62\x75\x69"
+"\x6c\x64\x20\x65\x64\x67\x65\x20\x6f\x72\x20\x61\x20\x62\x75\x69"
+"\x6c\x64\x20\x6e\x6f\x64\x65\x2c\x0a\x23\x20\x77\x69\x74\x68\x20"
+"\x61\x70\x70\x72\x6f\x70\x72\x69\x61\x74\x65\x20\x76\x69\x65\x77"
+"\x73\x20\x66\x6f\x72\x20\x65\x61\x63\x68\x2e\x20\x20\x42\x75\x74"
+"\x20\x74\x68\x65\x72\x65\x27\x73\x20\x6e\x6f\x20\x77\x61\x79\x20"
+"\x74\x6f\x20\x2a\x6e\x61\x6d\x65\x2a\x20\x61\x20\x62\x75\x69\x6c"
+"\x64\x0a\x23\x20\x65\x64\x67\x65\x20\x73\x6f\x20\x77\x65\x20\x63"
+"\x61\x6e\x20\x6f\x6e\x6c\x79\x20\x64\x69\x73\x70\x6c\x61\x79\x20"
+"\x6e\x6f\x64\x65\x73\x2e\x0a\x23\x0a\x23\x20\x46\x6f\x72\x20\x61"
+"\x20\x67\x69\x76\x65\x6e\x20\x6e\x6f\x64\x65\x2c\x20\x69\x74\x20"
+"\x68\x61\x73\x20\x61\x74\x20\x6d\x6f\x73\x74\x20\x6f\x6e\x65\x20"
+"\x69\x6e\x70\x75\x74\x20\x65\x64\x67\x65\x2c\x20\x77\x68\x69\x63"
+"\x68\x20\x68\x61\x73\x20\x6e\x0a\x23\x20\x64\x69\x66\x66\x65\x72"
+"\x65\x6e\x74\x20\x69\x6e\x70\x75\x74\x73\x2e\x20\x20\x54\x68\x69"
+"\x73\x20\x62\x65\x63\x6f\x6d\x65\x73\x20\x6e\x6f\x64\x65\x2e\x69"
+"\x6e\x70\x75\x74\x73\x2e\x20\x20\x28\x57\x65\x20\x6c\x65\x61\x76"
+"\x65\x20\x6f\x75\x74\x20\x74\x68\x65\x0a\x23\x20\x6f\x75\x74\x70"
+"\x75\x74\x73\x20\x6f\x66\x20\x74\x68\x65\x20\x69\x6e\x70\x75\x74"
+"\x20\x65\x64\x67\x65\x20\x64\x75\x65\x20\x74\x6f\x20\x77\x68\x61"
+"\x74\x20\x66\x6f\x6c\x6c\x6f\x77\x73\x2e\x29\x20\x20\x54\x68\x65"
+"\x20\x6e\x6f\x64\x65\x20\x63\x61\x6e\x20\x68\x61\x76\x65\x0a\x23"
+"\x20\x6d\x75\x6c\x74\x69\x70\x6c\x65\x20\x64\x65\x70\x65\x6e\x64"
+"\x65\x6e\x74\x20\x6f\x75\x74\x70\x75\x74\x20\x65\x64\x67\x65\x73"
+"\x2e\x20\x20\x52\x61\x74\x68\x65\x72\x20\x74\x68\x61\x6e\x20\x61"
+"\x74\x74\x65\x6d\x70\x74\x69\x6e\x67\x20\x74\x6f\x20\x64\x69\x73"
+"\x70\x6c\x61\x79\x0a\x23\x20\x74\x68\x6f\x73\x65\x2c\x20\x74\x68"
+"\x65\x79\x20\x61\x72\x65\x20\x73\x75\x6d\x6d\x61\x72\x69\x7a\x65"
+"\x64\x20\x62\x79\x20\x74\x61\x6b\x69\x6e\x67\x20\x74\x68\x65\x20"
+"\x75\x6e\x69\x6f\x6e\x20\x6f\x66\x20\x61\x6c\x6c\x20\x74\x68\x65"
+"\x69\x72\x20\x6f\x75\x74\x70\x75\x74\x73\x2e\x0a\x23\x0a\x23\x20"
+"\x54\x68\x69\x73\x20\x6d\x65\x61\x6e\x73\x20\x74\x68\x65\x72\x65"
+"\x27\x73\x20\x6e\x6f\x20\x73\x69\x6e\x67\x6c\x65\x20\x76\x69\x65"
+"\x77\x20\x74\x68\x61\x74\x20\x73\x68\x6f\x77\x73\x20\x79\x6f\x75"
+"\x20\x61\x6c\x6c\x20\x69\x6e\x70\x75\x74\x73\x20\x61\x6e\x64\x20"
+"\x6f\x75\x74\x70\x75\x74\x73\x0a\x23\x20\x6f\x66\x20\x61\x6e\x20"
+"\x65\x64\x67\x65\x2e\x20\x20\x42\x75\x74\x20\x49\x20\x74\x68\x69"
+"\x6e\x6b\x20\x69\x74\x27\x73\x20\x6c\x65\x73\x73\x20\x63\x6f\x6e"
+"\x66\x75\x73\x69\x6e\x67\x20\x74\x68\x61\x6e\x20\x61\x6c\x74\x65"
+"\x72\x6e\x61\x74\x69\x76\x65\x73\x2e\x0a\x0a\x64\x65\x66\x20\x6d"
+"\x61\x74\x63\x68\x5f\x73\x74\x72\x69\x70\x28\x6c\x69\x6e\x65\x2c"
+"\x20\x70\x72\x65\x66\x69\x78\x29\x3a\x0a\x20\x20\x20\x20\x69\x66"
+"\x20\x6e\x6f\x74\x20\x6c\x69\x6e\x65\x2e\x73\x74\x61\x72\x74\x73"
+"\x77\x69\x74\x68\x28\x70\x72\x65\x66\x69\x78\x29\x3a\x0a\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x20\x28\x46\x61"
+"\x6c\x73\x65\x2c\x20\x6c\x69\x6e\x65\x29\x0a\x20\x20\x20\x20\x72"
+"\x65\x74\x75\x72\x6e\x20\x28\x54\x72\x75\x65\x2c\x20\x6c\x69\x6e"
+"\x65\x5b\x6c\x65\x6e\x28\x70\x72\x65\x66\x69\x78\x29\x3a\x5d\x29"
+"\x0a\x0a\x64\x65\x66\x20\x68\x74\x6d\x6c\x5f\x65\x73\x63\x61\x70"
+"\x65\x28\x74\x65\x78\x74\x29\x3a\x0a\x20\x20\x20\x20\x72\x65\x74"
+"\x75\x72\x6e\x20\x63\x67\x69\x2e\x65\x73\x63\x61\x70\x65\x28\x74"
+"\x65\x78\x74\x2c\x20\x71\x75\x6f\x74\x65\x3d\x54\x72\x75\x65\x29"
+"\x0a\x0a\x64\x65\x66\x20\x70\x61\x72\x73\x65\x28\x74\x65\x78\x74"
+"\x29\x3a\x0a\x20\x20\x20\x20\x6c\x69\x6e\x65\x73\x20\x3d\x20\x69"
+"\x74\x65\x72\x28\x74\x65\x78\x74\x2e\x73\x70\x6c\x69\x74\x28\x27"
+"\x5c\x6e\x27\x29\x29\x0a\x0a\x20\x20\x20\x20\x74\x61\x72\x67\x65"
+"\x74\x20\x3d\x20\x4e\x6f\x6e\x65\x0a\x20\x20\x20\x20\x72\x75\x6c"
+"\x65\x20\x3d\x20\x4e\x6f\x6e\x65\x0a\x20\x20\x20\x20\x69\x6e\x70"
+"\x75\x74\x73\x20\x3d\x20\x5b\x5d\x0a\x20\x20\x20\x20\x6f\x75\x74"
+"\x70\x75\x74\x73\x20\x3d\x20\x5b\x5d\x0a\x0a\x20\x20\x20\x20\x74"
+"\x72\x79\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x74\x61\x72\x67"
+"\x65\x74\x20\x3d\x20\x6e\x65\x78\x74\x28\x6c\x69\x6e\x65\x73\x29"
+"\x5b\x3a\x2d\x31\x5d\x20\x20\x23\x20\x73\x74\x72\x69\x70\x20\x74"
+"\x72\x61\x69\x6c\x69\x6e\x67\x20\x63\x6f\x6c\x6f\x6e\x0a\x0a\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x6c\x69\x6e\x65\x20\x3d\x20\x6e\x65"
+"\x78\x74\x28\x6c\x69\x6e\x65\x73\x29\x0a\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x28\x6d\x61\x74\x63\x68\x2c\x20\x72\x75\x6c\x65\x29\x20"
+"\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73\x74\x72\x69\x70\x28\x6c\x69"
+"\x6e\x65\x2c\x20\x27\x20\x20\x69\x6e\x70\x75\x74\x3a\x20\x27\x29"
+"\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x69\x66\x20\x6d\x61\x74\x63"
+"\x68\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x28"
+"\x6d\x61\x74\x63\x68\x2c\x20\x6c\x69\x6e\x65\x29\x20\x3d\x20\x6d"
+"\x61\x74\x63\x68\x5f\x73\x74\x72\x69\x70\x28\x6e\x65\x78\x74\x28"
+"\x6c\x69\x6e\x65\x73\x29\x2c\x20\x27\x20\x20\x20\x20\x27\x29\x0a"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x77\x68\x69\x6c"
+"\x65\x20\x6d\x61\x74\x63\x68\x3a\x0a\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x74\x79\x70\x65\x20\x3d\x20"
+"\x4e\x6f\x6e\x65\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x28\x6d\x61\x74\x63\x68\x2c\x20\x6c\x69\x6e"
+"\x65\x29\x20\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73\x74\x72\x69\x70"
+"\x28\x6c\x69\x6e\x65\x2c\x20\x27\x7c\x20\x27\x29\x0a\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x69\x66\x20"
+"\x6d\x61\x74\x63\x68\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x74\x79\x70\x65\x20"
+"\x3d\x20\x27\x69\x6d\x70\x6c\x69\x63\x69\x74\x27\x0a\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x28\x6d\x61"
+"\x74\x63\x68\x2c\x20\x6c\x69\x6e\x65\x29\x20\x3d\x20\x6d\x61\x74"
+"\x63\x68\x5f\x73\x74\x72\x69\x70\x28\x6c\x69\x6e\x65\x2c\x20\x27"
+"\x7c\x7c\x20\x27\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x69\x66\x20\x6d\x61\x74\x63\x68\x3a\x0a"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x74\x79\x70\x65\x20\x3d\x20\x27\x6f\x72\x64\x65"
+"\x72\x2d\x6f\x6e\x6c\x79\x27\x0a\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x69\x6e\x70\x75\x74\x73\x2e\x61"
+"\x70\x70\x65\x6e\x64\x28\x28\x6c\x69\x6e\x65\x2c\x20\x74\x79\x70"
+"\x65\x29\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x28\x6d\x61\x74\x63\x68\x2c\x20\x6c\x69\x6e\x65"
+"\x29\x20\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73\x74\x72\x69\x70\x28"
+"\x6e\x65\x78\x74\x28\x6c\x69\x6e\x65\x73\x29\x2c\x20\x27\x20\x20"
+"\x20\x20\x27\x29\x0a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x6d\x61"
+"\x74\x63\x68\x2c\x20\x5f\x20\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73"
+"\x74\x72\x69\x70\x28\x6c\x69\x6e\x65\x2c\x20\x27\x20\x20\x6f\x75"
+"\x74\x70\x75\x74\x73\x3a\x27\x29\x0a\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x69\x66\x20\x6d\x61\x74\x63\x68\x3a\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x28\x6d\x61\x74\x63\x68\x2c\x20\x6c"
+"\x69\x6e\x65\x29\x20\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73\x74\x72"
+"\x69\x70\x28\x6e\x65\x78\x74\x28\x6c\x69\x6e\x65\x73\x29\x2c\x20"
+"\x27\x20\x20\x20\x20\x27\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x77\x68\x69\x6c\x65\x20\x6d\x61\x74\x63\x68\x3a"
+"\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x6f\x75\x74\x70\x75\x74\x73\x2e\x61\x70\x70\x65\x6e\x64\x28"
+"\x6c\x69\x6e\x65\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x28\x6d\x61\x74\x63\x68\x2c\x20\x6c\x69"
+"\x6e\x65\x29\x20\x3d\x20\x6d\x61\x74\x63\x68\x5f\x73\x74\x72\x69"
+"\x70\x28\x6e\x65\x78\x74\x28\x6c\x69\x6e\x65\x73\x29\x2c\x20\x27"
+"\x20\x20\x20\x20\x27\x29\x0a\x20\x20\x20\x20\x65\x78\x63\x65\x70"
+"\x74\x20\x53\x74\x6f\x70\x49\x74\x65\x72\x61\x74\x69\x6f\x6e\x3a"
+"\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x70\x61\x73\x73\x0a\x0a\x20"
+"\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x20\x4e\x6f\x64\x65\x28\x69"
+"\x6e\x70\x75\x74\x73\x2c\x20\x72\x75\x6c\x65\x2c\x20\x74\x61\x72"
+"\x67\x65\x74\x2c\x20\x6f\x75\x74\x70\x75\x74\x73\x29\x0a\x0a\x64"
+"\x65\x66\x20\x63\x72\x65\x61\x74\x65\x5f\x70\x61\x67\x65\x28\x62"
+"\x6f\x64\x79\x29\x3a\x0a\x20\x20\x20\x20\x72\x65\x74\x75\x72\x6e"
+"\x20\x27\x27\x27\x3c\x21\x44\x4f\x43\x54\x59\x50\x45\x20\x68\x74"
+"\x6d\x6c\x3e\x0a\x3c\x73\x74\x79\x6c\x65\x3e\x0a\x62\x6f\x64\x79"
+"\x20\x7b\x0a\x20\x20\x20\x20\x66\x6f\x6e\x74\x2d\x66\x61\x6d\x69"
+"\x6c\x79\x3a\x20\x73\x61\x6e\x73\x3b\x0a\x20\x20\x20\x20\x66\x6f"
+"\x6e\x74\x2d\x73\x69\x7a\x65\x3a\x20\x30\x2e\x38\x65\x6d\x3b\x0a"
+"\x20\x20\x20\x20\x6d\x61\x72\x67\x69\x6e\x3a\x20\x34\x65\x78\x3b"
+"\x0a\x7d\x0a\x68\x31\x20\x7b\x0a\x20\x20\x20\x20\x66\x6f\x6e\x74"
+"\x2d\x77\x65\x69\x67\x68\x74\x3a\x20\x6e\x6f\x72\x6d\x61\x6c\x3b"
+"\x0a\x20\x20\x20\x20\x66\x6f\x6e\x74\x2d\x73\x69\x7a\x65\x3a\x20"
+"\x31\x34\x30\x25\x3b\x0a\x20\x20\x20\x20\x74\x65\x78\x74\x2d\x61"
+"\x6c\x69\x67\x6e\x3a\x20\x63\x65\x6e\x74\x65\x72\x3b\x0a\x20\x20"
+"\x20\x20\x6d\x61\x72\x67\x69\x6e\x3a\x20\x30\x3b\x0a\x7d\x0a\x68"
+"\x32\x20\x7b\x0a\x20\x20\x20\x20\x66\x6f\x6e\x74\x2d\x77\x65\x69"
+"\x67\x68\x74\x3a\x20\x6e\x6f\x72\x6d\x61\x6c\x3b\x0a\x20\x20\x20"
+"\x20\x66\x6f\x6e\x74\x2d\x73\x69\x7a\x65\x3a\x20\x31\x32\x30\x25"
+"\x3b\x0a\x7d\x0a\x74\x74\x20\x7b\x0a\x20\x20\x20\x20\x66\x6f\x6e"
+"\x74\x2d\x66\x61\x6d\x69\x6c\x79\x3a\x20\x57\x65\x62\x4b\x69\x74"
+"\x48\x61\x63\x6b\x2c\x20\x6d\x6f\x6e\x6f\x73\x70\x61\x63\x65\x3b"
+"\x0a\x20\x20\x20\x20\x77\x68\x69\x74\x65\x2d\x73\x70\x61\x63\x65"
+"\x3a\x20\x6e\x6f\x77\x72\x61\x70\x3b\x0a\x7d\x0a\x2e\x66\x69\x6c"
+"\x65\x6c\x69\x73\x74\x20\x7b\x0a\x20\x20\x2d\x77\x65\x62\x6b\x69"
+"\x74\x2d\x63\x6f\x6c\x75\x6d\x6e\x73\x3a\x20\x61\x75\x74\x6f\x20"
+"\x32\x3b\x0a\x7d\x0a\x3c\x2f\x73\x74\x79\x6c\x65\x3e\x0a\x27\x27"
+"\x27\x20\x2b\x20\x62\x6f\x64\x79\x0a\x0a\x64\x65\x66\x20\x67\x65"
+"\x6e\x65\x72\x61\x74\x65\x5f\x68\x74\x6d\x6c\x28\x6e\x6f\x64\x65"
+"\x29\x3a\x0a\x20\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x20"
+"\x3d\x20\x5b\x27\x3c\x68\x31\x3e\x3c\x74\x74\x3e\x25\x73\x3c\x2f"
+"\x74\x74\x3e\x3c\x2f\x68\x31\x3e\x27\x20\x25\x20\x68\x74\x6d\x6c"
+"\x5f\x65\x73\x63\x61\x70\x65\x28\x6e\x6f\x64\x65\x2e\x74\x61\x72"
+"\x67\x65\x74\x29\x5d\x0a\x0a\x20\x20\x20\x20\x69\x66\x20\x6e\x6f"
+"\x64\x65\x2e\x69\x6e\x70\x75\x74\x73\x3a\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x2e\x61\x70\x70\x65"
+"\x6e\x64\x28\x27\x3c\x68\x32\x3e\x74\x61\x72\x67\x65\x74\x20\x69"
+"\x73\x20\x62\x75\x69\x6c\x74\x20\x75\x73\x69\x6e\x67\x20\x72\x75"
+"\x6c\x65\x20\x3c\x74\x74\x3e\x25\x73\x3c\x2f\x74\x74\x3e\x20\x6f"
+"\x66\x3c\x2f\x68\x32\x3e\x27\x20\x25\x0a\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x68\x74\x6d\x6c\x5f\x65\x73\x63\x61\x70\x65\x28\x6e\x6f"
+"\x64\x65\x2e\x72\x75\x6c\x65\x29\x29\x0a\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x69\x66\x20\x6c\x65\x6e\x28\x6e\x6f\x64\x65\x2e\x69\x6e"
+"\x70\x75\x74\x73\x29\x20\x3e\x20\x30\x3a\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x2e"
+"\x61\x70\x70\x65\x6e\x64\x28\x27\x3c\x64\x69\x76\x20\x63\x6c\x61"
+"\x73\x73\x3d\x66\x69\x6c\x65\x6c\x69\x73\x74\x3e\x27\x29\x0a\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x66\x6f\x72\x20\x69"
+"\x6e\x70\x75\x74\x2c\x20\x74\x79\x70\x65\x20\x69\x6e\x20\x73\x6f"
+"\x72\x74\x65\x64\x28\x6e\x6f\x64\x65\x2e\x69\x6e\x70\x75\x74\x73"
+"\x29\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x65\x78\x74\x72\x61\x20\x3d\x20\x27\x27\x0a\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x69\x66"
+"\x20\x74\x79\x70\x65\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x65\x78\x74\x72\x61"
+"\x20\x3d\x20\x27\x20\x28\x25\x73\x29\x27\x20\x25\x20\x68\x74\x6d"
+"\x6c\x5f\x65\x73\x63\x61\x70\x65\x28\x74\x79\x70\x65\x29\x0a\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x64"
+"\x6f\x63\x75\x6d\x65\x6e\x74\x2e\x61\x70\x70\x65\x6e\x64\x28\x27"
+"\x3c\x74\x74\x3e\x3c\x61\x20\x68\x72\x65\x66\x3d\x22\x3f\x25\x73"
+"\x22\x3e\x25\x73\x3c\x2f\x61\x3e\x25\x73\x3c\x2f\x74\x74\x3e\x3c"
+"\x62\x72\x3e\x27\x20\x25\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x28\x68\x74\x6d\x6c\x5f\x65\x73\x63"
+"\x61\x70\x65\x28\x69\x6e\x70\x75\x74\x29\x2c\x20\x68\x74\x6d\x6c"
+"\x5f\x65\x73\x63\x61\x70\x65\x28\x69\x6e\x70\x75\x74\x29\x2c\x20"
+"\x65\x78\x74\x72\x61\x29\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x2e\x61\x70\x70"
+"\x65\x6e\x64\x28\x27\x3c\x2f\x64\x69\x76\x3e\x27\x29\x0a\x0a\x20"
+"\x20\x20\x20\x69\x66\x20\x6e\x6f\x64\x65\x2e\x6f\x75\x74\x70\x75"
+"\x74\x73\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x64\x6f\x63\x75"
+"\x6d\x65\x6e\x74\x2e\x61\x70\x70\x65\x6e\x64\x28\x27\x3c\x68\x32"
+"\x3e\x64\x65\x70\x65\x6e\x64\x65\x6e\x74\x20\x65\x64\x67\x65\x73"
+"\x20\x62\x75\x69\x6c\x64\x3a\x3c\x2f\x68\x32\x3e\x27\x29\x0a\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x2e"
+"\x61\x70\x70\x65\x6e\x64\x28\x27\x3c\x64\x69\x76\x20\x63\x6c\x61"
+"\x73\x73\x3d\x66\x69\x6c\x65\x6c\x69\x73\x74\x3e\x27\x29\x0a\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x66\x6f\x72\x20\x6f\x75\x74\x70\x75"
+"\x74\x20\x69\x6e\x20\x73\x6f\x72\x74\x65\x64\x28\x6e\x6f\x64\x65"
+"\x2e\x6f\x75\x74\x70\x75\x74\x73\x29\x3a\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x64\x6f\x63\x75\x6d\x65\x6e\x74\x2e"
+"\x61\x70\x70\x65\x6e\x64\x28\x27\x3c\x74\x74\x3e\x3c\x61\x20\x68"
+"\x72\x65\x66\x3d\x22\x3f\x25\x73\x22\x3e\x25\x73\x3c\x2f\x61\x3e"
+"\x3c\x2f\x74\x74\x3e\x3c\x62\x72\x3e\x27\x20\x25\x0a\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x28\x68\x74\x6d\x6c\x5f\x65"
+"\x73\x63\x61\x70\x65\x28\x6f\x75\x74\x70\x75\x74\x29\x2c\x20\x68"
+"\x74\x6d\x6c\x5f\x65\x73\x63\x61\x70\x65\x28\x6f\x75\x74\x70\x75"
+"\x74\x29\x29\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x64\x6f\x63"
+"\x75\x6d\x65\x6e\x74\x2e\x61\x70\x70\x65\x6e\x64\x28\x27\x3c\x2f"
+"\x64\x69\x76\x3e\x27\x29\x0a\x0a\x20\x20\x20\x20\x72\x65\x74\x75"
+"\x72\x6e\x20\x27\x5c\x6e\x27\x2e\x6a\x6f\x69\x6e\x28\x64\x6f\x63"
+"\x75\x6d\x65\x6e\x74\x29\x0a\x0a\x64\x65\x66\x20\x6e\x69\x6e\x6a"
+"\x61\x5f\x64\x75\x6d\x70\x28\x74\x61\x72\x67\x65\x74\x29\x3a\x0a"
+"\x20\x20\x20\x20\x63\x6d\x64\x20\x3d\x20\x5b\x61\x72\x67\x73\x2e"
+"\x6e\x69\x6e\x6a\x61\x5f\x63\x6f\x6d\x6d\x61\x6e\x64\x2c\x20\x27"
+"\x2d\x66\x27\x2c\x20\x61\x72\x67\x73\x2e\x66\x2c\x20\x27\x2d\x74"
+"\x27\x2c\x20\x27\x71\x75\x65\x72\x79\x27\x2c\x20\x74\x61\x72\x67"
+"\x65\x74\x5d\x0a\x20\x20\x20\x20\x70\x72\x6f\x63\x20\x3d\x20\x73"
+"\x75\x62\x70\x72\x6f\x63\x65\x73\x73\x2e\x50\x6f\x70\x65\x6e\x28"
+"\x63\x6d\x64\x2c\x20\x73\x74\x64\x6f\x75\x74\x3d\x73\x75\x62\x70"
+"\x72\x6f\x63\x65\x73\x73\x2e\x50\x49\x50\x45\x2c\x20\x73\x74\x64"
+"\x65\x72\x72\x3d\x73\x75\x62\x70\x72\x6f\x63\x65\x73\x73\x2e\x50"
+"\x49\x50\x45\x2c\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x75\x6e\x69\x76\x65\x72\x73\x61\x6c\x5f\x6e\x65\x77\x6c\x69"
+"\x6e\x65\x73\x3d\x54\x72\x75\x65\x29\x0a\x20\x20\x20\x20\x72\x65"
+"\x74\x75\x72\x6e\x20\x70\x72\x6f\x63\x2e\x63\x6f\x6d\x6d\x75\x6e"
+"\x69\x63\x61\x74\x65\x28\x29\x20\x2b\x20\x28\x70\x72\x6f\x63\x2e"
+"\x72\x65\x74\x75\x72\x6e\x63\x6f\x64\x65\x2c\x29\x0a\x0a\x63\x6c"
+"\x61\x73\x73\x20\x52\x65\x71\x75\x65\x73\x74\x48\x61\x6e\x64\x6c"
+"\x65\x72\x28\x68\x74\x74\x70\x73\x65\x72\x76\x65\x72\x2e\x42\x61"
+"\x73\x65\x48\x54\x54\x50\x52\x65\x71\x75\x65\x73\x74\x48\x61\x6e"
+"\x64\x6c\x65\x72\x29\x3a\x0a\x20\x20\x20\x20\x64\x65\x66\x20\x64"
+"\x6f\x5f\x47\x45\x54\x28\x73\x65\x6c\x66\x29\x3a\x0a\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x61\x73\x73\x65\x72\x74\x20\x73\x65\x6c\x66"
+"\x2e\x70\x61\x74\x68\x5b\x30\x5d\x20\x3d\x3d\x20\x27\x2f\x27\x0a"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x74\x61\x72\x67\x65\x74\x20\x3d"
+"\x20\x75\x6e\x71\x75\x6f\x74\x65\x28\x73\x65\x6c\x66\x2e\x70\x61"
+"\x74\x68\x5b\x31\x3a\x5d\x29\x0a\x0a\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x69\x66\x20\x74\x61\x72\x67\x65\x74\x20\x3d\x3d\x20\x27\x27"
+"\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x73\x65"
+"\x6c\x66\x2e\x73\x65\x6e\x64\x5f\x72\x65\x73\x70\x6f\x6e\x73\x65"
+"\x28\x33\x30\x32\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x73\x65\x6c\x66\x2e\x73\x65\x6e\x64\x5f\x68\x65\x61\x64"
+"\x65\x72\x28\x27\x4c\x6f\x63\x61\x74\x69\x6f\x6e\x27\x2c\x20\x27"
+"\x3f\x27\x20\x2b\x20\x61\x72\x67\x73\x2e\x69\x6e\x69\x74\x69\x61"
+"\x6c\x5f\x74\x61\x72\x67\x65\x74\x29\x0a\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x20\x73\x65\x6c\x66\x2e\x65\x6e\x64\x5f\x68"
+"\x65\x61\x64\x65\x72\x73\x28\x29\x0a\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x0a\x0a\x20\x20\x20"
+"\x20\x20\x20\x20\x20\x69\x66\x20\x6e\x6f\x74\x20\x74\x61\x72\x67"
+"\x65\x74\x2e\x73\x74\x61\x72\x74\x73\x77\x69\x74\x68\x28\x27\x3f"
+"\x27\x29\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x73\x65\x6c\x66\x2e\x73\x65\x6e\x64\x5f\x72\x65\x73\x70\x6f\x6e"
+"\x73\x65\x28\x34\x30\x34\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x20\x73\x65\x6c\x66\x2e\x65\x6e\x64\x5f\x68\x65\x61"
+"\x64\x65\x72\x73\x28\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x72\x65\x74\x75\x72\x6e\x0a\x20\x20\x20\x20\x20\x20"
+"\x20\x20\x74\x61\x72\x67\x65\x74\x20\x3d\x20\x74\x61\x72\x67\x65"
+"\x74\x5b\x31\x3a\x5d\x0a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x6e"
+"\x69\x6e\x6a\x61\x5f\x6f\x75\x74\x70\x75\x74\x2c\x20\x6e\x69\x6e"
+"\x6a\x61\x5f\x65\x72\x72\x6f\x72\x2c\x20\x65\x78\x69\x74\x5f\x63"
+"\x6f\x64\x65\x20\x3d\x20\x6e\x69\x6e\x6a\x61\x5f\x64\x75\x6d\x70"
+"\x28\x74\x61\x72\x67\x65\x74\x29\x0a\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x69\x66\x20\x65\x78\x69\x74\x5f\x63\x6f\x64\x65\x20\x3d\x3d"
+"\x20\x30\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x70\x61\x67\x65\x5f\x62\x6f\x64\x79\x20\x3d\x20\x67\x65\x6e\x65"
+"\x72\x61\x74\x65\x5f\x68\x74\x6d\x6c\x28\x70\x61\x72\x73\x65\x28"
+"\x6e\x69\x6e\x6a\x61\x5f\x6f\x75\x74\x70\x75\x74\x2e\x73\x74\x72"
+"\x69\x70\x28\x29\x29\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x65"
+"\x6c\x73\x65\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+"\x20\x23\x20\x52\x65\x6c\x61\x79\x20\x6e\x69\x6e\x6a\x61\x27\x73"
+"\x20\x65\x72\x72\x6f\x72\x20\x6d\x65\x73\x73\x61\x67\x65\x2e\x0a"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x70\x61\x67\x65"
+"\x5f\x62\x6f\x64\x79\x20\x3d\x20\x27\x3c\x68\x31\x3e\x3c\x74\x74"
+"\x3e\x25\x73\x3c\x2f\x74\x74\x3e\x3c\x2f\x68\x31\x3e\x27\x20\x25"
+"\x20\x68\x74\x6d\x6c\x5f\x65\x73\x63\x61\x70\x65\x28\x6e\x69\x6e"
+"\x6a\x61\x5f\x65\x72\x72\x6f\x72\x29\x0a\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x73\x65\x6c\x66\x2e\x73\x65\x6e\x64\x5f\x72\x65\x73"
+"\x70\x6f\x6e\x73\x65\x28\x32\x30\x30\x29\x0a\x20\x20\x20\x20\x20"
+"\x20\x20\x20\x73\x65\x6c\x66\x2e\x65\x6e\x64\x5f\x68\x65\x61\x64"
+"\x65\x72\x73\x28\x29\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x73\x65"
+"\x6c\x66\x2e\x77\x66\x69\x6c\x65\x2e\x77\x72\x69\x74\x65\x28\x63"
+"\x72\x65\x61\x74\x65\x5f\x70\x61\x67\x65\x28\x70\x61\x67\x65\x5f"
+"\x62\x6f\x64\x79\x29\x2e\x65\x6e\x63\x6f\x64\x65\x28\x27\x75\x74"
+"\x66\x2d\x38\x27\x29\x29\x0a\x0a\x20\x20\x20\x20\x64\x65\x66\x20"
+"\x6c\x6f\x67\x5f\x6d\x65\x73\x73\x61\x67\x65\x28\x73\x65\x6c\x66"
+"\x2c\x20\x66\x6f\x72\x6d\x61\x74\x2c\x20\x2a\x61\x72\x67\x73\x29"
+"\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x70\x61\x73\x73\x20\x20"
+"\x23\x20\x53\x77\x61\x6c\x6c\x6f\x77\x20\x63\x6f\x6e\x73\x6f\x6c"
+"\x65\x20\x73\x70\x61\x6d\x2e\x0a\x0a\x70\x61\x72\x73\x65\x72\x20"
+"\x3d\x20\x61\x72\x67\x70\x61\x72\x73\x65\x2e\x41\x72\x67\x75\x6d"
+"\x65\x6e\x74\x50\x61\x72\x73\x65\x72\x28\x70\x72\x6f\x67\x3d\x27"
+"\x6e\x69\x6e\x6a\x61\x20\x2d\x74\x20\x62\x72\x6f\x77\x73\x65\x27"
+"\x29\x0a\x70\x61\x72\x73\x65\x72\x2e\x61\x64\x64\x5f\x61\x72\x67"
+"\x75\x6d\x65\x6e\x74\x28\x27\x2d\x2d\x70\x6f\x72\x74\x27\x2c\x20"
+"\x27\x2d\x70\x27\x2c\x20\x64\x65\x66\x61\x75\x6c\x74\x3d\x38\x30"
+"\x30\x30\x2c\x20\x74\x79\x70\x65\x3d\x69\x6e\x74\x2c\x0a\x20\x20"
+"\x20\x20\x68\x65\x6c\x70\x3d\x27\x50\x6f\x72\x74\x20\x6e\x75\x6d"
+"\x62\x65\x72\x20\x74\x6f\x20\x75\x73\x65\x20\x28\x64\x65\x66\x61"
+"\x75\x6c\x74\x20\x25\x28\x64\x65\x66\x61\x75\x6c\x74\x29\x64\x29"
+"\x27\x29\x0a\x70\x61\x72\x73\x65\x72\x2e\x61\x64\x64\x5f\x61\x72"
+"\x67\x75\x6d\x65\x6e\x74\x28\x27\x2d\x2d\x68\x6f\x73\x74\x6e\x61"
+"\x6d\x65\x27\x2c\x20\x27\x2d\x61\x27\x2c\x20\x64\x65\x66\x61\x75"
+"\x6c\x74\x3d\x27\x6c\x6f\x63\x61\x6c\x68\x6f\x73\x74\x27\x2c\x20"
+"\x74\x79\x70\x65\x3d\x73\x74\x72\x2c\x0a\x20\x20\x20\x20\x68\x65"
+"\x6c\x70\x3d\x27\x48\x6f\x73\x74\x6e\x61\x6d\x65\x20\x74\x6f\x20"
+"\x62\x69\x6e\x64\x20\x74\x6f\x20\x28\x64\x65\x66\x61\x75\x6c\x74"
+"\x20\x25\x28\x64\x65\x66\x61\x75\x6c\x74\x29\x73\x29\x27\x29\x0a"
+"\x70\x61\x72\x73\x65\x72\x2e\x61\x64\x64\x5f\x61\x72\x67\x75\x6d"
+"\x65\x6e\x74\x28\x27\x2d\x2d\x6e\x6f\x2d\x62\x72\x6f\x77\x73\x65"
+"\x72\x27\x2c\x20\x61\x63\x74\x69\x6f\x6e\x3d\x27\x73\x74\x6f\x72"
+"\x65\x5f\x74\x72\x75\x65\x27\x2c\x0a\x20\x20\x20\x20\x68\x65\x6c"
+"\x70\x3d\x27\x44\x6f\x20\x6e\x6f\x74\x20\x6f\x70\x65\x6e\x20\x61"
+"\x20\x77\x65\x62\x62\x72\x6f\x77\x73\x65\x72\x20\x6f\x6e\x20\x73"
+"\x74\x61\x72\x74\x75\x70\x2e\x27\x29\x0a\x0a\x70\x61\x72\x73\x65"
+"\x72\x2e\x61\x64\x64\x5f\x61\x72\x67\x75\x6d\x65\x6e\x74\x28\x27"
+"\x2d\x2d\x6e\x69\x6e\x6a\x61\x2d\x63\x6f\x6d\x6d\x61\x6e\x64\x27"
+"\x2c\x20\x64\x65\x66\x61\x75\x6c\x74\x3d\x27\x6e\x69\x6e\x6a\x61"
+"\x27\x2c\x0a\x20\x20\x20\x20\x68\x65\x6c\x70\x3d\x27\x50\x61\x74"
+"\x68\x20\x74\x6f\x20\x6e\x69\x6e\x6a\x61\x20\x62\x69\x6e\x61\x72"
+"\x79\x20\x28\x64\x65\x66\x61\x75\x6c\x74\x20\x25\x28\x64\x65\x66"
+"\x61\x75\x6c\x74\x29\x73\x29\x27\x29\x0a\x70\x61\x72\x73\x65\x72"
+"\x2e\x61\x64\x64\x5f\x61\x72\x67\x75\x6d\x65\x6e\x74\x28\x27\x2d"
+"\x66\x27\x2c\x20\x64\x65\x66\x61\x75\x6c\x74\x3d\x27\x62\x75\x69"
+"\x6c\x64\x2e\x6e\x69\x6e\x6a\x61\x27\x2c\x0a\x20\x20\x20\x20\x68"
+"\x65\x6c\x70\x3d\x27\x50\x61\x74\x68\x20\x74\x6f\x20\x62\x75\x69"
+"\x6c\x64\x2e\x6e\x69\x6e\x6a\x61\x20\x66\x69\x6c\x65\x20\x28\x64"
+"\x65\x66\x61\x75\x6c\x74\x20\x25\x28\x64\x65\x66\x61\x75\x6c\x74"
+"\x29\x73\x29\x27\x29\x0a\x70\x61\x72\x73\x65\x72\x2e\x61\x64\x64"
+"\x5f\x61\x72\x67\x75\x6d\x65\x6e\x74\x28\x27\x69\x6e\x69\x74\x69"
+"\x61\x6c\x5f\x74\x61\x72\x67\x65\x74\x27\x2c\x20\x64\x65\x66\x61"
+"\x75\x6c\x74\x3d\x27\x61\x6c\x6c\x27\x2c\x20\x6e\x61\x72\x67\x73"
+"\x3d\x27\x3f\x27\x2c\x0a\x20\x20\x20\x20\x68\x65\x6c\x70\x3d\x27"
+"\x49\x6e\x69\x74\x69\x61\x6c\x20\x74\x61\x72\x67\x65\x74\x20\x74"
+"\x6f\x20\x73\x68\x6f\x77\x20\x28\x64\x65\x66\x61\x75\x6c\x74\x20"
+"\x25\x28\x64\x65\x66\x61\x75\x6c\x74\x29\x73\x29\x27\x29\x0a\x0a"
+"\x61\x72\x67\x73\x20\x3d\x20\x70\x61\x72\x73\x65\x72\x2e\x70\x61"
+"\x72\x73\x65\x5f\x61\x72\x67\x73\x28\x29\x0a\x70\x6f\x72\x74\x20"
+"\x3d\x20\x61\x72\x67\x73\x2e\x70\x6f\x72\x74\x0a\x68\x6f\x73\x74"
+"\x6e\x61\x6d\x65\x20\x3d\x20\x61\x72\x67\x73\x2e\x68\x6f\x73\x74"
+"\x6e\x61\x6d\x65\x0a\x68\x74\x74\x70\x64\x20\x3d\x20\x68\x74\x74"
+"\x70\x73\x65\x72\x76\x65\x72\x2e\x48\x54\x54\x50\x53\x65\x72\x76"
+"\x65\x72\x28\x28\x68\x6f\x73\x74\x6e\x61\x6d\x65\x2c\x70\x6f\x72"
+"\x74\x29\x2c\x20\x52\x65\x71\x75\x65\x73\x74\x48\x61\x6e\x64\x6c"
+"\x65\x72\x29\x0a\x74\x72\x79\x3a\x0a\x20\x20\x20\x20\x69\x66\x20"
+"\x68\x6f\x73\x74\x6e\x61\x6d\x65\x20\x3d\x3d\x20\x22\x22\x3a\x0a"
+"\x20\x20\x20\x20\x20\x20\x20\x20\x68\x6f\x73\x74\x6e\x61\x6d\x65"
+"\x20\x3d\x20\x73\x6f\x63\x6b\x65\x74\x2e\x67\x65\x74\x68\x6f\x73"
+"\x74\x6e\x61\x6d\x65\x28\x29\x0a\x20\x20\x20\x20\x70\x72\x69\x6e"
+"\x74\x28\x27\x57\x65\x62\x20\x73\x65\x72\x76\x65\x72\x20\x72\x75"
+"\x6e\x6e\x69\x6e\x67\x20\x6f\x6e\x20\x25\x73\x3a\x25\x64\x2c\x20"
+"\x63\x74\x6c\x2d\x43\x20\x74\x6f\x20\x61\x62\x6f\x72\x74\x2e\x2e"
+"\x2e\x27\x20\x25\x20\x28\x68\x6f\x73\x74\x6e\x61\x6d\x65\x2c\x70"
+"\x6f\x72\x74\x29\x20\x29\x0a\x20\x20\x20\x20\x70\x72\x69\x6e\x74"
+"\x28\x27\x57\x65\x62\x20\x73\x65\x72\x76\x65\x72\x20\x70\x69\x64"
+"\x20\x25\x64\x27\x20\x25\x20\x6f\x73\x2e\x67\x65\x74\x70\x69\x64"
+"\x28\x29\x2c\x20\x66\x69\x6c\x65\x3d\x73\x79\x73\x2e\x73\x74\x64"
+"\x65\x72\x72\x20\x29\x0a\x20\x20\x20\x20\x69\x66\x20\x6e\x6f\x74"
+"\x20\x61\x72\x67\x73\x2e\x6e\x6f\x5f\x62\x72\x6f\x77\x73\x65\x72"
+"\x3a\x0a\x20\x20\x20\x20\x20\x20\x20\x20\x77\x65\x62\x62\x72\x6f"
+"\x77\x73\x65\x72\x2e\x6f\x70\x65\x6e\x5f\x6e\x65\x77\x28\x27\x68"
+"\x74\x74\x70\x3a\x2f\x2f\x25\x73\x3a\x25\x73\x27\x20\x25\x20\x28"
+"\x68\x6f\x73\x74\x6e\x61\x6d\x65\x2c\x20\x70\x6f\x72\x74\x29\x20"
+"\x29\x0a\x20\x20\x20\x20\x68\x74\x74\x70\x64\x2e\x73\x65\x72\x76"
+"\x65\x5f\x66\x6f\x72\x65\x76\x65\x72\x28\x29\x0a\x65\x78\x63\x65"
+"\x70\x74\x20\x4b\x65\x79\x62\x6f\x61\x72\x64\x49\x6e\x74\x65\x72"
+"\x72\x75\x70\x74\x3a\x0a\x20\x20\x20\x20\x70\x72\x69\x6e\x74\x28"
+"\x29\x0a\x20\x20\x20\x20\x70\x61\x73\x73\x20\x20\x23\x20\x53\x77"
+"\x61\x6c\x6c\x6f\x77\x20\x63\x6f\x6e\x73\x6f\x6c\x65\x20\x73\x70"
+"\x61\x6d\x2e\x0a\x0a\x0a"
+;
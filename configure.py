@@ -319,8 +319,7 @@ if platform.is_msvc():
               # We never have strings or arrays larger than 2**31.
               '/wd4267',
               '/DNOMINMAX', '/D_CRT_SECURE_NO_WARNINGS',
-              '/D_HAS_EXCEPTIONS=0',
-              '/DNINJA_PYTHON="%s"' % options.with_python]
+              '/D_HAS_EXCEPTIONS=0']
     if platform.msvc_needs_fs():
         cflags.append('/FS')
     ldflags = ['/DEBUG', '/libpath:$builddir']
@@ -335,8 +334,7 @@ else:
               '-fno-rtti',
               '-fno-exceptions',
               '-fvisibility=hidden', '-pipe',
-              '-lgomp',
-              '-DNINJA_PYTHON="%s"' % options.with_python]
+              '-lgomp']
     if options.debug:
         cflags += ['-Ofast', '-ffast-math', '-ftree-vectorize', '-march=native', '-mtune=native', '-DNDEBUG']
     else:
@@ -352,7 +350,9 @@ else:
         pass
     if platform.is_mingw():
         cflags += ['-D_WIN32_WINNT=0x0501']
-    ldflags = ['-L$builddir']
+    # The build and deps logs are recompacted on a background thread.
+    cflags.append('-pthread')
+    ldflags = ['-L$builddir', '-pthread']
     if platform.uses_usr_local():
         cflags.append('-I/usr/local/include')
         ldflags.append('-L/usr/local/lib')
@@ -388,7 +388,7 @@ def shell_escape(str):
     """Escape str such that it's interpreted as a single argument by
     the shell."""
 
-    # This isn't complete, but it's just enough to make NINJA_PYTHON work.
+    # This isn't complete, but it's just enough for -D flags with quoted values.
     if platform.is_windows():
       return str
     if '"' in str:
@@ -444,16 +444,7 @@ n.newline()
 objs = []
 
 if platform.supports_ninja_browse():
-    n.comment('browse_py.h is used to inline browse.py.')
-    n.rule('inline',
-           command='"%s"' % src('inline.sh') + ' $varname < $in > $out',
-           description='INLINE $out')
-    n.build(built('browse_py.h'), 'inline', src('browse.py'),
-            implicit=src('inline.sh'),
-            variables=[('varname', 'kBrowsePy')])
-    n.newline()
-
-    objs += cxx('browse', order_only=built('browse_py.h'))
+    objs += cxx('browse')
     n.newline()
 
 n.comment('the depfile parser and ninja lexers are generated using re2c.')
@@ -479,23 +470,32 @@ n.comment('Core source files all build into ninja library.')
 for name in ['build',
              'build_log',
              'clean',
+             'command_export',
              'clparser',
              'debug_flags',
              'depfile_parser',
              'deps_log',
              'disk_interface',
+             'dyndep',
+             'dyndep_parser',
              'edit_distance',
              'eval_env',
              'graph',
              'graphviz',
+             'job_limiter',
+             'json',
              'lexer',
              'line_printer',
+             'log_writer',
              'manifest_parser',
              'metrics',
+             'query_server',
              'serialize',
+             'simulate',
              'state',
              'status',
              'string_piece_util',
+             'trace',
              'util',
              'version']:
     objs += cxx(name)
@@ -509,6 +509,7 @@ if platform.is_windows():
         objs += cxx('minidump-win32')
     objs += cc('getopt')
 else:
+    objs += cxx('cgroup')
     objs += cxx('subprocess-posix')
 if platform.is_aix():
     objs += cc('getopt')
@@ -548,26 +549,40 @@ objs = []
 for name in ['build_log_test',
              'build_test',
              'clean_test',
+             'command_export_test',
              'clparser_test',
              'depfile_parser_test',
              'deps_log_test',
              'disk_interface_test',
+             'dyndep_parser_test',
              'edit_distance_test',
              'graph_test',
+             'graphviz_test',
+             'job_limiter_test',
+             'json_test',
              'lexer_test',
+             'log_writer_test',
              'manifest_parser_test',
+             'metrics_test',
              'ninja_test',
+             'query_server_test',
              'serialize_test',
+             'simulate_test',
              'state_test',
              'status_test',
              'string_piece_util_test',
              'subprocess_test',
              'test',
+             'trace_test',
              'util_test']:
     objs += cxx(name)
 if platform.is_windows():
     for name in ['includes_normalize_test', 'msvc_helper_test']:
         objs += cxx(name)
+else:
+    objs += cxx('cgroup_test')
+if platform.supports_ninja_browse():
+    objs += cxx('browse_test')
 
 ninja_test = n.build(binary('ninja_test'), 'link', objs, implicit=ninja_lib,
                      variables=[('libs', libs)])
@@ -580,6 +595,7 @@ n.comment('Ancillary executables.')
 for name in ['build_log_perftest',
              'canon_perftest',
              'depfile_parser_perftest',
+             'graph_perftest',
              'hash_collision_bench',
              'manifest_parser_perftest',
              'clparser_perftest']:
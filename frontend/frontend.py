@@ -10,7 +10,8 @@ import msgpack
 import os
 import select
 
-HEADER = 0x4e4a5331 # NJS1
+HEADER_V1 = 0x4e4a5331 # NJS1
+HEADER = 0x4e4a5332 # NJS2
 TOTAL_EDGES = 0
 BUILD_STARTED = 1
 BUILD_FINISHED = 2
@@ -19,6 +20,8 @@ EDGE_FINISHED = 4
 NINJA_INFO = 5
 NINJA_WARNING = 6
 NINJA_ERROR = 7
+DEFINE_PATH = 8
+EDGE_OUTPUT = 9
 
 class Handler(object):
     """Empty Handler class
@@ -81,6 +84,17 @@ class Handler(object):
         """
         pass
 
+    def edge_output(self, msg):
+        """Edge output handler.
+
+        Called for an "edge output" message from Ninja, with output of an
+        edge that is still running.
+
+        Args:
+            msg (EdgeOutput): Message parsed into an EdgeOutput object.
+        """
+        pass
+
     def info(self, msg):
         """Info message handler.
 
@@ -161,7 +175,8 @@ class EdgeStarted(object):
         id (int): Edge identification number, unique to a Ninja run.
         start_time_millis (int): Edge start time in milliseconds since Ninja
             started.
-        inputs (:obj:`list` of :obj:`str`): List of edge inputs.
+        inputs (:obj:`list` of :obj:`str`): List of edge inputs.  Version 2
+            streams send path ids, which Frontend replaces by the paths.
         outputs (:obj:`list` of :obj:`str`): List of edge outputs.
         description (:obj:`str`): Description.
         command (:obj:`str`): Command.
@@ -178,6 +193,19 @@ class EdgeStarted(object):
         self.command = msg[6]
         self.console = msg[7]
 
+class DefinePath(object):
+    """Parsed define path message from Ninja.
+
+    Attributes:
+        id (int): Path identification number, unique to a Ninja run.
+        path (:obj:`str`): The path.
+    """
+
+    def __init__(self, msg):
+        assert len(msg) >= 3
+        self.id = msg[1]
+        self.path = msg[2]
+
 class EdgeFinished(object):
     """Parsed edge finished message from Ninja.
 
@@ -186,7 +214,8 @@ class EdgeFinished(object):
         end_time_millis (int): Edge end time in milliseconds since Ninja
             started.
         status (int): Exit status (0 for success).
-        output (:obj:`str`): Edge output, may contain ANSI codes .
+        output (:obj:`str`): Edge output, may contain ANSI codes.  Output
+            sent earlier in edge output messages is not repeated.
         edge_started (:obj:`EdgeStarted`): EdgeStarted object with for the
             edge identification number.
     """
@@ -198,6 +227,22 @@ class EdgeFinished(object):
         self.output = msg[4]
         self.edge_started = None
 
+class EdgeOutput(object):
+    """Parsed edge output message from Ninja.
+
+    Attributes:
+        id (int): Edge identification number, matching a running edge.
+        output (:obj:`str`): Output printed by the edge since the last
+            edge output message, may contain ANSI codes.
+        edge_started (:obj:`EdgeStarted`): EdgeStarted object with for the
+            edge identification number.
+    """
+    def __init__(self, msg):
+        assert len(msg) >= 3
+        self.id = msg[1]
+        self.output = msg[2]
+        self.edge_started = None
+
 class Message(object):
     """Parsed text message from Ninja.
 
@@ -260,11 +305,14 @@ class Frontend(object):
     Attributes:
         running (:obj:`dict` of :obj:`EdgeStarted` messages): edges that
             have been started but not yet finished.
+        paths (:obj:`list` of :obj:`str`): paths defined so far, indexed by
+            path identification number.
     """
     def __init__(self, handler):
         self.handler = handler
         self.unpacker = msgpack.Unpacker(encoding="utf-8")
         self.running = {}
+        self.paths = []
         self.seen_header = False
         self.fd = 3
         self.reader = NonBlockingReader(self.fd)
@@ -290,8 +338,8 @@ class Frontend(object):
             if not self.seen_header:
                 if type(msg) is not int:
                     raise InvalidMessageException("Expected int, got " + str(type(msg)), msg)
-                if msg != HEADER:
-                    raise InvalidMessageException("Expected {}, got {}".format(BUILD_STARTED, msg), msg)
+                if msg != HEADER and msg != HEADER_V1:
+                    raise InvalidMessageException("Expected {}, got {}".format(HEADER, msg), msg)
                 self.seen_header = True
                 continue
 
@@ -314,8 +362,16 @@ class Frontend(object):
                 elif msgtype == BUILD_FINISHED:
                     func = self.handler.build_finished
                     obj = BuildFinished(msg)
+                elif msgtype == DEFINE_PATH:
+                    obj = DefinePath(msg)
+                    if obj.id != len(self.paths):
+                        raise InvalidMessageException("Expected path id {}, got {}".format(len(self.paths), obj.id), msg)
+                    self.paths.append(obj.path)
+                    continue
                 elif msgtype == EDGE_STARTED:
                     obj = EdgeStarted(msg)
+                    obj.inputs = [self.path(p) for p in obj.inputs]
+                    obj.outputs = [self.path(p) for p in obj.outputs]
                     self.running[obj.id] = obj
                     func = self.handler.edge_started
                 elif msgtype == EDGE_FINISHED:
@@ -323,6 +379,10 @@ class Frontend(object):
                     obj = EdgeFinished(msg)
                     obj.edge_started = self.running[obj.id]
                     del self.running[obj.id]
+                elif msgtype == EDGE_OUTPUT:
+                    func = self.handler.edge_output
+                    obj = EdgeOutput(msg)
+                    obj.edge_started = self.running[obj.id]
                 elif msgtype == NINJA_INFO:
                     func = self.handler.info
                     obj = Message(msg)
@@ -338,3 +398,14 @@ class Frontend(object):
             except AttributeError:
                 continue
             func(obj)
+
+    def path(self, path):
+        """Resolve a path identification number to the path it was defined
+        as.  Paths in version 1 streams are strings, and returned as is.
+
+        Args:
+            path (int or :obj:`str`): path identification number or path
+        """
+        if type(path) is int:
+            return self.paths[path]
+        return path
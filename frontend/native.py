@@ -39,6 +39,8 @@ class Handler(frontend.Handler):
         self.running_edges = 0
         self.started_edges = 0
         self.finished_edges = 0
+        # Output of running edges, printed once they finish like ninja does.
+        self.edge_output = {}
 
         self.time_millis = 0
 
@@ -69,7 +71,11 @@ class Handler(frontend.Handler):
         if msg.console:
             self.printer.set_console_locked(True)
 
+    def edge_output(self, msg):
+        self.edge_output[msg.id] = self.edge_output.get(msg.id, '') + msg.output
+
     def edge_finished(self, msg):
+        msg.output = self.edge_output.pop(msg.id, '') + msg.output
         self.finished_edges += 1
         self.time_millis = msg.end_time_millis
         if msg.edge_started.console:
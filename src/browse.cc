@@ -14,60 +14,361 @@
 
 #include "browse.h"
 
+#include <errno.h>
+#include <netdb.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
 #include <unistd.h>
+
+#include <algorithm>
+#include <set>
 #include <vector>
 
-#include "build/browse_py.h"
+#include "build_log.h"
+#include "deps_log.h"
+#include "graph.h"
+#include "metrics.h"
+#include "state.h"
+#include "util.h"
+
+namespace {
+
+const char kPageStyle[] =
+"<!DOCTYPE html>\n"
+"<meta charset=utf-8>\n"
+"<style>\n"
+"body {\n"
+"    font-family: sans;\n"
+"    font-size: 0.8em;\n"
+"    margin: 4ex;\n"
+"}\n"
+"h1 {\n"
+"    font-weight: normal;\n"
+"    font-size: 140%;\n"
+"    text-align: center;\n"
+"    margin: 0;\n"
+"}\n"
+"h2 {\n"
+"    font-weight: normal;\n"
+"    font-size: 120%;\n"
+"}\n"
+"tt {\n"
+"    font-family: WebKitHack, monospace;\n"
+"    white-space: nowrap;\n"
+"}\n"
+"pre {\n"
+"    white-space: pre-wrap;\n"
+"}\n"
+".filelist {\n"
+"  -webkit-columns: auto 2;\n"
+"  columns: auto 2;\n"
+"}\n"
+"</style>\n";
+
+void AppendHTMLEscaped(const string& in, string* out) {
+  for (string::const_iterator c = in.begin(); c != in.end(); ++c) {
+    switch (*c) {
+      case '&': *out += "&amp;"; break;
+      case '<': *out += "&lt;"; break;
+      case '>': *out += "&gt;"; break;
+      case '"': *out += "&quot;"; break;
+      case '\'': *out += "&#39;"; break;
+      default: out->push_back(*c);
+    }
+  }
+}
+
+/// Append \a path as the query of a URL.
+void AppendURLEncoded(const string& path, string* out) {
+  for (string::const_iterator c = path.begin(); c != path.end(); ++c) {
+    if (isalnum((unsigned char)*c) || strchr("-_.~/", *c)) {
+      out->push_back(*c);
+    } else {
+      char buf[4];
+      snprintf(buf, sizeof(buf), "%%%02X", (unsigned char)*c);
+      *out += buf;
+    }
+  }
+}
+
+string URLDecode(const string& in) {
+  string out;
+  for (size_t i = 0; i < in.size(); ++i) {
+    if (in[i] == '%' && i + 2 < in.size() && isxdigit((unsigned char)in[i + 1])
+        && isxdigit((unsigned char)in[i + 2])) {
+      out.push_back((char)strtol(in.substr(i + 1, 2).c_str(), NULL, 16));
+      i += 2;
+    } else {
+      out.push_back(in[i]);
+    }
+  }
+  return out;
+}
+
+/// A list of links to the pages of \a paths, each followed by its note.
+void AppendFileList(const vector<pair<string, string> >& paths, string* out) {
+  *out += "<div class=filelist>\n";
+  for (vector<pair<string, string> >::const_iterator i = paths.begin();
+       i != paths.end(); ++i) {
+    *out += "<tt><a href=\"?";
+    AppendURLEncoded(i->first, out);
+    *out += "\">";
+    AppendHTMLEscaped(i->first, out);
+    *out += "</a>";
+    if (!i->second.empty()) {
+      *out += " (";
+      AppendHTMLEscaped(i->second, out);
+      *out += ")";
+    }
+    *out += "</tt><br>\n";
+  }
+  *out += "</div>\n";
+}
 
-void RunBrowsePython(State* state, const char* ninja_command,
-                     const char* input_file, int argc, char* argv[]) {
-  // Fork off a Python process and have it run our code via its stdin.
-  // (Actually the Python process becomes the parent.)
-  int pipefd[2];
-  if (pipe(pipefd) < 0) {
-    perror("ninja: pipe");
+string Response(const char* status, const string& headers,
+                const string& body) {
+  char length[32];
+  snprintf(length, sizeof(length), "%d", (int)body.size());
+  return string("HTTP/1.0 ") + status + "\r\n" + headers +
+         "Content-Length: " + length + "\r\n"
+         "Connection: close\r\n"
+         "\r\n" + body;
+}
+
+}  // anonymous namespace
+
+BrowseServer::BrowseServer(State* state, BuildLog* build_log,
+                           DepsLog* deps_log, const string& initial_target)
+    : state_(state), build_log_(build_log), deps_log_(deps_log),
+      initial_target_(initial_target), listen_fd_(-1) {}
+
+void BrowseServer::HandleRequest(const string& request, string* response) {
+  size_t method_end = request.find(' ');
+  size_t url_end = method_end == string::npos ? string::npos :
+                   request.find_first_of(" \r\n", method_end + 1);
+  if (url_end == string::npos) {
+    *response = Response("400 Bad Request", "", "");
     return;
   }
+  string method = request.substr(0, method_end);
+  if (method != "GET" && method != "HEAD") {
+    *response = Response("501 Not Implemented", "", "");
+    return;
+  }
+
+  string url = request.substr(method_end + 1, url_end - method_end - 1);
+  if (url == "/") {
+    string location;
+    AppendURLEncoded(initial_target_, &location);
+    *response = Response("302 Found", "Location: ?" + location + "\r\n", "");
+  } else if (url.compare(0, 2, "/?") == 0) {
+    *response = Response("200 OK",
+                         "Content-Type: text/html; charset=utf-8\r\n",
+                         RenderPage(URLDecode(url.substr(2))));
+  } else {
+    *response = Response("404 Not Found", "", "");
+  }
+  if (method == "HEAD")
+    response->resize(response->find("\r\n\r\n") + 4);
+}
+
+string BrowseServer::RenderPage(const string& target) {
+  METRIC_RECORD("browse page");
+  string page = kPageStyle;
+  string path = target, err;
+  uint64_t slash_bits;
+  Node* node = NULL;
+  if (CanonicalizePath(&path, &slash_bits, &err)) {
+    node = state_->LookupNode(path);
+    if (!node) {
+      err = "unknown target '" + path + "'";
+      if (Node* suggestion = state_->SpellcheckNode(path))
+        err += ", did you mean '" + suggestion->path() + "'?";
+    }
+  }
+  if (!node) {
+    page += "<h1><tt>";
+    AppendHTMLEscaped(err, &page);
+    page += "</tt></h1>\n";
+    return page;
+  }
+  RenderNode(node, &page);
+  return page;
+}
+
+void BrowseServer::RenderNode(Node* node, string* out) {
+  *out += "<h1><tt>";
+  AppendHTMLEscaped(node->path(), out);
+  *out += "</tt></h1>\n";
+
+  Edge* edge = node->in_edge();
+  if (edge && !edge->inputs_.empty()) {
+    *out += "<h2>target is built using rule <tt>";
+    AppendHTMLEscaped(edge->rule_->name(), out);
+    *out += "</tt> of</h2>\n";
+    vector<pair<string, string> > inputs;
+    for (size_t i = 0; i < edge->inputs_.size(); ++i) {
+      const char* type = edge->is_order_only(i) ? "order-only" :
+                         edge->is_implicit(i) ? "implicit" : "";
+      inputs.push_back(make_pair(edge->inputs_[i]->path(), string(type)));
+    }
+    sort(inputs.begin(), inputs.end());
+    AppendFileList(inputs, out);
+  }
+
+  if (edge && !edge->is_phony()) {
+    *out += "<h2>command</h2>\n<pre>";
+    string command = edge->EvaluateCommand();
+    AppendHTMLEscaped(command, out);
+    *out += "</pre>\n";
+
+    BuildLog::LogEntry* entry =
+        build_log_ ? build_log_->LookupByOutput(node->path()) : NULL;
+    if (entry) {
+      char timing[128];
+      snprintf(timing, sizeof(timing),
+               "<p>last built in %.3fs, %.3fs into its build",
+               (entry->end_time - entry->start_time) / 1000.0,
+               entry->start_time / 1000.0);
+      *out += timing;
+      if (BuildLog::LogEntry::HashCommand(
+              edge->EvaluateCommand(/*incl_rsp_file=*/true)) !=
+          entry->command_hash) {
+        *out += "; the command has changed since";
+      }
+      *out += "</p>\n";
+    } else {
+      *out += "<p>not in the build log</p>\n";
+    }
+  }
+
+  DepsLog::Deps* deps = deps_log_ ? deps_log_->GetDeps(node) : NULL;
+  if (deps) {
+    *out += "<h2>dependencies found when it was last built:</h2>\n";
+    vector<pair<string, string> > paths;
+    for (int i = 0; i < deps->node_count; ++i)
+      paths.push_back(make_pair(deps->nodes[i]->path(), string()));
+    sort(paths.begin(), paths.end());
+    AppendFileList(paths, out);
+  }
 
+  // The edges using the file are summarized by all they build.
+  set<string> outputs;
+  for (vector<Edge*>::const_iterator e = node->out_edges().begin();
+       e != node->out_edges().end(); ++e) {
+    for (vector<Node*>::iterator o = (*e)->outputs_.begin();
+         o != (*e)->outputs_.end(); ++o) {
+      outputs.insert((*o)->path());
+    }
+  }
+  if (!outputs.empty()) {
+    *out += "<h2>dependent edges build:</h2>\n";
+    vector<pair<string, string> > paths;
+    for (set<string>::iterator o = outputs.begin(); o != outputs.end(); ++o)
+      paths.push_back(make_pair(*o, string()));
+    AppendFileList(paths, out);
+  }
+}
+
+bool BrowseServer::Listen(const string& hostname, int port, string* err) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  char service[16];
+  snprintf(service, sizeof(service), "%d", port);
+  addrinfo* addrs;
+  int status = getaddrinfo(hostname.empty() ? NULL : hostname.c_str(),
+                           service, &hints, &addrs);
+  if (status != 0) {
+    *err = hostname + ": " + gai_strerror(status);
+    return false;
+  }
+  for (addrinfo* addr = addrs; addr; addr = addr->ai_next) {
+    int fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (fd < 0)
+      continue;
+    // Let a restarted server have the port at once.
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, addr->ai_addr, addr->ai_addrlen) == 0 &&
+        listen(fd, 16) == 0) {
+      listen_fd_ = fd;
+      break;
+    }
+    *err = string("bind: ") + strerror(errno);
+    close(fd);
+  }
+  freeaddrinfo(addrs);
+  return listen_fd_ >= 0;
+}
+
+bool BrowseServer::Run(string* err) {
+  // A browser that goes away mid-response only ends its own connection.
+  signal(SIGPIPE, SIG_IGN);
+  for (;;) {
+    int client = accept(listen_fd_, NULL, NULL);
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      *err = string("accept: ") + strerror(errno);
+      return false;
+    }
+    // Don't let a client that never finishes its request stall the rest.
+    timeval timeout = { 5, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    string request;
+    char buf[4096];
+    while (request.find("\r\n\r\n") == string::npos &&
+           request.size() < 64 * 1024) {
+      ssize_t len = read(client, buf, sizeof(buf));
+      if (len < 0 && errno == EINTR)
+        continue;
+      if (len <= 0)
+        break;
+      request.append(buf, len);
+    }
+
+    string response;
+    HandleRequest(request, &response);
+    for (size_t written = 0; written < response.size(); ) {
+      ssize_t len = write(client, response.data() + written,
+                          response.size() - written);
+      if (len < 0 && errno == EINTR)
+        continue;
+      if (len <= 0)
+        break;
+      written += len;
+    }
+    close(client);
+  }
+}
+
+void OpenBrowser(const string& url) {
   pid_t pid = fork();
   if (pid < 0) {
     perror("ninja: fork");
     return;
   }
-
-  if (pid > 0) {  // Parent.
-    close(pipefd[1]);
-    do {
-      if (dup2(pipefd[0], 0) < 0) {
-        perror("ninja: dup2");
-        break;
-      }
-
-      std::vector<const char *> command;
-      command.push_back(NINJA_PYTHON);
-      command.push_back("-");
-      command.push_back("--ninja-command");
-      command.push_back(ninja_command);
-      command.push_back("-f");
-      command.push_back(input_file);
-      for (int i = 0; i < argc; i++) {
-          command.push_back(argv[i]);
-      }
-      command.push_back(NULL);
-      execvp(command[0], (char**)&command[0]);
-      perror("ninja: execvp");
-    } while (false);
-    _exit(1);
-  } else {  // Child.
-    close(pipefd[0]);
-
-    // Write the script file into the stdin of the Python process.
-    ssize_t len = write(pipefd[1], kBrowsePy, sizeof(kBrowsePy));
-    if (len < (ssize_t)sizeof(kBrowsePy))
-      perror("ninja: write");
-    close(pipefd[1]);
-    exit(0);
+  if (pid > 0) {
+    waitpid(pid, NULL, 0);
+    return;
   }
+  // Fork again, so that the browser doesn't become our zombie.
+  if (fork() != 0)
+    _exit(0);
+#ifdef __APPLE__
+  execlp("open", "open", url.c_str(), (char*)NULL);
+#else
+  execlp("xdg-open", "xdg-open", url.c_str(), (char*)NULL);
+#endif
+  perror("ninja: could not open a web browser");
+  _exit(1);
 }
@@ -15,14 +15,46 @@
 #ifndef NINJA_BROWSE_H_
 #define NINJA_BROWSE_H_
 
+#include <string>
+using namespace std;
+
+struct BuildLog;
+struct DepsLog;
+struct Node;
 struct State;
 
-/// Run in "browse" mode, which execs a Python webserver.
-/// \a ninja_command is the command used to invoke ninja.
-/// \a args are the number of arguments to be passed to the Python script.
-/// \a argv are arguments to be passed to the Python script.
-/// This function does not return if it runs successfully.
-void RunBrowsePython(State* state, const char* ninja_command,
-                     const char* input_file, int argc, char* argv[]);
+/// Serves a page about each file of the build over HTTP, rendered from the
+/// graph and logs already in memory, so pages come back at once however
+/// large the build is.
+struct BrowseServer {
+  BrowseServer(State* state, BuildLog* build_log, DepsLog* deps_log,
+               const string& initial_target);
+
+  /// Set \a response to the whole HTTP response to \a request, the
+  /// request line and headers.
+  void HandleRequest(const string& request, string* response);
+
+  /// Listen for connections on \a hostname and \a port; an empty
+  /// hostname listens on all interfaces.
+  bool Listen(const string& hostname, int port, string* err);
+
+  /// Answer requests one connection at a time, until killed.
+  bool Run(string* err);
+
+ private:
+  /// The HTML page about \a path.
+  string RenderPage(const string& path);
+  /// The body of the page about \a node.
+  void RenderNode(Node* node, string* out);
+
+  State* state_;
+  BuildLog* build_log_;
+  DepsLog* deps_log_;
+  string initial_target_;
+  int listen_fd_;
+};
+
+/// Open \a url in a web browser, without waiting for it.
+void OpenBrowser(const string& url);
 
 #endif  // NINJA_BROWSE_H_
@@ -0,0 +1,108 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "browse.h"
+
+#include <unistd.h>
+
+#include "build_log.h"
+#include "deps_log.h"
+#include "graph.h"
+#include "state.h"
+#include "test.h"
+
+namespace {
+
+const char kTestDepsLog[] = "BrowseTest-deps";
+
+struct BrowseTest : public StateTestWithBuiltinRules {
+  BrowseTest() : server_(&state_, &build_log_, &deps_log_, "a b") {}
+
+  virtual void SetUp() {
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build foo.o: cat foo.c | gen.h || dir\n"
+"build dir: phony\n"
+"build app: cat foo.o\n"));
+  }
+
+  virtual void TearDown() {
+    unlink(kTestDepsLog);
+  }
+
+  string Get(const string& url) {
+    string response;
+    server_.HandleRequest("GET " + url + " HTTP/1.1\r\nHost: x\r\n\r\n",
+                          &response);
+    return response;
+  }
+
+  BuildLog build_log_;
+  DepsLog deps_log_;
+  BrowseServer server_;
+};
+
+TEST_F(BrowseTest, Redirect) {
+  string response = Get("/");
+  EXPECT_EQ(0u, response.find("HTTP/1.0 302 Found\r\n"));
+  EXPECT_NE(string::npos, response.find("\r\nLocation: ?a%20b\r\n"));
+  EXPECT_EQ(0u, Get("/favicon.ico").find("HTTP/1.0 404 Not Found\r\n"));
+  string post;
+  server_.HandleRequest("POST / HTTP/1.1\r\n\r\n", &post);
+  EXPECT_EQ(0u, post.find("HTTP/1.0 501 Not Implemented\r\n"));
+}
+
+TEST_F(BrowseTest, Page) {
+  string response = Get("/?foo%2eo");
+  EXPECT_EQ(0u, response.find("HTTP/1.0 200 OK\r\n"));
+  EXPECT_NE(string::npos, response.find("<h1><tt>foo.o</tt></h1>"));
+  EXPECT_NE(string::npos,
+            response.find("built using rule <tt>cat</tt> of"));
+  EXPECT_NE(string::npos, response.find(
+      "<tt><a href=\"?dir\">dir</a> (order-only)</tt><br>\n"
+      "<tt><a href=\"?foo.c\">foo.c</a></tt><br>\n"
+      "<tt><a href=\"?gen.h\">gen.h</a> (implicit)</tt><br>\n"));
+  EXPECT_NE(string::npos, response.find("<pre>cat foo.c &gt; foo.o</pre>"));
+  EXPECT_NE(string::npos, response.find("not in the build log"));
+  EXPECT_NE(string::npos, response.find(
+      "dependent edges build:</h2>\n<div class=filelist>\n"
+      "<tt><a href=\"?app\">app</a></tt>"));
+}
+
+TEST_F(BrowseTest, Logs) {
+  build_log_.RecordCommand(GetNode("foo.o")->in_edge(), 100, 1600);
+  string err;
+  ASSERT_TRUE(deps_log_.OpenForWrite(kTestDepsLog, &err));
+  vector<Node*> deps;
+  deps.push_back(GetNode("foo.h"));
+  ASSERT_TRUE(deps_log_.RecordDeps(GetNode("foo.o"), 5, deps));
+  deps_log_.Close();
+
+  string response = Get("/?foo.o");
+  EXPECT_NE(string::npos,
+            response.find("last built in 1.500s, 0.100s into its build"));
+  EXPECT_EQ(string::npos, response.find("changed"));
+  EXPECT_NE(string::npos, response.find(
+      "found when it was last built:</h2>\n<div class=filelist>\n"
+      "<tt><a href=\"?foo.h\">foo.h</a></tt>"));
+}
+
+TEST_F(BrowseTest, UnknownTarget) {
+  string response = Get("/?fooo.o");
+  EXPECT_NE(string::npos, response.find(
+      "<h1><tt>unknown target &#39;fooo.o&#39;, did you mean "
+      "&#39;foo.o&#39;?</tt></h1>"));
+}
+
+}  // anonymous namespace
@@ -18,7 +18,13 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 #ifdef _WIN32
 #include <fcntl.h>
@@ -30,16 +36,19 @@
 #endif
 
 #include "build_log.h"
+#include "cgroup.h"
 #include "clparser.h"
 #include "debug_flags.h"
 #include "depfile_parser.h"
 #include "deps_log.h"
 #include "disk_interface.h"
 #include "graph.h"
+#include "job_limiter.h"
 #include "metrics.h"
 #include "state.h"
 #include "status.h"
 #include "subprocess.h"
+#include "trace.h"
 #include "util.h"
 
 namespace {
@@ -85,13 +94,15 @@ void Plan::Reset() {
   wanted_edges_ = 0;
   ready_.clear();
   want_.clear();
+  built_dyndeps_ = queue<Node*>();
 }
 
 bool Plan::AddTarget(Node* node, string* err) {
-  return AddSubTarget(node, NULL, err);
+  return AddSubTarget(node, NULL, err, NULL);
 }
 
-bool Plan::AddSubTarget(Node* node, Node* dependent, string* err) {
+bool Plan::AddSubTarget(Node* node, Node* dependent, string* err,
+                        set<Edge*>* dyndep_walk) {
   Edge* edge = node->in_edge();
   if (!edge) {  // Leaf node.
     if (node->dirty()) {
@@ -118,24 +129,43 @@ bool Plan::AddSubTarget(Node* node, Node* dependent, string* err) {
   if (node->dirty() && !want) {
     want = true;
     ++wanted_edges_;
-    if (edge->AllInputsReady())
+    // A new edge is scheduled below, once its inputs are counted.
+    if (!dyndep_walk && !want_ins.second && edge->pending_inputs_ == 0)
       ScheduleWork(edge);
     if (!edge->is_phony())
       ++command_edges_;
   }
 
+  if (dyndep_walk)
+    dyndep_walk->insert(edge);
+
   if (!want_ins.second)
     return true;  // We've already processed the inputs.
 
   for (vector<Node*>::iterator i = edge->inputs_.begin();
        i != edge->inputs_.end(); ++i) {
-    if (!AddSubTarget(*i, node, err) && !err->empty())
+    if (!AddSubTarget(*i, node, err, dyndep_walk) && !err->empty())
       return false;
   }
 
+  CountPendingInputs(edge);
+  if (want && !dyndep_walk && edge->pending_inputs_ == 0)
+    ScheduleWork(edge);
+
   return true;
 }
 
+void Plan::CountPendingInputs(Edge* edge) {
+  // Any input whose edge isn't ready is in the plan by now.
+  edge->pending_inputs_ = 0;
+  for (vector<Node*>::iterator i = edge->inputs_.begin();
+       i != edge->inputs_.end(); ++i) {
+    Edge* in_edge = (*i)->in_edge();
+    if (in_edge && want_.count(in_edge))
+      ++edge->pending_inputs_;
+  }
+}
+
 Edge* Plan::FindWork() {
   if (ready_.empty())
     return NULL;
@@ -192,26 +222,224 @@ void Plan::EdgeFinished(Edge* edge, EdgeResult result) {
 }
 
 void Plan::NodeFinished(Node* node) {
-  // See if we we want any edges from this node.
+  // Check the node off the edges in the plan that read it.  out_edges()
+  // lists an edge as often as it reads the node, as pending_inputs_ counts.
+  vector<Edge*> ready;
   for (vector<Edge*>::const_iterator oe = node->out_edges().begin();
        oe != node->out_edges().end(); ++oe) {
+    if (!want_.count(*oe))
+      continue;
+    assert((*oe)->pending_inputs_ > 0);
+    if (--(*oe)->pending_inputs_ == 0)
+      ready.push_back(*oe);
+  }
+
+  // The edges after a dyndep file wait until it has been loaded, and
+  // DyndepsLoaded() has seen what else they need.
+  if (node->dyndep_pending()) {
+    built_dyndeps_.push(node);
+    return;
+  }
+
+  // See if we we want any edges from this node.
+  for (vector<Edge*>::iterator oe = ready.begin(); oe != ready.end(); ++oe) {
+    // Finishing one edge may finish others that aren't wanted.
     map<Edge*, bool>::iterator want_e = want_.find(*oe);
-    if (want_e == want_.end())
+    if (want_e != want_.end())
+      EdgeMaybeReady(want_e);
+  }
+}
+
+void Plan::EdgeMaybeReady(map<Edge*, bool>::iterator want_e) {
+  Edge* edge = want_e->first;
+  if (edge->pending_inputs_ > 0)
+    return;
+  if (want_e->second) {
+    ScheduleWork(edge);
+  } else {
+    // We do not need to build this edge, but we might need to build one of
+    // its dependents.
+    EdgeFinished(edge, kEdgeSucceeded);
+  }
+}
+
+Node* Plan::NextBuiltDyndep() {
+  if (built_dyndeps_.empty())
+    return NULL;
+  Node* node = built_dyndeps_.front();
+  built_dyndeps_.pop();
+  return node;
+}
+
+bool Plan::DyndepsLoaded(DependencyScan* scan, Node* node,
+                         const DyndepFile& ddf, string* err) {
+  if (scan && !RefreshDyndepDependents(scan, node, err))
+    return false;
+
+  // Add the inputs the file found for edges in the plan.  Edges that
+  // aren't in it have nothing in the plan waiting for them, and will be
+  // seen with their new inputs if something comes to.
+  set<Edge*> dyndep_walk;
+  for (DyndepFile::const_iterator oe = ddf.begin(); oe != ddf.end(); ++oe) {
+    Edge* edge = oe->first;
+    if (edge->outputs_ready() || !want_.count(edge))
       continue;
+    for (vector<Node*>::const_iterator i = oe->second.implicit_inputs_.begin();
+         i != oe->second.implicit_inputs_.end(); ++i) {
+      if (!AddSubTarget(*i, edge->outputs_[0], err, &dyndep_walk) &&
+          !err->empty())
+        return false;
+    }
+  }
+  // The edges now read more, some of which the plan is yet to build.
+  for (DyndepFile::const_iterator oe = ddf.begin(); oe != ddf.end(); ++oe) {
+    if (want_.count(oe->first))
+      CountPendingInputs(oe->first);
+  }
 
-    // See if the edge is now ready.
-    if ((*oe)->AllInputsReady()) {
-      if (want_e->second) {
-        ScheduleWork(*oe);
-      } else {
-        // We do not need to build this edge, but we might need to build one of
-        // its dependents.
-        EdgeFinished(*oe, kEdgeSucceeded);
-      }
+  // The edges after the file are what NodeFinished() held back.
+  for (vector<Edge*>::const_iterator oe = node->out_edges().begin();
+       oe != node->out_edges().end(); ++oe) {
+    if (want_.count(*oe))
+      dyndep_walk.insert(*oe);
+  }
+
+  for (set<Edge*>::iterator i = dyndep_walk.begin(); i != dyndep_walk.end();
+       ++i) {
+    // Finishing one edge may finish others that aren't wanted.
+    map<Edge*, bool>::iterator want_e = want_.find(*i);
+    if (want_e != want_.end())
+      EdgeMaybeReady(want_e);
+  }
+  return true;
+}
+
+bool Plan::RefreshDyndepDependents(DependencyScan* scan, Node* node,
+                                   string* err) {
+  set<Node*> dependents;
+  UnmarkDependents(node, &dependents);
+
+  for (set<Node*>::iterator i = dependents.begin(); i != dependents.end();
+       ++i) {
+    Node* n = *i;
+    // This also rejects cycles through the new dependencies.
+    if (!scan->RecomputeDirty(n, err))
+      return false;
+    // The deps it loaded again may list more inputs.
+    CountPendingInputs(n->in_edge());
+    if (!n->dirty())
+      continue;
+
+    // Without the file, the edge may have looked clean; now that it is
+    // known to be dirty, build it.
+    Edge* edge = n->in_edge();
+    assert(edge && !edge->outputs_ready());
+    map<Edge*, bool>::iterator want_e = want_.find(edge);
+    assert(want_e != want_.end());
+    if (!want_e->second) {
+      want_e->second = true;
+      ++wanted_edges_;
+      if (!edge->is_phony())
+        ++command_edges_;
+    }
+  }
+  return true;
+}
+
+void Plan::UnmarkDependents(Node* node, set<Node*>* dependents) {
+  for (vector<Edge*>::const_iterator oe = node->out_edges().begin();
+       oe != node->out_edges().end(); ++oe) {
+    Edge* edge = *oe;
+    if (!want_.count(edge) || edge->mark_ == Edge::VisitNone)
+      continue;
+    edge->mark_ = Edge::VisitNone;
+    for (vector<Node*>::iterator o = edge->outputs_.begin();
+         o != edge->outputs_.end(); ++o) {
+      if (dependents->insert(*o).second)
+        UnmarkDependents(*o, dependents);
     }
   }
 }
 
+void Plan::ComputeCriticalTimes(BuildLog* build_log) {
+  METRIC_RECORD("ComputeCriticalTimes");
+
+  // Only pools that delay edges order them by critical time; without one
+  // in the plan, don't spend time on a large graph for nothing.
+  bool delays = false;
+  for (map<Edge*, bool>::iterator e = want_.begin(); e != want_.end(); ++e) {
+    if (e->first->pool()->ShouldDelayEdge()) {
+      delays = true;
+      break;
+    }
+  }
+  if (!delays)
+    return;
+
+  // Start with the duration of each command from the last time it ran.
+  // Commands that haven't run are assumed to take the average time.
+  int64_t known_total = 0;
+  int known_count = 0;
+  vector<Edge*> unknown;
+  for (map<Edge*, bool>::iterator e = want_.begin(); e != want_.end(); ++e) {
+    Edge* edge = e->first;
+    edge->critical_time_ = 0;
+    if (!e->second || edge->is_phony())
+      continue;
+    BuildLog::LogEntry* entry =
+        build_log ? build_log->LookupByOutput(edge->outputs_[0]->path())
+                  : NULL;
+    if (entry) {
+      edge->critical_time_ = entry->end_time - entry->start_time;
+      known_total += edge->critical_time_;
+      ++known_count;
+    } else {
+      unknown.push_back(edge);
+    }
+  }
+  for (vector<Edge*>::iterator e = unknown.begin(); e != unknown.end(); ++e)
+    (*e)->critical_time_ = known_count ? known_total / known_count : 0;
+
+  // Count the edges in the plan waiting for each edge, and work back from
+  // those nothing waits for, adding the longest chain after each edge.
+  map<Edge*, int> dependents;
+  map<Edge*, int64_t> longest_after;
+  for (map<Edge*, bool>::iterator e = want_.begin(); e != want_.end(); ++e) {
+    for (vector<Node*>::iterator i = e->first->inputs_.begin();
+         i != e->first->inputs_.end(); ++i) {
+      Edge* in_edge = (*i)->in_edge();
+      if (in_edge && want_.count(in_edge))
+        ++dependents[in_edge];
+    }
+  }
+  vector<Edge*> done;
+  for (map<Edge*, bool>::iterator e = want_.begin(); e != want_.end(); ++e) {
+    if (!dependents.count(e->first))
+      done.push_back(e->first);
+  }
+  set<Pool*> pools;
+  while (!done.empty()) {
+    Edge* edge = done.back();
+    done.pop_back();
+    edge->critical_time_ += longest_after[edge];
+    pools.insert(edge->pool());
+    for (vector<Node*>::iterator i = edge->inputs_.begin();
+         i != edge->inputs_.end(); ++i) {
+      Edge* in_edge = (*i)->in_edge();
+      if (!in_edge || !want_.count(in_edge))
+        continue;
+      int64_t& after = longest_after[in_edge];
+      after = max(after, edge->critical_time_);
+      if (--dependents[in_edge] == 0)
+        done.push_back(in_edge);
+    }
+  }
+
+  // Edges may already wait in their pools.
+  for (set<Pool*>::iterator p = pools.begin(); p != pools.end(); ++p)
+    (*p)->ReorderDelayedEdges();
+}
+
 bool Plan::CleanNode(DependencyScan* scan, Node* node, string* err) {
   node->set_dirty(false);
 
@@ -264,6 +492,14 @@ bool Plan::CleanNode(DependencyScan* scan, Node* node, string* err) {
   return true;
 }
 
+void Plan::GetWantedEdges(vector<Edge*>* edges) const {
+  for (map<Edge*, bool>::const_iterator e = want_.begin(); e != want_.end();
+       ++e) {
+    if (e->second)
+      edges->push_back(e->first);
+  }
+}
+
 void Plan::Dump() {
   printf("pending: %d\n", (int)want_.size());
   for (map<Edge*, bool>::iterator e = want_.begin(); e != want_.end(); ++e) {
@@ -275,17 +511,51 @@ void Plan::Dump() {
 }
 
 struct RealCommandRunner : public CommandRunner {
-  explicit RealCommandRunner(const BuildConfig& config) : config_(config) {}
+  RealCommandRunner(const BuildConfig& config, Status* status)
+      : config_(config), next_partial_output_millis_(0),
+        wake_at_millis_(-1) {
+    if (config_.adaptive_parallelism) {
+      job_limiter_.reset(new JobLimiter(GetProcessorCount(),
+                                        config_.parallelism,
+                                        GetProcessorCount(), status));
+    }
+#ifndef _WIN32
+    if (!config_.cgroup_parent.empty()) {
+      string err;
+      if (!cgroups_.Init(config_.cgroup_parent, &err))
+        Fatal("--cgroup: %s", err.c_str());
+    }
+#endif
+  }
   virtual ~RealCommandRunner() {}
   virtual bool CanRunMore();
   virtual bool StartCommand(Edge* edge);
   virtual bool WaitForCommand(Result* result);
   virtual vector<Edge*> GetActiveEdges();
   virtual void Abort();
+  virtual void Wake();
+  virtual void WakeAt(int64_t time_millis);
+
+  /// Queue the output of the running commands that printed something,
+  /// if partial output is wanted and it is time for it.  Returns how long
+  /// until the next time, or -1 if there is nothing to wait for.
+  int CollectPartialOutput();
 
   const BuildConfig& config_;
   SubprocessSet subprocs_;
   map<Subprocess*, Edge*> subproc_to_edge_;
+  /// Output of running commands, returned before waiting for more.
+  queue<Result> partial_results_;
+  int64_t next_partial_output_millis_;
+  /// When WaitForCommand() should give up waiting, or -1.
+  int64_t wake_at_millis_;
+  /// Decides how many jobs to run, if that adapts to the machine's load.
+  auto_ptr<JobLimiter> job_limiter_;
+#ifndef _WIN32
+  CgroupSet cgroups_;
+  /// The cgroup leaf of each command, if they run in cgroups.
+  map<Subprocess*, string> subproc_to_cgroup_;
+#endif
 };
 
 vector<Edge*> RealCommandRunner::GetActiveEdges() {
@@ -298,33 +568,140 @@ vector<Edge*> RealCommandRunner::GetActiveEdges() {
 
 void RealCommandRunner::Abort() {
   subprocs_.Clear();
+#ifndef _WIN32
+  for (map<Subprocess*, string>::iterator i = subproc_to_cgroup_.begin();
+       i != subproc_to_cgroup_.end(); ++i) {
+    CgroupSet::Usage usage;
+    cgroups_.RemoveLeaf(i->second, &usage);
+  }
+  subproc_to_cgroup_.clear();
+#endif
+}
+
+void RealCommandRunner::Wake() {
+  subprocs_.Wake();
+}
+
+void RealCommandRunner::WakeAt(int64_t time_millis) {
+  wake_at_millis_ = time_millis;
 }
 
 bool RealCommandRunner::CanRunMore() {
   size_t subproc_number =
       subprocs_.running_.size() + subprocs_.finished_.size();
-  return (int)subproc_number < config_.parallelism
+  int parallelism = config_.parallelism;
+  if (job_limiter_.get())
+    parallelism = job_limiter_->Limit(subproc_number, GetTimeMillis());
+  return (int)subproc_number < parallelism
     && ((subprocs_.running_.empty() || config_.max_load_average <= 0.0f)
         || GetLoadAverage() < config_.max_load_average);
 }
 
 bool RealCommandRunner::StartCommand(Edge* edge) {
   string command = edge->EvaluateCommand();
+#ifndef _WIN32
+  string cgroup;
+  if (!config_.cgroup_parent.empty()) {
+    CgroupSet::Limits limits;
+    limits.cpu_max = edge->GetBinding("cgroup_cpu_max");
+    limits.memory_max = edge->GetBinding("cgroup_memory_max");
+    string err;
+    if (!cgroups_.CreateLeaf(limits, &cgroup, &err)) {
+      Error("%s", err.c_str());
+      return false;
+    }
+  }
+  Subprocess* subproc = subprocs_.Add(command, edge->use_console(), -1, cgroup);
+#else
   Subprocess* subproc = subprocs_.Add(command, edge->use_console());
+#endif
   if (!subproc)
     return false;
   subproc_to_edge_.insert(make_pair(subproc, edge));
+#ifndef _WIN32
+  if (!cgroup.empty())
+    subproc_to_cgroup_[subproc] = cgroup;
+#endif
 
   return true;
 }
 
+int RealCommandRunner::CollectPartialOutput() {
+  if (config_.partial_output_millis <= 0)
+    return -1;
+
+  // The /showIncludes lines of deps = msvc commands go to the deps log and
+  // are filtered out of what is shown, which takes all of the output.
+  vector<Subprocess*> streamed;
+  for (vector<Subprocess*>::iterator i = subprocs_.running_.begin();
+       i != subprocs_.running_.end(); ++i) {
+    if (!(*i)->GetOutput().empty() &&
+        subproc_to_edge_[*i]->GetBinding("deps") != "msvc") {
+      streamed.push_back(*i);
+    }
+  }
+  if (streamed.empty())
+    return -1;
+
+  int64_t now = GetTimeMillis();
+  if (now < next_partial_output_millis_)
+    return (int)(next_partial_output_millis_ - now);
+  next_partial_output_millis_ = now + config_.partial_output_millis;
+
+  for (vector<Subprocess*>::iterator i = streamed.begin(); i != streamed.end();
+       ++i) {
+    partial_results_.push(Result());
+    Result& partial = partial_results_.back();
+    partial.edge = subproc_to_edge_[*i];
+    partial.partial = true;
+    (*i)->TakeOutput(&partial.output);
+  }
+  return config_.partial_output_millis;
+}
+
 bool RealCommandRunner::WaitForCommand(Result* result) {
   Subprocess* subproc;
-  while ((subproc = subprocs_.NextFinished()) == NULL) {
-    bool interrupted = subprocs_.DoWork();
+  for (;;) {
+    // Partial output comes first, as it was printed before the command
+    // finished.
+    if (!partial_results_.empty()) {
+      *result = partial_results_.front();
+      partial_results_.pop();
+      wake_at_millis_ = -1;
+      return true;
+    }
+    if ((subproc = subprocs_.NextFinished()) != NULL)
+      break;
+
+    int timeout_millis = CollectPartialOutput();
+    if (!partial_results_.empty())
+      continue;
+    // Come back when the job limit might go up, to start more commands.
+    int64_t wake_at_millis = wake_at_millis_;
+    if (job_limiter_.get() && job_limiter_->limited() &&
+        (wake_at_millis < 0 ||
+         job_limiter_->next_sample_millis() < wake_at_millis)) {
+      wake_at_millis = job_limiter_->next_sample_millis();
+    }
+    if (wake_at_millis >= 0) {
+      int64_t now = GetTimeMillis();
+      if (now >= wake_at_millis) {
+        wake_at_millis_ = -1;
+        result->edge = NULL;
+        return true;
+      }
+      if (timeout_millis < 0 || wake_at_millis - now < timeout_millis)
+        timeout_millis = (int)(wake_at_millis - now);
+    }
+    bool interrupted = subprocs_.DoWork(timeout_millis);
     if (interrupted)
       return false;
+    if (subprocs_.woken()) {
+      result->edge = NULL;
+      return true;
+    }
   }
+  wake_at_millis_ = -1;
 
   result->status = subproc->Finish();
   result->output = subproc->GetOutput();
@@ -333,17 +710,142 @@ bool RealCommandRunner::WaitForCommand(Result* result) {
   result->edge = e->second;
   subproc_to_edge_.erase(e);
 
+#ifndef _WIN32
+  map<Subprocess*, string>::iterator cgroup = subproc_to_cgroup_.find(subproc);
+  if (cgroup != subproc_to_cgroup_.end()) {
+    CgroupSet::Usage usage;
+    cgroups_.RemoveLeaf(cgroup->second, &usage);
+    subproc_to_cgroup_.erase(cgroup);
+    result->cpu_micros = usage.cpu_micros;
+    result->peak_memory_bytes = usage.peak_memory_bytes;
+    if (usage.oom_kills) {
+      if (!result->output.empty() && *result->output.rbegin() != '\n')
+        result->output += "\n";
+      result->output += "ninja: the command ran out of memory "
+                        "(cgroup_memory_max = " +
+                        result->edge->GetBinding("cgroup_memory_max") + ")\n";
+    }
+  }
+#endif
+
   delete subproc;
   return true;
 }
 
+/// Writes response files on a background thread and hands their edges
+/// back to the Builder once written.  Only the Builder's thread calls its
+/// methods.
+struct RspfileWriter {
+  RspfileWriter(DiskInterface* disk_interface, CommandRunner* command_runner)
+      : disk_interface_(disk_interface), command_runner_(command_runner),
+        pending_(0), stopping_(false) {
+    thread_ = std::thread(&RspfileWriter::Run, this);
+  }
+
+  /// Skip the response files not being written yet, and stop.  The
+  /// commands of the edges not taken yet will never run, so remove their
+  /// response files, which a build cut short would otherwise leave behind.
+  ~RspfileWriter() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stopping_ = true;
+      wake_.notify_one();
+    }
+    thread_.join();
+
+    for (deque<pair<Edge*, bool> >::iterator w = written_.begin();
+         w != written_.end(); ++w) {
+      disk_interface_->RemoveFile(w->first->GetUnescapedRspfile());
+    }
+    // Those not written yet may be left from an earlier build.
+    for (deque<Job>::iterator j = queue_.begin(); j != queue_.end(); ++j)
+      disk_interface_->RemoveFile(j->path);
+  }
+
+  /// Queue writing \a content, which is swapped out, to \a path.
+  void Write(Edge* edge, const string& path, string* content) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.push_back(Job());
+    queue_.back().edge = edge;
+    queue_.back().path = path;
+    queue_.back().content.swap(*content);
+    ++pending_;
+    wake_.notify_one();
+  }
+
+  /// Take an edge whose response file has been written, if any.
+  bool NextWritten(Edge** edge, bool* success) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (written_.empty())
+      return false;
+    *edge = written_.front().first;
+    *success = written_.front().second;
+    written_.pop_front();
+    --pending_;
+    return true;
+  }
+
+  /// Block until NextWritten() has an edge.
+  void WaitForWritten() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (written_.empty())
+      done_.wait(lock);
+  }
+
+  /// Number of edges passed to Write() but not yet taken by NextWritten().
+  int pending() const { return pending_; }
+
+ private:
+  struct Job {
+    Edge* edge;
+    string path;
+    string content;
+  };
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      while (queue_.empty() && !stopping_)
+        wake_.wait(lock);
+      if (stopping_)
+        return;
+
+      Job job;
+      job.edge = queue_.front().edge;
+      job.path.swap(queue_.front().path);
+      job.content.swap(queue_.front().content);
+      queue_.pop_front();
+
+      lock.unlock();
+      bool success = disk_interface_->WriteFile(job.path, job.content);
+      lock.lock();
+
+      written_.push_back(make_pair(job.edge, success));
+      done_.notify_one();
+      command_runner_->Wake();
+    }
+  }
+
+  DiskInterface* disk_interface_;
+  CommandRunner* command_runner_;
+  int pending_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  deque<Job> queue_;
+  deque<pair<Edge*, bool> > written_;
+  bool stopping_;
+};
+
 Builder::Builder(State* state, const BuildConfig& config,
                  BuildLog* build_log, DepsLog* deps_log,
                  DiskInterface* disk_interface, Status* status,
                  int64_t start_time_millis)
     : state_(state), config_(config), status_(status),
       start_time_millis_(start_time_millis), disk_interface_(disk_interface),
-      scan_(state, build_log, deps_log, disk_interface) {
+      scan_(state, build_log, deps_log, disk_interface), trace_(NULL) {
 }
 
 Builder::~Builder() {
@@ -351,6 +853,8 @@ Builder::~Builder() {
 }
 
 void Builder::Cleanup() {
+  rspfile_writer_.reset();
+
   if (command_runner_.get()) {
     vector<Edge*> active_edges = command_runner_->GetActiveEdges();
     command_runner_->Abort();
@@ -413,7 +917,10 @@ bool Builder::AlreadyUpToDate() const {
 bool Builder::Build(string* err) {
   assert(!AlreadyUpToDate());
 
+  plan_.ComputeCriticalTimes(scan_.build_log());
   status_->PlanHasTotalEdges(plan_.command_edge_count());
+  if (trace_)
+    trace_->BuildStarted();
   int pending_commands = 0;
   int failures_allowed = config_.failures_allowed;
 
@@ -422,18 +929,38 @@ bool Builder::Build(string* err) {
     if (config_.dry_run)
       command_runner_.reset(new DryRunCommandRunner);
     else
-      command_runner_.reset(new RealCommandRunner(config_));
+      command_runner_.reset(new RealCommandRunner(config_, status_));
   }
 
   // We are about to start the build process.
   status_->BuildStarted();
 
+  if (config_.make_dirs_upfront && !config_.dry_run &&
+      !MakeAllOutputDirs(err)) {
+    status_->BuildFinished();
+    return false;
+  }
+
   // This main loop runs the entire build process.
   // It is structured like this:
   // First, we attempt to start as many commands as allowed by the
   // command runner.
   // Second, we attempt to wait for / reap the next finished command.
   while (plan_.more_to_do()) {
+    // Start the commands whose response files have been written.  These
+    // edges were started already, so do that even after failures.
+    Edge* rspfile_edge;
+    bool rspfile_written;
+    if (rspfile_writer_.get() && command_runner_->CanRunMore() &&
+        rspfile_writer_->NextWritten(&rspfile_edge, &rspfile_written)) {
+      if (!rspfile_written || !StartCommand(rspfile_edge, err)) {
+        Cleanup();
+        status_->BuildFinished();
+        return false;
+      }
+      continue;
+    }
+
     // See if we can start any more commands.
     if (failures_allowed && command_runner_->CanRunMore()) {
       if (Edge* edge = plan_.FindWork()) {
@@ -445,6 +972,13 @@ bool Builder::Build(string* err) {
 
         if (edge->is_phony()) {
           plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+          while (Node* dyndep = plan_.NextBuiltDyndep()) {
+            if (!LoadDyndeps(dyndep, err)) {
+              Cleanup();
+              status_->BuildFinished();
+              return false;
+            }
+          }
         } else {
           ++pending_commands;
         }
@@ -456,6 +990,19 @@ bool Builder::Build(string* err) {
 
     // See if we can reap any finished commands.
     if (pending_commands) {
+      // If no command is running, wait for a response file instead.
+      if (rspfile_writer_.get() &&
+          rspfile_writer_->pending() == pending_commands) {
+        rspfile_writer_->WaitForWritten();
+        continue;
+      }
+
+      // Don't leave a held back status update on screen while waiting.
+      int64_t refresh_millis =
+          status_->Refresh(GetTimeMillis() - start_time_millis_);
+      if (refresh_millis >= 0)
+        command_runner_->WakeAt(start_time_millis_ + refresh_millis);
+
       CommandRunner::Result result;
       if (!command_runner_->WaitForCommand(&result) ||
           result.status == ExitInterrupted) {
@@ -464,6 +1011,12 @@ bool Builder::Build(string* err) {
         *err = "interrupted by user";
         return false;
       }
+      if (!result.edge)
+        continue;  // Woken by the rspfile writer, or to refresh the status.
+      if (result.partial) {
+        status_->BuildEdgeOutput(result.edge, result.output);
+        continue;
+      }
 
       --pending_commands;
       if (!FinishCommand(&result, err)) {
@@ -502,6 +1055,8 @@ bool Builder::Build(string* err) {
 
 bool Builder::StartEdge(Edge* edge, string* err) {
   METRIC_RECORD("StartEdge");
+  if (trace_)
+    trace_->EdgeStarted(edge);
   if (edge->is_phony())
     return true;
 
@@ -511,28 +1066,142 @@ bool Builder::StartEdge(Edge* edge, string* err) {
   status_->BuildEdgeStarted(edge, start_time_millis);
 
   // Create directories necessary for outputs.
-  // XXX: this will block; do we care?
-  for (vector<Node*>::iterator o = edge->outputs_.begin();
-       o != edge->outputs_.end(); ++o) {
-    if (!disk_interface_->MakeDirs((*o)->path()))
-      return false;
-  }
+  if (!MakeOutputDirs(edge))
+    return false;
 
-  // Create response file, if needed
-  // XXX: this may also block; do we care?
+  // Create response file, if needed.  Large ones are written in the
+  // background, and the command is started once that is done.
   string rspfile = edge->GetUnescapedRspfile();
   if (!rspfile.empty()) {
+    const size_t kBackgroundRspfileSize = 64 << 10;
     string content = edge->GetBinding("rspfile_content");
+    if (content.size() >= kBackgroundRspfileSize && !config_.dry_run) {
+      if (!rspfile_writer_.get()) {
+        rspfile_writer_.reset(new RspfileWriter(disk_interface_,
+                                                command_runner_.get()));
+      }
+      rspfile_writer_->Write(edge, rspfile, &content);
+      return true;
+    }
     if (!disk_interface_->WriteFile(rspfile, content))
       return false;
   }
 
+  return StartCommand(edge, err);
+}
+
+bool Builder::StartCommand(Edge* edge, string* err) {
   // start command computing and run it
   if (!command_runner_->StartCommand(edge)) {
     err->assign("command '" + edge->EvaluateCommand() + "' failed.");
     return false;
   }
+  return true;
+}
 
+namespace {
+
+/// Make the directories in |dirs| until none are left, taking the index of
+/// the next one from |next|.  Several threads can run this at once.
+void MakeDirsFrom(DiskInterface* disk_interface, const vector<string>* dirs,
+                  std::atomic<size_t>* next, std::atomic<bool>* failed) {
+  for (size_t i; (i = (*next)++) < dirs->size(); ) {
+    if (!disk_interface->MakeDir((*dirs)[i]))
+      *failed = true;
+  }
+}
+
+}  // namespace
+
+bool Builder::MakeOutputDirs(Edge* edge) {
+  for (vector<Node*>::iterator o = edge->outputs_.begin();
+       o != edge->outputs_.end(); ++o) {
+    string dir = DirName((*o)->path());
+    if (dir.empty() || made_dirs_.count(dir))
+      continue;
+    if (!disk_interface_->MakeDirs((*o)->path()))
+      return false;
+    made_dirs_.insert(dir);
+  }
+  return true;
+}
+
+bool Builder::MakeAllOutputDirs(string* err) {
+  METRIC_RECORD("make output dirs");
+
+  // Find the missing output directories and their missing parents.  Only
+  // stat on this thread: the Windows stat cache isn't thread-safe.
+  set<string> missing;
+  vector<Edge*> edges;
+  plan_.GetWantedEdges(&edges);
+  for (vector<Edge*>::iterator e = edges.begin(); e != edges.end(); ++e) {
+    for (vector<Node*>::iterator o = (*e)->outputs_.begin();
+         o != (*e)->outputs_.end(); ++o) {
+      for (string dir = DirName((*o)->path());
+           !dir.empty() && !made_dirs_.count(dir) && !missing.count(dir);
+           dir = DirName(dir)) {
+        TimeStamp mtime = disk_interface_->Stat(dir, err);
+        if (mtime < 0)
+          return false;
+        if (mtime > 0) {
+          made_dirs_.insert(dir);
+          break;
+        }
+        missing.insert(dir);
+      }
+    }
+  }
+
+  // Make them a level at a time, so that parents exist before children.
+  vector<vector<string> > levels;
+  for (set<string>::iterator i = missing.begin(); i != missing.end(); ++i) {
+    size_t depth = 0;
+    for (string dir = DirName(*i); missing.count(dir); dir = DirName(dir))
+      ++depth;
+    if (depth >= levels.size())
+      levels.resize(depth + 1);
+    levels[depth].push_back(*i);
+  }
+
+  // Creating a few directories isn't worth starting threads for.
+  const size_t kDirsPerThread = 16;
+  for (size_t l = 0; l < levels.size(); ++l) {
+    const vector<string>& level = levels[l];
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    size_t thread_count = min(level.size() / kDirsPerThread,
+                              (size_t)max(config_.parallelism, 1));
+    vector<std::thread> threads;
+    for (size_t t = 1; t < thread_count; ++t) {
+      threads.push_back(std::thread(MakeDirsFrom, disk_interface_, &level,
+                                    &next, &failed));
+    }
+    MakeDirsFrom(disk_interface_, &level, &next, &failed);
+    for (size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+    if (failed) {
+      *err = "failed to create output directories";
+      return false;
+    }
+    made_dirs_.insert(level.begin(), level.end());
+  }
+
+  return true;
+}
+
+bool Builder::LoadDyndeps(Node* node, string* err) {
+  DyndepFile ddf;
+  if (config_.dry_run) {
+    // Nothing was written to load; the edges run as declared.
+    node->set_dyndep_pending(false);
+  } else if (!scan_.LoadDyndeps(node, &ddf, err)) {
+    return false;
+  }
+  if (!plan_.DyndepsLoaded(&scan_, node, ddf, err))
+    return false;
+
+  // The total number of edges in the plan may have changed.
+  status_->PlanHasTotalEdges(plan_.command_edge_count());
   return true;
 }
 
@@ -568,6 +1237,10 @@ bool Builder::FinishCommand(CommandRunner::Result* result, string* err) {
   running_edges_.erase(i);
 
   status_->BuildEdgeFinished(edge, end_time_millis, result);
+  if (trace_) {
+    trace_->EdgeFinished(edge, result->success(), result->cpu_micros,
+                         result->peak_memory_bytes);
+  }
 
   // The rest of this function only applies to successful commands.
   if (!result->success()) {
@@ -629,6 +1302,10 @@ bool Builder::FinishCommand(CommandRunner::Result* result, string* err) {
   }
 
   plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  while (Node* dyndep = plan_.NextBuiltDyndep()) {
+    if (!LoadDyndeps(dyndep, err))
+      return false;
+  }
 
   // Delete any left over response file.
   string rspfile = edge->GetUnescapedRspfile();
@@ -19,6 +19,7 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -69,13 +70,51 @@ struct Plan {
   /// Number of edges with commands to run.
   int command_edge_count() const { return command_edges_; }
 
+  /// Append the edges the plan will run to \a edges.
+  void GetWantedEdges(vector<Edge*>* edges) const;
+
+  /// Estimate the critical time of every edge in the plan from the
+  /// durations in \a build_log, which may be NULL, so that pools release
+  /// the edges with the most work depending on them first.  Does nothing
+  /// if no edge in the plan is in a pool that delays edges.
+  void ComputeCriticalTimes(BuildLog* build_log);
+
+  /// Return a dyndep file that EdgeFinished() found built, or NULL.  The
+  /// edges that depend on it wait until DyndepsLoaded() is called for it.
+  Node* NextBuiltDyndep();
+
+  /// Update the plan with what the dyndep file \a node said, in \a ddf:
+  /// recompute which edges depending on it are dirty, add the inputs it
+  /// found to the plan, and schedule the edges that are now ready.  With
+  /// a NULL \a scan, the dirty state is left as it was.
+  /// Returns false on error.
+  bool DyndepsLoaded(DependencyScan* scan, Node* node, const DyndepFile& ddf,
+                     string* err);
+
   /// Reset state.  Clears want and ready sets.
   void Reset();
 
 private:
-  bool AddSubTarget(Node* node, Node* dependent, string* err);
+  /// If \a dyndep_walk is not NULL, the edges visited are added to it
+  /// instead of being scheduled.
+  bool AddSubTarget(Node* node, Node* dependent, string* err,
+                    set<Edge*>* dyndep_walk);
   void NodeFinished(Node* node);
 
+  /// Set the pending_inputs_ of \a edge from the edges in the plan.
+  void CountPendingInputs(Edge* edge);
+
+  /// Recompute the dirty state of everything in the plan that depends on
+  /// \a node, wanting the edges that turn out dirty.
+  bool RefreshDyndepDependents(DependencyScan* scan, Node* node, string* err);
+  /// Collect what in the plan depends on \a node in \a dependents, and
+  /// mark their edges unvisited so that RecomputeDirty() looks again.
+  void UnmarkDependents(Node* node, set<Node*>* dependents);
+
+  /// Schedule the edge of \a want_e if its inputs are ready, or finish it
+  /// if it isn't wanted itself.
+  void EdgeMaybeReady(map<Edge*, bool>::iterator want_e);
+
   /// Submits a ready edge as a candidate for execution.
   /// The edge may be delayed from running, for example if it's a member of a
   /// currently-full pool.
@@ -90,6 +129,9 @@ private:
 
   EdgeSet ready_;
 
+  /// Dyndep files that have been built and are yet to be loaded.
+  queue<Node*> built_dyndeps_;
+
   /// Total number of edges that have commands (not phony).
   int command_edges_;
 
@@ -107,24 +149,46 @@ struct CommandRunner {
 
   /// The result of waiting for a command.
   struct Result {
-    Result() : edge(NULL) {}
+    Result()
+        : edge(NULL), status(ExitSuccess), partial(false), cpu_micros(-1),
+          peak_memory_bytes(-1) {}
     Edge* edge;
     ExitStatus status;
     string output;
+    /// Whether this is only the output so far of a command that is still
+    /// running.  Later results for the edge don't repeat that output.
+    bool partial;
+    /// The CPU time and memory the command used, or -1 if unknown.
+    int64_t cpu_micros;
+    int64_t peak_memory_bytes;
     bool success() const { return status == ExitSuccess; }
   };
   /// Wait for a command to complete, or return false if interrupted.
+  /// Returns true with result->edge set to NULL if Wake() was called.
+  /// If BuildConfig::partial_output_millis is set, may also return
+  /// partial results for commands that are still running.
   virtual bool WaitForCommand(Result* result) = 0;
 
   virtual vector<Edge*> GetActiveEdges() { return vector<Edge*>(); }
   virtual void Abort() {}
+
+  /// Make WaitForCommand() return early.  Can be called from any thread.
+  virtual void Wake() {}
+  /// Make the next WaitForCommand() return, with a NULL edge, once
+  /// GetTimeMillis() reaches \a time_millis, if no command is done by then.
+  virtual void WakeAt(int64_t time_millis) {}
 };
 
+struct BuildTrace;
+struct RspfileWriter;
+
 /// Options (e.g. verbosity, parallelism) passed to a build.
 struct BuildConfig {
   BuildConfig() : verbosity(NORMAL), dry_run(false), parallelism(1),
                   failures_allowed(1), max_load_average(-0.0f),
-                  frontend(NULL) {}
+                  frontend(NULL), partial_output_millis(0),
+                  make_dirs_upfront(false), adaptive_parallelism(false),
+                  collapse_phony(false) {}
 
   enum Verbosity {
     NORMAL,
@@ -141,6 +205,25 @@ struct BuildConfig {
 
   /// Command to execute to handle build output
   const char* frontend;
+  /// If positive, pass on the output of running commands at most this
+  /// often, instead of only once they finish.
+  int partial_output_millis;
+
+  /// Whether to create the output directories of all edges in the plan,
+  /// several at a time, before starting any of them.
+  bool make_dirs_upfront;
+
+  /// Whether to vary the number of jobs, up to \a parallelism, with the
+  /// load of the machine.
+  bool adaptive_parallelism;
+
+  /// Whether to have edges read through phony aliases before the build
+  /// looks at them; see State::CollapsePhonyAliases().
+  bool collapse_phony;
+
+  /// If not empty, a cgroup v2 directory to run each command in a leaf of.
+  /// The cgroup_cpu_max and cgroup_memory_max bindings limit the command.
+  string cgroup_parent;
 };
 
 /// Builder wraps the build process: starting commands, updating status.
@@ -169,6 +252,10 @@ struct Builder {
 
   bool StartEdge(Edge* edge, string* err);
 
+  /// Load the dyndep file \a node, which has just been built, and update
+  /// the plan with it.
+  bool LoadDyndeps(Node* node, string* err);
+
   /// Update status ninja logs following a command termination.
   /// @return false if the build can not proceed further due to a fatal error.
   bool FinishCommand(CommandRunner::Result* result, string* err);
@@ -178,6 +265,9 @@ struct Builder {
     scan_.set_build_log(log);
   }
 
+  /// Record the commands that run in \a trace, if not NULL.
+  void set_trace(BuildTrace* trace) { trace_ = trace; }
+
   State* state_;
   const BuildConfig& config_;
   Plan plan_;
@@ -189,6 +279,18 @@ struct Builder {
                     const string& deps_prefix, vector<Node*>* deps_nodes,
                     string* err);
 
+  /// Start \a edge's command, once its response file is written.
+  bool StartCommand(Edge* edge, string* err);
+
+  /// Create the directories \a edge's outputs go in, unless made already.
+  bool MakeOutputDirs(Edge* edge);
+  /// Create the output directories of every edge in the plan.
+  bool MakeAllOutputDirs(string* err);
+
+  /// Output directories known to exist, so that StartEdge() doesn't have
+  /// to stat them for every edge.
+  set<string> made_dirs_;
+
   /// Map of running edge to time the edge started running.
   typedef map<Edge*, int> RunningEdgeMap;
   RunningEdgeMap running_edges_;
@@ -198,6 +300,11 @@ struct Builder {
 
   DiskInterface* disk_interface_;
   DependencyScan scan_;
+  BuildTrace* trace_;
+
+  /// Writes large response files in the background, so that other edges
+  /// can start meanwhile.  Created when first needed.
+  auto_ptr<RspfileWriter> rspfile_writer_;
 
   // Unimplemented copy ctor and operator= ensure we don't copy the auto_ptr.
   Builder(const Builder &other);        // DO NOT IMPLEMENT
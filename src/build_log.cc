@@ -31,6 +31,9 @@
 #include <unistd.h>
 #endif
 
+#include <set>
+#include <thread>
+
 #include "build.h"
 #include "graph.h"
 #include "metrics.h"
@@ -91,9 +94,83 @@ uint64_t MurmurHash64A(const void* key, size_t len) {
 }
 #undef BIG_CONSTANT
 
+void AppendLogEntry(const BuildLog::LogEntry& entry, string* out) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%d\t%d\t%d\t",
+           entry.start_time, entry.end_time, entry.mtime);
+  out->append(buf);
+  out->append(entry.output);
+  snprintf(buf, sizeof(buf), "\t%" PRIx64 "\n", entry.command_hash);
+  out->append(buf);
+}
+
+bool WriteLogEntry(FILE* f, const BuildLog::LogEntry& entry) {
+  string line;
+  AppendLogEntry(entry, &line);
+  return fwrite(line.data(), line.size(), 1, f) == 1;
+}
 
 }  // namespace
 
+/// State shared with the thread of a background recompaction.  Until the
+/// thread is joined, it only touches |file|, |dead_outputs|, |success| and
+/// |err|, and only reads |entries| and |in_manifest|; the main thread only
+/// touches |delta|.
+struct BuildLog::BackgroundRecompaction {
+  explicit BackgroundRecompaction(const string& path)
+      : path(path), temp_path(path + ".recompact"), file(NULL),
+        success(false) {}
+
+  /// Write the live entries to |temp_path|.  Runs on |thread|.
+  void Run(const BuildLogUser* user);
+
+  string path;
+  string temp_path;
+
+  /// Copies of the log entries when the recompaction started, and for each
+  /// whether the manifest still produces it.
+  vector<LogEntry> entries;
+  vector<bool> in_manifest;
+
+  /// Entries recorded since the recompaction started.
+  vector<LogEntry> delta;
+
+  FILE* file;
+  vector<string> dead_outputs;
+  bool success;
+  string err;
+
+  std::thread thread;
+};
+
+void BuildLog::BackgroundRecompaction::Run(const BuildLogUser* user) {
+  // Truncate any left-over file from a previous recompaction that crashed.
+  file = fopen(temp_path.c_str(), "wb");
+  if (!file) {
+    err = strerror(errno);
+    return;
+  }
+
+  if (fprintf(file, kFileSignature, kCurrentVersion) < 0) {
+    err = strerror(errno);
+    return;
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (!in_manifest[i] && user->IsPathDeadOnDisk(entries[i].output)) {
+      dead_outputs.push_back(entries[i].output);
+      continue;
+    }
+
+    if (!WriteLogEntry(file, entries[i])) {
+      err = strerror(errno);
+      return;
+    }
+  }
+
+  success = true;
+}
+
 // static
 uint64_t BuildLog::LogEntry::HashCommand(StringPiece command) {
   return MurmurHash64A(command.str_, command.len_);
@@ -109,7 +186,8 @@ BuildLog::LogEntry::LogEntry(const string& output, uint64_t command_hash,
 {}
 
 BuildLog::BuildLog()
-  : log_file_(NULL), needs_recompaction_(false) {}
+  : needs_recompaction_(false),
+    background_recompaction_(false), recompaction_(NULL) {}
 
 BuildLog::~BuildLog() {
   Close();
@@ -118,29 +196,35 @@ BuildLog::~BuildLog() {
 bool BuildLog::OpenForWrite(const string& path, const BuildLogUser& user,
                             string* err) {
   if (needs_recompaction_) {
-    if (!Recompact(path, user, err))
+    if (background_recompaction_) {
+      StartBackgroundRecompaction(path, user);
+      needs_recompaction_ = false;
+    } else if (!Recompact(path, user, err)) {
       return false;
+    }
   }
 
-  log_file_ = fopen(path.c_str(), "ab");
-  if (!log_file_) {
+  FILE* log_file = fopen(path.c_str(), "ab");
+  if (!log_file) {
     *err = strerror(errno);
     return false;
   }
-  setvbuf(log_file_, NULL, _IOLBF, BUFSIZ);
-  SetCloseOnExec(fileno(log_file_));
+  SetCloseOnExec(fileno(log_file));
 
   // Opening a file in append mode doesn't set the file pointer to the file's
   // end on Windows. Do that explicitly.
-  fseek(log_file_, 0, SEEK_END);
+  fseek(log_file, 0, SEEK_END);
 
-  if (ftell(log_file_) == 0) {
-    if (fprintf(log_file_, kFileSignature, kCurrentVersion) < 0) {
+  if (ftell(log_file) == 0) {
+    if (fprintf(log_file, kFileSignature, kCurrentVersion) < 0 ||
+        fflush(log_file) != 0) {
       *err = strerror(errno);
+      fclose(log_file);
       return false;
     }
   }
 
+  log_writer_.Open(log_file);
   return true;
 }
 
@@ -148,6 +232,7 @@ bool BuildLog::RecordCommand(Edge* edge, int start_time, int end_time,
                              TimeStamp mtime) {
   string command = edge->EvaluateCommand(true);
   uint64_t command_hash = LogEntry::HashCommand(command);
+  string lines;
   for (vector<Node*>::iterator out = edge->outputs_.begin();
        out != edge->outputs_.end(); ++out) {
     const string& path = (*out)->path();
@@ -164,18 +249,84 @@ bool BuildLog::RecordCommand(Edge* edge, int start_time, int end_time,
     log_entry->end_time = end_time;
     log_entry->mtime = mtime;
 
-    if (log_file_) {
-      if (!WriteEntry(log_file_, *log_entry))
-        return false;
-    }
+    if (recompaction_)
+      recompaction_->delta.push_back(*log_entry);
+
+    if (log_writer_.is_open())
+      AppendLogEntry(*log_entry, &lines);
   }
+
+  if (log_writer_.is_open())
+    return log_writer_.Append(lines);
   return true;
 }
 
 void BuildLog::Close() {
-  if (log_file_)
-    fclose(log_file_);
-  log_file_ = NULL;
+  log_writer_.Close();
+
+  if (recompaction_) {
+    string err;
+    if (!FinishBackgroundRecompaction(&err))
+      Warning("recompacting build log: %s", err.c_str());
+  }
+}
+
+void BuildLog::StartBackgroundRecompaction(const string& path,
+                                           const BuildLogUser& user) {
+  METRIC_RECORD(".ninja_log recompact start");
+  recompaction_ = new BackgroundRecompaction(path);
+  recompaction_->entries.reserve(entries_.size());
+  recompaction_->in_manifest.reserve(entries_.size());
+  for (Entries::iterator i = entries_.begin(); i != entries_.end(); ++i) {
+    recompaction_->entries.push_back(*i->second);
+    recompaction_->in_manifest.push_back(user.IsPathInManifest(i->first));
+  }
+  recompaction_->thread = std::thread(&BackgroundRecompaction::Run,
+                                      recompaction_, &user);
+}
+
+bool BuildLog::FinishBackgroundRecompaction(string* err) {
+  METRIC_RECORD(".ninja_log recompact finish");
+  BackgroundRecompaction* recompaction = recompaction_;
+  recompaction_ = NULL;
+  recompaction->thread.join();
+
+  bool success = recompaction->success;
+  for (vector<LogEntry>::iterator i = recompaction->delta.begin();
+       success && i != recompaction->delta.end(); ++i) {
+    if (!WriteLogEntry(recompaction->file, *i)) {
+      recompaction->err = strerror(errno);
+      success = false;
+    }
+  }
+  if (recompaction->file && fclose(recompaction->file) != 0 && success) {
+    recompaction->err = strerror(errno);
+    success = false;
+  }
+  if (success && !RenameOverwriting(recompaction->temp_path,
+                                    recompaction->path, &recompaction->err)) {
+    success = false;
+  }
+
+  if (success) {
+    // Forget the dead outputs, unless they were built again meanwhile.
+    set<string> rebuilt;
+    for (vector<LogEntry>::iterator i = recompaction->delta.begin();
+         i != recompaction->delta.end(); ++i)
+      rebuilt.insert(i->output);
+    for (vector<string>::iterator i = recompaction->dead_outputs.begin();
+         i != recompaction->dead_outputs.end(); ++i) {
+      if (!rebuilt.count(*i))
+        entries_.erase(*i);
+    }
+  } else {
+    // The old log has all the records; just drop the partial new one.
+    unlink(recompaction->temp_path.c_str());
+    *err = recompaction->err;
+  }
+
+  delete recompaction;
+  return success;
 }
 
 struct LineReader {
@@ -312,6 +463,11 @@ bool BuildLog::Load(const string& path, string* err) {
     }
     ++total_entry_count;
 
+    if (!last_build_entries_.empty() &&
+        end_time < last_build_entries_.back()->end_time)
+      last_build_entries_.clear();
+    last_build_entries_.push_back(entry);
+
     entry->start_time = start_time;
     entry->end_time = end_time;
     entry->mtime = restat_mtime;
@@ -353,9 +509,7 @@ BuildLog::LogEntry* BuildLog::LookupByOutput(const string& path) {
 }
 
 bool BuildLog::WriteEntry(FILE* f, const LogEntry& entry) {
-  return fprintf(f, "%d\t%d\t%d\t%s\t%" PRIx64 "\n",
-          entry.start_time, entry.end_time, entry.mtime,
-          entry.output.c_str(), entry.command_hash) > 0;
+  return WriteLogEntry(f, entry);
 }
 
 bool BuildLog::Recompact(const string& path, const BuildLogUser& user,
@@ -394,15 +548,5 @@ bool BuildLog::Recompact(const string& path, const BuildLogUser& user,
     entries_.erase(dead_outputs[i]);
 
   fclose(f);
-  if (unlink(path.c_str()) < 0) {
-    *err = strerror(errno);
-    return false;
-  }
-
-  if (rename(temp_path.c_str(), path.c_str()) < 0) {
-    *err = strerror(errno);
-    return false;
-  }
-
-  return true;
+  return RenameOverwriting(temp_path, path, err);
 }
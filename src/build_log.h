@@ -16,10 +16,12 @@
 #define NINJA_BUILD_LOG_H_
 
 #include <string>
+#include <vector>
 #include <stdio.h>
 using namespace std;
 
 #include "hash_map.h"
+#include "log_writer.h"
 #include "timestamp.h"
 #include "util.h"  // uint64_t
 
@@ -30,6 +32,13 @@ struct BuildLogUser {
   /// Return if a given output is no longer part of the build manifest.
   /// This is only called during recompaction and doesn't have to be fast.
   virtual bool IsPathDead(StringPiece s) const = 0;
+
+  /// A background recompaction asks IsPathDead() in two halves: first
+  /// IsPathInManifest() on the main thread, which owns the graph, then for
+  /// paths that aren't, IsPathDeadOnDisk() on the recompaction thread, which
+  /// must not look at the graph.  By default every path is kept.
+  virtual bool IsPathInManifest(StringPiece s) const { return true; }
+  virtual bool IsPathDeadOnDisk(StringPiece s) const { return false; }
 };
 
 /// Store a log of every command ran for every build.
@@ -44,10 +53,24 @@ struct BuildLog {
   ~BuildLog();
 
   bool OpenForWrite(const string& path, const BuildLogUser& user, string* err);
+  /// Record \a edge's outputs.  They are written to the log on a background
+  /// thread; a false return means an earlier write failed.
   bool RecordCommand(Edge* edge, int start_time, int end_time,
                      TimeStamp mtime = 0);
+  /// Wait until all recorded commands have been written to the log.
+  bool Flush() { return log_writer_.Flush(); }
+  /// Close the log.  If a background recompaction is running, wait for it
+  /// and swap the recompacted log in.
   void Close();
 
+  /// If set, OpenForWrite() recompacts the log on a background thread
+  /// instead of blocking until it is done.  Records keep being appended to
+  /// the old log meanwhile, so it stays valid until the recompacted log,
+  /// with those records added, atomically replaces it in Close().
+  void set_background_recompaction(bool background) {
+    background_recompaction_ = background;
+  }
+
   /// Load the on-disk log.
   bool Load(const string& path, string* err);
 
@@ -81,13 +104,35 @@ struct BuildLog {
   /// Rewrite the known log entries, throwing away old data.
   bool Recompact(const string& path, const BuildLogUser& user, string* err);
 
+  /// Used for tests.
+  bool recompacting_in_background() const { return recompaction_ != NULL; }
+
   typedef ExternalStringHashMap<LogEntry*>::Type Entries;
   const Entries& entries() const { return entries_; }
 
+  /// The entries of the last build in the loaded log, in the order they
+  /// were written.  A build is recognized by its end times, which only go
+  /// back when a new build starts.
+  const vector<LogEntry*>& last_build_entries() const {
+    return last_build_entries_;
+  }
+
  private:
+  struct BackgroundRecompaction;
+
+  /// Start recompacting the log at \a path on a background thread.
+  void StartBackgroundRecompaction(const string& path,
+                                   const BuildLogUser& user);
+  /// Wait for the background recompaction, then append the records written
+  /// since it started and replace the log with it.
+  bool FinishBackgroundRecompaction(string* err);
+
   Entries entries_;
-  FILE* log_file_;
+  vector<LogEntry*> last_build_entries_;
+  LogWriter log_writer_;
   bool needs_recompaction_;
+  bool background_recompaction_;
+  BackgroundRecompaction* recompaction_;
 };
 
 #endif // NINJA_BUILD_LOG_H_
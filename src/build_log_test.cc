@@ -266,6 +266,8 @@ TEST_F(BuildLogTest, MultiTargetEdge) {
 
 struct BuildLogRecompactTest : public BuildLogTest {
   virtual bool IsPathDead(StringPiece s) const { return s == "out2"; }
+  virtual bool IsPathInManifest(StringPiece s) const { return s != "out2"; }
+  virtual bool IsPathDeadOnDisk(StringPiece s) const { return true; }
 };
 
 TEST_F(BuildLogRecompactTest, Recompact) {
@@ -304,4 +306,52 @@ TEST_F(BuildLogRecompactTest, Recompact) {
   ASSERT_FALSE(log2.LookupByOutput("out2"));
 }
 
+TEST_F(BuildLogRecompactTest, BackgroundRecompact) {
+  AssertParse(&state_,
+"build out: cat in\n"
+"build out2: cat in\n"
+"build out3: cat in\n");
+
+  BuildLog log1;
+  string err;
+  EXPECT_TRUE(log1.OpenForWrite(kTestFilename, *this, &err));
+  ASSERT_EQ("", err);
+  for (int i = 0; i < 200; ++i)
+    log1.RecordCommand(state_.edges_[0], 15, 18 + i);
+  log1.RecordCommand(state_.edges_[1], 21, 22);
+  log1.Close();
+
+  BuildLog log2;
+  EXPECT_TRUE(log2.Load(kTestFilename, &err));
+  ASSERT_EQ("", err);
+  log2.set_background_recompaction(true);
+  EXPECT_TRUE(log2.OpenForWrite(kTestFilename, *this, &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(log2.recompacting_in_background());
+
+  // Records made while recompacting go to the old log...
+  log2.RecordCommand(state_.edges_[0], 30, 31);
+  log2.RecordCommand(state_.edges_[2], 32, 33);
+  ASSERT_TRUE(log2.Flush());
+  BuildLog log3;
+  EXPECT_TRUE(log3.Load(kTestFilename, &err));
+  ASSERT_EQ("", err);
+  ASSERT_EQ(3u, log3.entries().size());
+  ASSERT_EQ(31, log3.LookupByOutput("out")->end_time);
+
+  // ...and are added to the recompacted one, which drops the dead "out2".
+  log2.Close();
+  EXPECT_FALSE(log2.recompacting_in_background());
+  ASSERT_EQ(2u, log2.entries().size());
+  ASSERT_FALSE(log2.LookupByOutput("out2"));
+
+  BuildLog log4;
+  EXPECT_TRUE(log4.Load(kTestFilename, &err));
+  ASSERT_EQ("", err);
+  ASSERT_EQ(2u, log4.entries().size());
+  ASSERT_EQ(31, log4.LookupByOutput("out")->end_time);
+  ASSERT_TRUE(log4.LookupByOutput("out3"));
+  ASSERT_FALSE(log4.LookupByOutput("out2"));
+}
+
 }  // anonymous namespace
@@ -186,6 +186,41 @@ TEST_F(PlanTest, DoubleDependent) {
   ASSERT_FALSE(edge);  // done
 }
 
+// An edge counts the inputs it waits for as often as it lists them, and
+// the plan checks each off when its edge finishes.
+TEST_F(PlanTest, PendingInputs) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat a b a || c\n"
+"build a b: cat in\n"
+"build c: cat in\n"));
+  GetNode("a")->MarkDirty();
+  GetNode("b")->MarkDirty();
+  GetNode("c")->MarkDirty();
+  GetNode("out")->MarkDirty();
+
+  string err;
+  EXPECT_TRUE(plan_.AddTarget(GetNode("out"), &err));
+  ASSERT_EQ("", err);
+  EXPECT_EQ(4, GetNode("out")->in_edge()->pending_inputs_);
+
+  deque<Edge*> edges;
+  FindWorkSorted(&edges, 2);
+  ASSERT_EQ("a", edges[0]->outputs_[0]->path());
+  ASSERT_EQ("c", edges[1]->outputs_[0]->path());
+
+  plan_.EdgeFinished(edges[0], Plan::kEdgeSucceeded);
+  EXPECT_EQ(1, GetNode("out")->in_edge()->pending_inputs_);
+  ASSERT_FALSE(plan_.FindWork());
+
+  plan_.EdgeFinished(edges[1], Plan::kEdgeSucceeded);
+  EXPECT_EQ(0, GetNode("out")->in_edge()->pending_inputs_);
+  Edge* edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  ASSERT_EQ("out", edge->outputs_[0]->path());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  ASSERT_FALSE(plan_.more_to_do());
+}
+
 void PlanTest::TestPoolWithDepthOne(const char* test_case) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_, test_case));
   GetNode("out1")->MarkDirty();
@@ -319,6 +354,161 @@ TEST_F(PlanTest, PoolsWithDepthTwo) {
   ASSERT_FALSE(plan_.FindWork());
 }
 
+TEST_F(PlanTest, PoolWithResources) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"pool link\n"
+"  resources = mem=10 cpu=4\n"
+"rule link\n"
+"  command = cat $in > $out\n"
+"  pool = link\n"
+"build big1: link in\n"
+"  resources = mem=8 cpu=1\n"
+"build big2: link in\n"
+"  resources = mem=8 cpu=1\n"
+"build wide: link in\n"
+"  resources = mem=1 cpu=3\n"
+"build narrow: link in\n"
+"  resources = mem=1 cpu=1\n"
+"build all: phony big1 big2 wide narrow\n"));
+  GetNode("big1")->MarkDirty();
+  GetNode("big2")->MarkDirty();
+  GetNode("wide")->MarkDirty();
+  GetNode("narrow")->MarkDirty();
+  GetNode("all")->MarkDirty();
+
+  string err;
+  EXPECT_TRUE(plan_.AddTarget(GetNode("all"), &err));
+  ASSERT_EQ("", err);
+
+  // big2 doesn't fit next to big1, but wide does, and then all the CPUs
+  // are taken.
+  deque<Edge*> edges;
+  FindWorkSorted(&edges, 2);
+  EXPECT_EQ("big1", edges[0]->outputs_[0]->path());
+  EXPECT_EQ("wide", edges[1]->outputs_[0]->path());
+  ASSERT_FALSE(plan_.FindWork());
+  Pool* pool = state_.LookupPool("link");
+  EXPECT_EQ(9, pool->resource_use(0));
+  EXPECT_EQ(4, pool->resource_use(1));
+
+  // Once wide is done, narrow fits but big2 still doesn't.
+  plan_.EdgeFinished(edges[1], Plan::kEdgeSucceeded);
+  Edge* edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("narrow", edge->outputs_[0]->path());
+  ASSERT_FALSE(plan_.FindWork());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+
+  plan_.EdgeFinished(edges[0], Plan::kEdgeSucceeded);
+  edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("big2", edge->outputs_[0]->path());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+
+  edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("all", edge->outputs_[0]->path());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  EXPECT_FALSE(plan_.more_to_do());
+  EXPECT_EQ(0, pool->resource_use(0));
+}
+
+TEST_F(PlanTest, PoolWithPriorities) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"pool foobar\n"
+"  depth = 1\n"
+"rule poolcat\n"
+"  command = cat $in > $out\n"
+"  pool = foobar\n"
+"build out1: poolcat in\n"
+"build out2: poolcat in\n"
+"  priority = 1\n"
+"build out3: poolcat in\n"
+"  priority = 5\n"
+"build out4: poolcat in\n"
+"build all: phony out1 out2 out3 out4\n"));
+  for (int i = 0; i < 4; ++i)
+    GetNode("out" + string(1, '1' + static_cast<char>(i)))->MarkDirty();
+  GetNode("all")->MarkDirty();
+
+  string err;
+  EXPECT_TRUE(plan_.AddTarget(GetNode("all"), &err));
+  ASSERT_EQ("", err);
+  plan_.ComputeCriticalTimes(NULL);
+
+  // out1 found the pool empty; the rest wait and leave by priority.
+  const char* kOrder[] = { "out1", "out3", "out2", "out4" };
+  for (int i = 0; i < 4; ++i) {
+    Edge* edge = plan_.FindWork();
+    ASSERT_TRUE(edge);
+    EXPECT_EQ(kOrder[i], edge->outputs_[0]->path());
+    ASSERT_FALSE(plan_.FindWork());
+    plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  }
+  Edge* edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("all", edge->outputs_[0]->path());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  EXPECT_FALSE(plan_.more_to_do());
+}
+
+TEST_F(PlanTest, PoolWithCriticalPath) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"pool foobar\n"
+"  depth = 1\n"
+"rule poolcat\n"
+"  command = cat $in > $out\n"
+"  pool = foobar\n"
+"build out1: poolcat in\n"
+"build out2: poolcat in\n"
+"build out3: poolcat in\n"
+"build slow: cat out3\n"
+"build all: phony out1 out2 slow\n"));
+  GetNode("out1")->MarkDirty();
+  GetNode("out2")->MarkDirty();
+  GetNode("out3")->MarkDirty();
+  GetNode("slow")->MarkDirty();
+  GetNode("all")->MarkDirty();
+
+  BuildLog log;
+  log.RecordCommand(GetNode("out1")->in_edge(), 0, 10);
+  log.RecordCommand(GetNode("out2")->in_edge(), 0, 10);
+  log.RecordCommand(GetNode("out3")->in_edge(), 0, 10);
+  log.RecordCommand(GetNode("slow")->in_edge(), 0, 1000);
+
+  string err;
+  EXPECT_TRUE(plan_.AddTarget(GetNode("all"), &err));
+  ASSERT_EQ("", err);
+  plan_.ComputeCriticalTimes(&log);
+  EXPECT_EQ(1010, GetNode("out3")->in_edge()->critical_time_);
+  EXPECT_EQ(10, GetNode("out2")->in_edge()->critical_time_);
+
+  // out3 has a slow command waiting for it, so it goes before out2.
+  Edge* edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("out1", edge->outputs_[0]->path());
+  plan_.EdgeFinished(edge, Plan::kEdgeSucceeded);
+  edge = plan_.FindWork();
+  ASSERT_TRUE(edge);
+  EXPECT_EQ("out3", edge->outputs_[0]->path());
+}
+
+// Without a pool that delays edges, nothing uses the critical times.
+TEST_F(PlanTest, CriticalPathWithoutPools) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat in\n"));
+  GetNode("out")->MarkDirty();
+
+  BuildLog log;
+  log.RecordCommand(GetNode("out")->in_edge(), 0, 10);
+
+  string err;
+  EXPECT_TRUE(plan_.AddTarget(GetNode("out"), &err));
+  ASSERT_EQ("", err);
+  plan_.ComputeCriticalTimes(&log);
+  EXPECT_EQ(0, GetNode("out")->in_edge()->critical_time_);
+}
+
 TEST_F(PlanTest, PoolWithRedundantEdges) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
     "pool compile\n"
@@ -563,6 +753,12 @@ bool FakeCommandRunner::StartCommand(Edge* edge) {
          out != edge->outputs_.end(); ++out) {
       fs_->Create((*out)->path(), "");
     }
+  } else if (edge->rule().name() == "cp") {
+    string content;
+    string err;
+    if (fs_->ReadFile(edge->inputs_[0]->path(), &content, &err) ==
+        DiskInterface::Okay)
+      fs_->WriteFile(edge->outputs_[0]->path(), content);
   } else if (edge->rule().name() == "true" ||
              edge->rule().name() == "fail" ||
              edge->rule().name() == "interrupt" ||
@@ -818,6 +1014,42 @@ TEST_F(BuildTest, MakeDirs) {
   EXPECT_EQ("subdir/dir2", fs_.directories_made_[1]);
 }
 
+TEST_F(BuildTest, MakeDirsOncePerDirectory) {
+  string err;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build subdir/file1: cat in1\n"
+"build subdir/file2: cat in1\n"
+"build all: phony subdir/file1 subdir/file2\n"));
+  EXPECT_TRUE(builder_.AddTarget("all", &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(builder_.Build(&err));
+  ASSERT_EQ("", err);
+
+  // The virtual file system never reports directories as existing, so
+  // only the cache stops the second edge from making "subdir" again.
+  ASSERT_EQ(1u, fs_.directories_made_.size());
+  EXPECT_EQ("subdir", fs_.directories_made_[0]);
+}
+
+TEST_F(BuildTest, MakeDirsUpfront) {
+  string err;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build subdir/dir2/file: cat in1\n"
+"build subdir/dir1/file: cat in1\n"
+"build all: phony subdir/dir1/file subdir/dir2/file\n"));
+  config_.make_dirs_upfront = true;
+  EXPECT_TRUE(builder_.AddTarget("all", &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(builder_.Build(&err));
+  ASSERT_EQ("", err);
+
+  // Parents come first, and nothing is made again when the edges start.
+  ASSERT_EQ(3u, fs_.directories_made_.size());
+  EXPECT_EQ("subdir", fs_.directories_made_[0]);
+  EXPECT_EQ("subdir/dir1", fs_.directories_made_[1]);
+  EXPECT_EQ("subdir/dir2", fs_.directories_made_[2]);
+}
+
 TEST_F(BuildTest, DepFileMissing) {
   string err;
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
@@ -1586,6 +1818,66 @@ TEST_F(BuildTest, RspFileSuccess)
   ASSERT_EQ(1u, fs_.files_removed_.count("out 3.rsp"));
 }
 
+// Test that large RSP files are written in the background, and their
+// commands started once they are.
+TEST_F(BuildTest, RspFileInBackground) {
+  string long_command(100 << 10, 'x');
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_, (
+    "rule cat_rsp\n"
+    "  command = cat $rspfile > $out\n"
+    "  rspfile = $out.rsp\n"
+    "  rspfile_content = $long_command\n"
+    "build out1: cat in\n"
+    "build out2: cat_rsp in\n"
+    "  long_command = " + long_command + "\n"
+    "build out3: cat_rsp in\n"
+    "  long_command = " + long_command + "\n").c_str()));
+  fs_.Create("in", "");
+
+  string err;
+  EXPECT_TRUE(builder_.AddTarget("out1", &err));
+  EXPECT_TRUE(builder_.AddTarget("out2", &err));
+  EXPECT_TRUE(builder_.AddTarget("out3", &err));
+  ASSERT_EQ("", err);
+
+  EXPECT_TRUE(builder_.Build(&err));
+  ASSERT_EQ("", err);
+  ASSERT_EQ(3u, command_runner_.commands_ran_.size());
+  ASSERT_EQ(1u, fs_.files_created_.count("out2.rsp"));
+  ASSERT_EQ(1u, fs_.files_created_.count("out3.rsp"));
+  ASSERT_EQ(1u, fs_.files_removed_.count("out2.rsp"));
+  ASSERT_EQ(1u, fs_.files_removed_.count("out3.rsp"));
+}
+
+// Test that the response files of commands that never start, because the
+// build stopped first, are not left behind.
+TEST_F(BuildTest, RspFileInBackgroundCleanup) {
+  string long_command(100 << 10, 'x');
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_, (
+    "rule cat_rsp\n"
+    "  command = cat $rspfile > $out\n"
+    "  rspfile = $out.rsp\n"
+    "  rspfile_content = $long_command\n"
+    "build out1: cat_rsp in\n"
+    "  long_command = " + long_command + "\n"
+    "build out2: cat_rsp in\n"
+    "  long_command = " + long_command + "\n").c_str()));
+  fs_.Create("in", "");
+  // Whether or not they are written by the time the build stops.
+  fs_.Create("out1.rsp", "");
+  fs_.Create("out2.rsp", "");
+
+  string err;
+  EXPECT_TRUE(builder_.StartEdge(GetNode("out1")->in_edge(), &err));
+  EXPECT_TRUE(builder_.StartEdge(GetNode("out2")->in_edge(), &err));
+  ASSERT_EQ("", err);
+  builder_.Cleanup();
+
+  EXPECT_EQ(0u, command_runner_.commands_ran_.size());
+  EXPECT_EQ(0, fs_.Stat("out1.rsp", &err));
+  EXPECT_EQ(0, fs_.Stat("out2.rsp", &err));
+}
+
 // Test that RSP file is created but not removed for commands, which fail
 TEST_F(BuildTest, RspFileFailure) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
@@ -2200,6 +2492,65 @@ TEST_F(BuildWithDepsLogTest, DepFileDepsLogCanonicalize) {
 }
 #endif
 
+#ifndef _WIN32
+/// Records the output of running commands.
+struct PartialOutputStatus : public StatusPrinter {
+  explicit PartialOutputStatus(const BuildConfig& config)
+      : StatusPrinter(config) {}
+  virtual void BuildEdgeOutput(Edge* edge, const string& output) {
+    partial_output_ += output;
+  }
+  string partial_output_;
+};
+
+/// The /showIncludes lines of a deps = msvc command that prints more later
+/// must reach the deps log, and not be streamed out as they come.
+TEST(BuildPartialOutputTest, MsvcDeps) {
+  ScopedTempDir temp_dir;
+  temp_dir.CreateAndEnter("BuildPartialOutputTest");
+
+  State state;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state,
+"rule cl\n"
+"  command = echo 'Note: including file: hdr.h'; sleep 0.3; echo done;"
+" touch $out\n"
+"  deps = msvc\n"
+"rule slow\n"
+"  command = echo started; sleep 0.3; touch $out\n"
+"build out: cl\n"
+"build other: slow\n"));
+
+  BuildConfig config;
+  config.verbosity = BuildConfig::QUIET;
+  config.parallelism = 2;
+  config.partial_output_millis = 10;
+  PartialOutputStatus status(config);
+  RealDiskInterface disk_interface;
+  string err;
+  DepsLog deps_log;
+  ASSERT_TRUE(deps_log.OpenForWrite("ninja_deps", &err));
+
+  Builder builder(&state, config, NULL, &deps_log, &disk_interface, &status,
+                  0);
+  EXPECT_TRUE(builder.AddTarget("out", &err));
+  EXPECT_TRUE(builder.AddTarget("other", &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(builder.Build(&err));
+  EXPECT_EQ("", err);
+  deps_log.Close();
+
+  // Other commands still stream.
+  EXPECT_EQ("started\n", status.partial_output_);
+  DepsLog::Deps* deps = deps_log.GetDeps(state.LookupNode("out"));
+  ASSERT_TRUE(deps);
+  ASSERT_EQ(1, deps->node_count);
+  EXPECT_EQ("hdr.h", deps->nodes[0]->path());
+
+  builder.Cleanup();
+  temp_dir.Cleanup();
+}
+#endif
+
 /// Check that a restat rule doesn't clear an edge if the depfile is missing.
 /// Follows from: https://github.com/ninja-build/ninja/issues/603
 TEST_F(BuildTest, RestatMissingDepfile) {
@@ -2293,6 +2644,115 @@ TEST_F(BuildTest, WrongOutputInDepfileCausesRebuild) {
   ASSERT_EQ(1u, command_runner_.commands_ran_.size());
 }
 
+TEST_F(BuildTest, DyndepReadyAtScan) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"rule touch\n"
+"  command = touch $out\n"
+"build out: touch || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("dd",
+"ninja_dyndep_version = 1\n"
+"build out | out.imp: dyndep | in.imp\n");
+  fs_.Create("in.imp", "");
+
+  string err;
+  EXPECT_TRUE(builder_.AddTarget("out", &err));
+  ASSERT_EQ("", err);
+  Edge* edge = GetNode("out")->in_edge();
+  ASSERT_EQ(2u, edge->outputs_.size());
+  EXPECT_EQ("out.imp", edge->outputs_[1]->path());
+  EXPECT_EQ(1, edge->implicit_outs_);
+  ASSERT_EQ(2u, edge->inputs_.size());
+  EXPECT_EQ("in.imp", edge->inputs_[0]->path());
+  EXPECT_EQ(1, edge->implicit_deps_);
+  EXPECT_EQ(edge, GetNode("out.imp")->in_edge());
+  EXPECT_FALSE(GetNode("dd")->dyndep_pending());
+
+  EXPECT_TRUE(builder_.Build(&err));
+  EXPECT_EQ("", err);
+  ASSERT_EQ(1u, command_runner_.commands_ran_.size());
+  EXPECT_EQ("touch out", command_runner_.commands_ran_[0]);
+}
+
+TEST_F(BuildTest, DyndepBuildDiscoversInput) {
+  // Nothing but the dyndep file says that out needs in.
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"rule touch\n"
+"  command = touch $out\n"
+"rule cp\n"
+"  command = cp $in $out\n"
+"build dd: cp dd-in\n"
+"build in: touch\n"
+"build out: touch || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("dd-in",
+"ninja_dyndep_version = 1\n"
+"build out: dyndep | in\n");
+
+  string err;
+  EXPECT_TRUE(builder_.AddTarget("out", &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(GetNode("dd")->dyndep_pending());
+
+  EXPECT_TRUE(builder_.Build(&err));
+  EXPECT_EQ("", err);
+  ASSERT_EQ(3u, command_runner_.commands_ran_.size());
+  EXPECT_EQ("cp dd-in dd", command_runner_.commands_ran_[0]);
+  EXPECT_EQ("touch in", command_runner_.commands_ran_[1]);
+  EXPECT_EQ("touch out", command_runner_.commands_ran_[2]);
+}
+
+TEST_F(BuildTest, DyndepBuildOutputsAndRestat) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"rule touch\n"
+"  command = touch $out\n"
+"rule cp\n"
+"  command = cp $in $out\n"
+"build dd: cp dd-in\n"
+"build out1: touch || dd\n"
+"  dyndep = dd\n"
+"build out2: touch || dd\n"
+"  dyndep = dd\n"
+"build all: phony out1 out2\n"));
+  fs_.Create("dd-in",
+"ninja_dyndep_version = 1\n"
+"build out1 | out1.mod: dyndep\n"
+"build out2: dyndep\n"
+"  restat = 1\n");
+
+  string err;
+  EXPECT_TRUE(builder_.AddTarget("all", &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(builder_.Build(&err));
+  EXPECT_EQ("", err);
+  ASSERT_EQ(3u, command_runner_.commands_ran_.size());
+  EXPECT_EQ("cp dd-in dd", command_runner_.commands_ran_[0]);
+  EXPECT_EQ("touch out1", command_runner_.commands_ran_[1]);
+  EXPECT_EQ("touch out2", command_runner_.commands_ran_[2]);
+  EXPECT_TRUE(GetNode("out2")->in_edge()->GetBindingBool("restat"));
+  EXPECT_EQ(GetNode("out1")->in_edge(), GetNode("out1.mod")->in_edge());
+  // touch writes every output, including the one the file added.
+  EXPECT_EQ(1u, fs_.files_.count("out1.mod"));
+}
+
+TEST_F(BuildTest, DyndepBuildMissingStatement) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"rule touch\n"
+"  command = touch $out\n"
+"rule cp\n"
+"  command = cp $in $out\n"
+"build dd: cp dd-in\n"
+"build out: touch || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("dd-in", "ninja_dyndep_version = 1\n");
+
+  string err;
+  EXPECT_TRUE(builder_.AddTarget("out", &err));
+  ASSERT_EQ("", err);
+  EXPECT_FALSE(builder_.Build(&err));
+  EXPECT_EQ("'out' not mentioned in its dyndep file 'dd'", err);
+}
+
 TEST_F(BuildTest, Console) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
 "rule console\n"
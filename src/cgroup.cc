@@ -0,0 +1,158 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cgroup.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// Write \a value to the cgroup file \a path, in one write() as the kernel
+/// expects.
+bool WriteCgroupFile(const string& path, const string& value, string* err) {
+  int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *err = path + ": " + strerror(errno);
+    return false;
+  }
+  bool success = write(fd, value.data(), value.size()) ==
+                 (ssize_t)value.size();
+  if (!success)
+    *err = path + ": " + strerror(errno);
+  close(fd);
+  return success;
+}
+
+string ReadCgroupFile(const string& path) {
+  string contents, err;
+  if (::ReadFile(path, &contents, &err) < 0)
+    contents.clear();
+  return contents;
+}
+
+/// Whether the space separated \a list contains \a word.
+bool HasWord(const string& list, const string& word) {
+  size_t pos = 0;
+  while ((pos = list.find(word, pos)) != string::npos) {
+    size_t end = pos + word.size();
+    if ((pos == 0 || list[pos - 1] == ' ') &&
+        (end == list.size() || list[end] == ' ' || list[end] == '\n'))
+      return true;
+    pos = end;
+  }
+  return false;
+}
+
+}  // anonymous namespace
+
+CgroupSet::CgroupSet() : leaves_(0) {}
+
+CgroupSet::~CgroupSet() {
+  for (vector<string>::iterator i = leftovers_.begin();
+       i != leftovers_.end(); ++i) {
+    rmdir(i->c_str());
+  }
+}
+
+bool CgroupSet::Init(const string& parent, string* err) {
+  string controllers;
+  if (::ReadFile(parent + "/cgroup.controllers", &controllers, err) < 0) {
+    *err = parent + " is not a cgroup v2 directory: " + *err;
+    return false;
+  }
+  parent_ = parent;
+
+  string enabled = ReadCgroupFile(parent + "/cgroup.subtree_control");
+  string enable;
+  const char* kControllers[] = { "cpu", "memory" };
+  for (size_t i = 0; i < sizeof(kControllers) / sizeof(kControllers[0]); ++i) {
+    if (HasWord(controllers, kControllers[i]) &&
+        !HasWord(enabled, kControllers[i])) {
+      enable += string(enable.empty() ? "+" : " +") + kControllers[i];
+    }
+  }
+  if (!enable.empty() &&
+      !WriteCgroupFile(parent + "/cgroup.subtree_control", enable, err)) {
+    if (errno == EBUSY)
+      *err += " (the cgroup must not contain processes itself)";
+    return false;
+  }
+  return true;
+}
+
+bool CgroupSet::CreateLeaf(const Limits& limits, string* path, string* err) {
+  char name[64];
+  snprintf(name, sizeof(name), "/ninja-%d-%d", (int)getpid(), ++leaves_);
+  *path = parent_ + name;
+  if (mkdir(path->c_str(), 0755) < 0) {
+    *err = "mkdir(" + *path + "): " + strerror(errno);
+    return false;
+  }
+  if ((!limits.cpu_max.empty() &&
+       !WriteCgroupFile(*path + "/cpu.max", limits.cpu_max, err)) ||
+      (!limits.memory_max.empty() &&
+       !WriteCgroupFile(*path + "/memory.max", limits.memory_max, err))) {
+    rmdir(path->c_str());
+    return false;
+  }
+  return true;
+}
+
+void CgroupSet::RemoveLeaf(const string& path, Usage* usage) {
+  int64_t value;
+  if (ParseKeyedValue(ReadCgroupFile(path + "/cpu.stat"), "usage_usec",
+                      &value)) {
+    usage->cpu_micros = value;
+  }
+  string peak = ReadCgroupFile(path + "/memory.peak");
+  if (!peak.empty())
+    usage->peak_memory_bytes = strtoll(peak.c_str(), NULL, 10);
+  if (ParseKeyedValue(ReadCgroupFile(path + "/memory.events"), "oom_kill",
+                      &value)) {
+    usage->oom_kills = (int)value;
+  }
+
+  if (rmdir(path.c_str()) == 0)
+    return;
+  // Background processes outlived the command; they are part of it.
+  string err;
+  if (errno == EBUSY && WriteCgroupFile(path + "/cgroup.kill", "1", &err) &&
+      rmdir(path.c_str()) == 0) {
+    return;
+  }
+  leftovers_.push_back(path);
+}
+
+bool CgroupSet::ParseKeyedValue(const string& text, const char* key,
+                                int64_t* value) {
+  size_t len = strlen(key);
+  for (size_t line = 0; line < text.size(); ) {
+    if (text.compare(line, len, key) == 0 && line + len < text.size() &&
+        text[line + len] == ' ') {
+      *value = strtoll(text.c_str() + line + len + 1, NULL, 10);
+      return true;
+    }
+    line = text.find('\n', line);
+    if (line == string::npos)
+      break;
+    ++line;
+  }
+  return false;
+}
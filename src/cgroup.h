@@ -0,0 +1,74 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NINJA_CGROUP_H_
+#define NINJA_CGROUP_H_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "util.h"  // int64_t
+
+/// Runs each command in its own cgroup v2 leaf, below a directory that has
+/// been delegated to ninja (e.g. by systemd-run -p Delegate=yes).  Limits
+/// on CPU and memory then apply to the command and everything it starts,
+/// and what it used can be read once it exits.
+struct CgroupSet {
+  CgroupSet();
+  /// Remove leaves that were still in use when the commands exited.
+  ~CgroupSet();
+
+  /// Create leaves below \a parent, and enable the cpu and memory
+  /// controllers for them if the parent has them.  The parent must not
+  /// contain processes itself, or the controllers can't be enabled.
+  bool Init(const string& parent, string* err);
+
+  /// Limits for one command, in the syntax of the cpu.max and memory.max
+  /// files, e.g. "50000 100000" for half a CPU and "2G".  Empty means none.
+  struct Limits {
+    string cpu_max;
+    string memory_max;
+  };
+
+  /// Create a leaf with \a limits, setting \a path to its directory.
+  bool CreateLeaf(const Limits& limits, string* path, string* err);
+
+  /// What a command used, or -1 where the kernel doesn't say.
+  struct Usage {
+    Usage() : cpu_micros(-1), peak_memory_bytes(-1), oom_kills(0) {}
+    int64_t cpu_micros;
+    int64_t peak_memory_bytes;
+    /// Processes killed for exceeding memory.max.
+    int oom_kills;
+  };
+
+  /// Read the usage of the leaf at \a path, kill whatever is left in it,
+  /// and remove it.
+  void RemoveLeaf(const string& path, Usage* usage);
+
+  /// Find "\a key value" in the lines of \a text, as in cpu.stat and
+  /// memory.events.
+  static bool ParseKeyedValue(const string& text, const char* key,
+                              int64_t* value);
+
+ private:
+  string parent_;
+  int leaves_;
+  /// Leaves that couldn't be removed yet, because killed processes were
+  /// still exiting.
+  vector<string> leftovers_;
+};
+
+#endif  // NINJA_CGROUP_H_
@@ -0,0 +1,86 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cgroup.h"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "subprocess.h"
+#include "util.h"
+#include "test.h"
+
+namespace {
+
+TEST(CgroupTest, ParseKeyedValue) {
+  const char kCpuStat[] =
+"usage_usec 1500\n"
+"user_usec 1000\n"
+"system_usec 500\n";
+  int64_t value = 0;
+  EXPECT_TRUE(CgroupSet::ParseKeyedValue(kCpuStat, "usage_usec", &value));
+  EXPECT_EQ(1500, value);
+  EXPECT_TRUE(CgroupSet::ParseKeyedValue(kCpuStat, "system_usec", &value));
+  EXPECT_EQ(500, value);
+  EXPECT_FALSE(CgroupSet::ParseKeyedValue(kCpuStat, "usage", &value));
+  EXPECT_FALSE(CgroupSet::ParseKeyedValue(kCpuStat, "nr_periods", &value));
+}
+
+TEST(CgroupTest, NotACgroup) {
+  CgroupSet cgroups;
+  string err;
+  EXPECT_FALSE(cgroups.Init("ninja-no-such-cgroup", &err));
+  EXPECT_NE(string::npos, err.find("not a cgroup v2 directory"));
+}
+
+// Without a cgroup delegated to the test, a plain directory stands in for
+// one: the command still moves itself into the leaf before it runs.
+TEST(CgroupTest, RunInLeaf) {
+  ScopedTempDir temp_dir;
+  temp_dir.CreateAndEnter("CgroupTest");
+  ASSERT_EQ(0, mkdir("parent", 0755));
+  FILE* f = fopen("parent/cgroup.controllers", "w");
+  fclose(f);
+
+  CgroupSet cgroups;
+  string err;
+  ASSERT_TRUE(cgroups.Init("parent", &err));
+  string leaf;
+  ASSERT_TRUE(cgroups.CreateLeaf(CgroupSet::Limits(), &leaf, &err));
+  EXPECT_EQ(0u, leaf.find("parent/ninja-"));
+
+  SubprocessSet subprocs;
+  Subprocess* subproc = subprocs.Add("echo $0 in cgroup", false, -1, leaf);
+  ASSERT_NE((Subprocess*)0, subproc);
+  while (!subproc->Done())
+    subprocs.DoWork();
+  EXPECT_EQ(ExitSuccess, subproc->Finish());
+  EXPECT_EQ("/bin/sh in cgroup\n", subproc->GetOutput());
+  delete subproc;
+
+  string procs;
+  EXPECT_EQ(0, ReadFile(leaf + "/cgroup.procs", &procs, &err));
+  EXPECT_LT(0, atoi(procs.c_str()));
+
+  CgroupSet::Usage usage;
+  cgroups.RemoveLeaf(leaf, &usage);
+  EXPECT_EQ(-1, usage.cpu_micros);
+  EXPECT_EQ(-1, usage.peak_memory_bytes);
+
+  unlink((leaf + "/cgroup.procs").c_str());
+  rmdir(leaf.c_str());
+  temp_dir.Cleanup();
+}
+
+}  // anonymous namespace
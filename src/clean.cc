@@ -17,18 +17,92 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "disk_interface.h"
 #include "graph.h"
 #include "state.h"
 #include "util.h"
 
+namespace {
+
+/// Files of one directory, queued_[order[begin]] to queued_[order[end - 1]].
+struct RemovalChunk {
+  string dir;
+  size_t begin;
+  size_t end;
+};
+
+/// What removing the queued files (or in a dry run, looking for them) came
+/// to, by their index in the queue.
+struct RemovalResults {
+  RemovalResults(size_t count) : results(count), errors(count), sizes(count) {}
+  /// As DiskInterface::RemoveFile() returns it.
+  vector<int> results;
+  vector<string> errors;
+  /// Only measured when asked for, and -1 when unknown.
+  vector<int64_t> sizes;
+};
+
+/// Handle chunks until none are left, taking the index of the next one
+/// from |next|.  Several threads can run this at once.
+void RemoveChunksFrom(DiskInterface* disk_interface, bool dry_run,
+                      bool measure, const vector<string>* queued,
+                      const vector<size_t>* order,
+                      const vector<RemovalChunk>* chunks,
+                      std::atomic<size_t>* next, RemovalResults* out) {
+  vector<string> paths;
+  vector<int> results;
+  vector<string> errors;
+  for (size_t c; (c = (*next)++) < chunks->size(); ) {
+    const RemovalChunk& chunk = (*chunks)[c];
+    paths.clear();
+    for (size_t i = chunk.begin; i < chunk.end; ++i)
+      paths.push_back((*queued)[(*order)[i]]);
+    results.assign(paths.size(), 0);
+    errors.assign(paths.size(), string());
+    if (measure) {
+      for (size_t i = 0; i < paths.size(); ++i) {
+        out->sizes[(*order)[chunk.begin + i]] =
+            disk_interface->FileSize(paths[i]);
+      }
+    }
+    if (dry_run) {
+      for (size_t i = 0; i < paths.size(); ++i) {
+        TimeStamp mtime = disk_interface->Stat(paths[i], &errors[i]);
+        // Treat Stat() errors as "file does not exist".
+        results[i] = mtime > 0 ? 0 : 1;
+        if (mtime != -1)
+          errors[i].clear();
+      }
+    } else {
+      disk_interface->RemoveFiles(chunk.dir, paths, &results, &errors);
+    }
+    for (size_t i = 0; i < paths.size(); ++i) {
+      size_t index = (*order)[chunk.begin + i];
+      out->results[index] = results[i];
+      out->errors[index].swap(errors[i]);
+    }
+  }
+}
+
+bool DirLess(const pair<string, size_t>& a, const pair<string, size_t>& b) {
+  return a.first < b.first;
+}
+
+}  // anonymous namespace
+
 Cleaner::Cleaner(State* state, const BuildConfig& config)
   : state_(state),
     config_(config),
     removed_(),
     cleaned_(),
     cleaned_files_count_(0),
+    cleaned_bytes_(0),
     disk_interface_(new RealDiskInterface),
+    dyndep_loader_(state, disk_interface_),
     status_(0) {
 }
 
@@ -40,22 +114,12 @@ Cleaner::Cleaner(State* state,
     removed_(),
     cleaned_(),
     cleaned_files_count_(0),
+    cleaned_bytes_(0),
     disk_interface_(disk_interface),
+    dyndep_loader_(state, disk_interface),
     status_(0) {
 }
 
-int Cleaner::RemoveFile(const string& path) {
-  return disk_interface_->RemoveFile(path);
-}
-
-bool Cleaner::FileExists(const string& path) {
-  string err;
-  TimeStamp mtime = disk_interface_->Stat(path, &err);
-  if (mtime == -1)
-    Error("%s", err.c_str());
-  return mtime > 0;  // Treat Stat() errors as "file does not exist".
-}
-
 void Cleaner::Report(const string& path) {
   ++cleaned_files_count_;
   if (IsVerbose())
@@ -65,17 +129,60 @@ void Cleaner::Report(const string& path) {
 void Cleaner::Remove(const string& path) {
   if (!IsAlreadyRemoved(path)) {
     removed_.insert(path);
-    if (config_.dry_run) {
-      if (FileExists(path))
-        Report(path);
-    } else {
-      int ret = RemoveFile(path);
-      if (ret == 0)
-        Report(path);
-      else if (ret == -1)
-        status_ = 1;
+    queued_.push_back(path);
+  }
+}
+
+void Cleaner::RemoveQueued(bool measure) {
+  // Sort the files by directory, keeping the queue's order within each.
+  vector<pair<string, size_t> > dirs;
+  for (size_t i = 0; i < queued_.size(); ++i)
+    dirs.push_back(make_pair(DirName(queued_[i]), i));
+  stable_sort(dirs.begin(), dirs.end(), DirLess);
+
+  // Split big directories, so that they are shared out too.
+  const size_t kFilesPerChunk = 256;
+  vector<size_t> order;
+  vector<RemovalChunk> chunks;
+  for (size_t i = 0; i < dirs.size(); ++i) {
+    if (chunks.empty() || chunks.back().dir != dirs[i].first ||
+        chunks.back().end - chunks.back().begin == kFilesPerChunk) {
+      RemovalChunk chunk = { dirs[i].first, i, i };
+      chunks.push_back(chunk);
     }
+    order.push_back(dirs[i].second);
+    ++chunks.back().end;
   }
+
+  // Removing a few files isn't worth starting threads for.
+  const size_t kFilesPerThread = 64;
+  size_t thread_count = min(min(queued_.size() / kFilesPerThread,
+                                chunks.size()),
+                            (size_t)max(config_.parallelism, 1));
+  RemovalResults out(queued_.size());
+  std::atomic<size_t> next(0);
+  vector<std::thread> threads;
+  for (size_t t = 1; t < thread_count; ++t) {
+    threads.push_back(std::thread(RemoveChunksFrom, disk_interface_,
+                                  config_.dry_run, measure, &queued_, &order,
+                                  &chunks, &next, &out));
+  }
+  RemoveChunksFrom(disk_interface_, config_.dry_run, measure, &queued_,
+                   &order, &chunks, &next, &out);
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+
+  for (size_t i = 0; i < queued_.size(); ++i) {
+    if (!out.errors[i].empty())
+      Error("%s", out.errors[i].c_str());
+    if (out.results[i] == 0) {
+      Report(queued_[i]);
+      if (out.sizes[i] > 0)
+        cleaned_bytes_ += out.sizes[i];
+    } else if (out.results[i] == -1)
+      status_ = 1;
+  }
+  queued_.clear();
 }
 
 bool Cleaner::IsAlreadyRemoved(const string& path) {
@@ -111,6 +218,7 @@ void Cleaner::PrintFooter() {
 
 int Cleaner::CleanAll(bool generator) {
   Reset();
+  LoadDyndeps();
   PrintHeader();
   for (vector<Edge*>::iterator e = state_->edges_.begin();
        e != state_->edges_.end(); ++e) {
@@ -127,10 +235,37 @@ int Cleaner::CleanAll(bool generator) {
 
     RemoveEdgeFiles(*e);
   }
+  RemoveQueued();
   PrintFooter();
   return status_;
 }
 
+int Cleaner::CleanDead(const BuildLog::Entries& entries) {
+  Reset();
+  // Outputs only a dyndep file declares are live too.
+  LoadDyndeps();
+  PrintHeader();
+  // The log's order is its hash map's; report in the paths' order instead.
+  vector<string> dead;
+  for (BuildLog::Entries::const_iterator i = entries.begin();
+       i != entries.end(); ++i) {
+    // A path that is neither built nor used by any edge anymore is stale.
+    // Its node may only be left from the deps log.
+    Node* node = state_->LookupNode(i->first);
+    if (!node || (!node->in_edge() && node->out_edges().empty()))
+      dead.push_back(i->first.AsString());
+  }
+  sort(dead.begin(), dead.end());
+  for (vector<string>::iterator i = dead.begin(); i != dead.end(); ++i)
+    Remove(*i);
+  RemoveQueued(/*measure=*/true);
+  if (config_.verbosity != BuildConfig::QUIET) {
+    printf("%d files (%s).\n", cleaned_files_count_,
+           FormatBytes(cleaned_bytes_).c_str());
+  }
+  return status_;
+}
+
 void Cleaner::DoCleanTarget(Node* target) {
   if (Edge* e = target->in_edge()) {
     // Do not try to remove phony targets
@@ -156,8 +291,10 @@ int Cleaner::CleanTarget(Node* target) {
   assert(target);
 
   Reset();
+  LoadDyndeps();
   PrintHeader();
   DoCleanTarget(target);
+  RemoveQueued();
   PrintFooter();
   return status_;
 }
@@ -166,6 +303,7 @@ int Cleaner::CleanTarget(const char* target) {
   assert(target);
 
   Reset();
+  LoadDyndeps();
   Node* node = state_->LookupNode(target);
   if (node) {
     CleanTarget(node);
@@ -178,19 +316,24 @@ int Cleaner::CleanTarget(const char* target) {
 
 int Cleaner::CleanTargets(int target_count, char* targets[]) {
   Reset();
+  LoadDyndeps();
   PrintHeader();
   for (int i = 0; i < target_count; ++i) {
     const char* target_name = targets[i];
     Node* target = state_->LookupNode(target_name);
     if (target) {
-      if (IsVerbose())
+      if (IsVerbose()) {
+        // Report each target's files after its name.
+        RemoveQueued();
         printf("Target %s\n", target_name);
+      }
       DoCleanTarget(target);
     } else {
       Error("unknown target '%s'", target_name);
       status_ = 1;
     }
   }
+  RemoveQueued();
   PrintFooter();
   return status_;
 }
@@ -214,8 +357,10 @@ int Cleaner::CleanRule(const Rule* rule) {
   assert(rule);
 
   Reset();
+  LoadDyndeps();
   PrintHeader();
   DoCleanRule(rule);
+  RemoveQueued();
   PrintFooter();
   return status_;
 }
@@ -238,19 +383,24 @@ int Cleaner::CleanRules(int rule_count, char* rules[]) {
   assert(rules);
 
   Reset();
+  LoadDyndeps();
   PrintHeader();
   for (int i = 0; i < rule_count; ++i) {
     const char* rule_name = rules[i];
     const Rule* rule = state_->bindings_.LookupRule(rule_name);
     if (rule) {
-      if (IsVerbose())
+      if (IsVerbose()) {
+        // Report each rule's files after its name.
+        RemoveQueued();
         printf("Rule %s\n", rule_name);
+      }
       DoCleanRule(rule);
     } else {
       Error("unknown rule '%s'", rule_name);
       status_ = 1;
     }
   }
+  RemoveQueued();
   PrintFooter();
   return status_;
 }
@@ -258,6 +408,23 @@ int Cleaner::CleanRules(int rule_count, char* rules[]) {
 void Cleaner::Reset() {
   status_ = 0;
   cleaned_files_count_ = 0;
+  cleaned_bytes_ = 0;
   removed_.clear();
+  queued_.clear();
   cleaned_.clear();
 }
+
+void Cleaner::LoadDyndeps() {
+  for (vector<Edge*>::iterator e = state_->edges_.begin();
+       e != state_->edges_.end(); ++e) {
+    Node* dyndep = (*e)->dyndep_;
+    if (!dyndep || !dyndep->dyndep_pending())
+      continue;
+    string err;
+    if (disk_interface_->Stat(dyndep->path(), &err) <= 0)
+      continue;
+    // A broken dyndep file is no reason not to clean what else is known.
+    if (!dyndep_loader_.LoadDyndeps(dyndep, &err))
+      Warning("%s", err.c_str());
+  }
+}
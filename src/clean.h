@@ -17,8 +17,11 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "build.h"
+#include "build_log.h"
+#include "dyndep.h"
 
 using namespace std;
 
@@ -62,11 +65,21 @@ struct Cleaner {
   /// @return non-zero if an error occurs.
   int CleanRules(int rule_count, char* rules[]);
 
+  /// Clean the outputs in the build log \a entries that no edge in the
+  /// manifest builds anymore, reporting the bytes that frees up.
+  /// @return non-zero if an error occurs.
+  int CleanDead(const BuildLog::Entries& entries);
+
   /// @return the number of file cleaned.
   int cleaned_files_count() const {
     return cleaned_files_count_;
   }
 
+  /// @return the bytes the cleaned files took up, when measured.
+  int64_t cleaned_bytes() const {
+    return cleaned_bytes_;
+  }
+
   /// @return whether the cleaner is in verbose mode.
   bool IsVerbose() const {
     return (config_.verbosity != BuildConfig::QUIET
@@ -74,15 +87,14 @@ struct Cleaner {
   }
 
  private:
-  /// Remove the file @a path.
-  /// @return whether the file has been removed.
-  int RemoveFile(const string& path);
-  /// @returns whether the file @a path exists.
-  bool FileExists(const string& path);
   void Report(const string& path);
 
-  /// Remove the given @a path file only if it has not been already removed.
+  /// Queue the given @a path file for removal, unless it already was.
   void Remove(const string& path);
+  /// Remove the queued files, on several threads and a directory at a
+  /// time, then report them in the order they were queued.  With
+  /// @a measure, add up their sizes first.
+  void RemoveQueued(bool measure = false);
   /// @return whether the given @a path has already been removed.
   bool IsAlreadyRemoved(const string& path);
   /// Remove the depfile and rspfile for an Edge.
@@ -95,12 +107,20 @@ struct Cleaner {
   void DoCleanRule(const Rule* rule);
   void Reset();
 
+  /// Load the dyndep files that exist, so that the outputs they add are
+  /// cleaned too.
+  void LoadDyndeps();
+
   State* state_;
   const BuildConfig& config_;
   set<string> removed_;
+  /// Files to remove, in the order they were found.
+  vector<string> queued_;
   set<Node*> cleaned_;
   int cleaned_files_count_;
+  int64_t cleaned_bytes_;
   DiskInterface* disk_interface_;
+  DyndepLoader dyndep_loader_;
   int status_;
 };
 
@@ -56,6 +56,30 @@ TEST_F(CleanTest, CleanAll) {
   EXPECT_EQ(0u, fs_.files_removed_.size());
 }
 
+// Enough files, in enough directories, to be removed on several threads.
+TEST_F(CleanTest, CleanAllMany) {
+  string manifest;
+  for (int i = 0; i < 2000; ++i) {
+    char line[64];
+    snprintf(line, sizeof(line), "build d%d/out%d: cat src%d\n", i % 7, i, i);
+    manifest += line;
+  }
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_, manifest.c_str()));
+  for (int i = 0; i < 2000; i += 2) {
+    char path[32];
+    snprintf(path, sizeof(path), "d%d/out%d", i % 7, i);
+    fs_.Create(path, "");
+  }
+
+  config_.parallelism = 8;
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanAll());
+  EXPECT_EQ(1000, cleaner.cleaned_files_count());
+  EXPECT_EQ(1000u, fs_.files_removed_.size());
+  EXPECT_EQ(1u, fs_.files_removed_.count("d3/out10"));
+  EXPECT_EQ(0u, fs_.files_removed_.count("d4/out11"));
+}
+
 TEST_F(CleanTest, CleanAllDryRun) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
 "build in1: cat src1\n"
@@ -377,6 +401,64 @@ TEST_F(CleanTest, CleanPhony) {
   EXPECT_LT(0, fs_.Stat("phony", &err));
 }
 
+TEST_F(CleanTest, CleanDyndep) {
+  // A dyndep file that exists tells of outputs to clean too.
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat in || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("in", "");
+  fs_.Create("dd",
+"ninja_dyndep_version = 1\n"
+"build out | out.imp: dyndep\n");
+  fs_.Create("out", "");
+  fs_.Create("out.imp", "");
+
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanAll());
+  EXPECT_EQ(2, cleaner.cleaned_files_count());
+  EXPECT_EQ(2u, fs_.files_removed_.size());
+
+  string err;
+  EXPECT_EQ(0, fs_.Stat("out", &err));
+  EXPECT_EQ(0, fs_.Stat("out.imp", &err));
+}
+
+TEST_F(CleanTest, CleanDyndepTarget) {
+  // An output only the dyndep file names can be cleaned by name.
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat in || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("in", "");
+  fs_.Create("dd",
+"ninja_dyndep_version = 1\n"
+"build out | out.imp: dyndep\n");
+  fs_.Create("out", "");
+  fs_.Create("out.imp", "");
+
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanTarget("out.imp"));
+  EXPECT_EQ(1, cleaner.cleaned_files_count());
+  EXPECT_EQ(1u, fs_.files_removed_.count("out.imp"));
+}
+
+TEST_F(CleanTest, CleanDyndepMissing) {
+  // Without its dyndep file, only what the manifest says is cleaned.
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat in || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("in", "");
+  fs_.Create("out", "");
+  fs_.Create("out.imp", "");
+
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanAll());
+  EXPECT_EQ(1, cleaner.cleaned_files_count());
+  EXPECT_EQ(1u, fs_.files_removed_.count("out"));
+
+  string err;
+  EXPECT_LT(0, fs_.Stat("out.imp", &err));
+}
+
 TEST_F(CleanTest, CleanDepFileAndRspFileWithSpaces) {
   ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
 "rule cc_dep\n"
@@ -405,3 +487,68 @@ TEST_F(CleanTest, CleanDepFileAndRspFileWithSpaces) {
   EXPECT_EQ(0, fs_.Stat("out 1.d", &err));
   EXPECT_EQ(0, fs_.Stat("out 2.rsp", &err));
 }
+
+TEST_F(CleanTest, CleanDead) {
+  State old_state;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&old_state,
+"rule cat\n"
+"  command = cat $in > $out\n"
+"build out1: cat in\n"
+"build out2: cat in\n"
+"build gone: cat in\n"
+"build now_a_source: cat in\n"));
+  BuildLog log;
+  for (vector<Edge*>::iterator e = old_state.edges_.begin();
+       e != old_state.edges_.end(); ++e) {
+    log.RecordCommand(*e, 15, 18);
+  }
+
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out1: cat in\n"
+"build out3: cat now_a_source\n"));
+  fs_.Create("in", "");
+  fs_.Create("out1", "1");
+  fs_.Create("out2", "22");
+  fs_.Create("now_a_source", "333");
+
+  config_.dry_run = true;
+  Cleaner dry_run(&state_, config_, &fs_);
+  EXPECT_EQ(0, dry_run.CleanDead(log.entries()));
+  EXPECT_EQ(1, dry_run.cleaned_files_count());
+  EXPECT_EQ(2, dry_run.cleaned_bytes());
+  EXPECT_EQ(0u, fs_.files_removed_.size());
+
+  config_.dry_run = false;
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanDead(log.entries()));
+  EXPECT_EQ(1, cleaner.cleaned_files_count());
+  EXPECT_EQ(2, cleaner.cleaned_bytes());
+  EXPECT_EQ(1u, fs_.files_removed_.size());
+  EXPECT_EQ(1u, fs_.files_removed_.count("out2"));
+}
+
+TEST_F(CleanTest, CleanDeadDyndep) {
+  State old_state;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&old_state,
+"rule cat\n"
+"  command = cat $in > $out\n"
+"build out | out.extra: cat both\n"));
+  BuildLog log;
+  log.RecordCommand(old_state.edges_[0], 15, 18);
+
+  // Now out.extra is only declared by the dyndep file.
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat both || dd\n"
+"  dyndep = dd\n"));
+  fs_.Create("both", "");
+  fs_.Create("dd",
+"ninja_dyndep_version = 1\n"
+"build out | out.extra: dyndep\n");
+  fs_.Create("out", "");
+  fs_.Create("out.extra", "");
+
+  Cleaner cleaner(&state_, config_, &fs_);
+  EXPECT_EQ(0, cleaner.CleanDead(log.entries()));
+  EXPECT_EQ(0, cleaner.cleaned_files_count());
+  EXPECT_EQ(0u, fs_.files_removed_.size());
+}
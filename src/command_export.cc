@@ -0,0 +1,130 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "command_export.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "build_log.h"
+#include "graph.h"
+#include "json.h"
+
+namespace {
+
+/// Evaluate commands for chunks of edges until none are left.
+void EvaluateCommandsFrom(const vector<Edge*>* edges,
+                          std::atomic<size_t>* next, vector<string>* commands) {
+  // Chunks keep the threads from contending on the counter.
+  const size_t kChunk = 256;
+  for (;;) {
+    size_t begin = next->fetch_add(kChunk);
+    if (begin >= edges->size())
+      return;
+    size_t end = min(begin + kChunk, edges->size());
+    for (size_t i = begin; i < end; ++i)
+      (*commands)[i] = (*edges)[i]->EvaluateCommand();
+  }
+}
+
+}  // anonymous namespace
+
+void EvaluateCommands(const vector<Edge*>& edges, int parallelism,
+                      vector<string>* commands) {
+  commands->clear();
+  commands->resize(edges.size());
+
+  // A few thousand commands evaluate faster than threads start.
+  const size_t kEdgesPerThread = 4096;
+  size_t thread_count = min(edges.size() / kEdgesPerThread,
+                            (size_t)max(parallelism, 1));
+  std::atomic<size_t> next(0);
+  vector<std::thread> threads;
+  for (size_t t = 1; t < thread_count; ++t) {
+    threads.push_back(std::thread(EvaluateCommandsFrom, &edges, &next,
+                                  commands));
+  }
+  EvaluateCommandsFrom(&edges, &next, commands);
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+}
+
+CompilationDatabase::CompilationDatabase(const string& directory)
+    : previous_count_(0), matched_(0), entries_(0), changed_(0) {
+  AppendJSONString(directory, &directory_);
+  contents_ = "[";
+}
+
+bool CompilationDatabase::LoadPrevious(const string& contents, string* err) {
+  vector<map<string, JSONValue> > objects;
+  vector<string> raw;
+  if (!ParseFlatJSONArray(contents, &objects, &raw, err))
+    return false;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    map<string, JSONValue>& object = objects[i];
+    // Entries from another directory have to be written anew.
+    string directory;
+    AppendJSONString(object["directory"].str, &directory);
+    if (directory != directory_)
+      continue;
+    Previous previous = {
+      BuildLog::LogEntry::HashCommand(object["command"].str), raw[i]
+    };
+    previous_[object["file"].str].push_back(previous);
+  }
+  previous_count_ = objects.size();
+  return true;
+}
+
+void CompilationDatabase::AddEntry(const string& command, const string& file) {
+  if (entries_++ > 0)
+    contents_.push_back(',');
+  contents_ += "\n  ";
+
+  map<string, vector<Previous> >::iterator i = previous_.find(file);
+  if (i != previous_.end()) {
+    uint64_t command_hash = BuildLog::LogEntry::HashCommand(command);
+    vector<Previous>& entries = i->second;
+    for (vector<Previous>::iterator e = entries.begin(); e != entries.end();
+         ++e) {
+      if (e->command_hash == command_hash) {
+        contents_ += e->text;
+        entries.erase(e);
+        ++matched_;
+        return;
+      }
+    }
+    // The command changed; the new entry replaces the first old one.
+    if (!entries.empty()) {
+      entries.erase(entries.begin());
+      ++matched_;
+    }
+  }
+
+  ++changed_;
+  contents_ += "{\n    \"directory\": " + directory_ + ",\n    \"command\": ";
+  AppendJSONString(command, &contents_);
+  contents_ += ",\n    \"file\": ";
+  AppendJSONString(file, &contents_);
+  contents_ += "\n  }";
+}
+
+string CompilationDatabase::Finish() {
+  changed_ += previous_count_ - matched_;
+  previous_.clear();
+  contents_ += "\n]\n";
+  return contents_;
+}
@@ -0,0 +1,72 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NINJA_COMMAND_EXPORT_H_
+#define NINJA_COMMAND_EXPORT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "util.h"  // uint64_t
+
+struct Edge;
+
+/// Evaluate the commands of \a edges on up to \a parallelism threads,
+/// setting (*commands)[i] to the command of edges[i].  Evaluating only
+/// reads the graph, so the edges can be shared out freely.
+void EvaluateCommands(const vector<Edge*>& edges, int parallelism,
+                      vector<string>* commands);
+
+/// The text of a compilation database, as clang tools read it, built up
+/// one entry at a time.  Given an earlier export, entries whose command
+/// hasn't changed are kept as they were written, and the changed ones are
+/// counted, so that a file nothing changed in need not be rewritten.
+struct CompilationDatabase {
+  explicit CompilationDatabase(const string& directory);
+
+  /// Read the entries of an earlier export.
+  bool LoadPrevious(const string& contents, string* err);
+
+  /// Add the entry for \a command, which compiles \a file.
+  void AddEntry(const string& command, const string& file);
+
+  /// The database, once all entries are added.
+  string Finish();
+
+  /// The number of entries that were added, changed, or went away since
+  /// the earlier export.  Valid after Finish().
+  int changed() const { return changed_; }
+
+ private:
+  /// An entry of the earlier export.
+  struct Previous {
+    uint64_t command_hash;
+    string text;
+  };
+  /// Entries of the earlier export by file, in the order they were written.
+  map<string, vector<Previous> > previous_;
+  size_t previous_count_;
+  /// Earlier entries that were kept or replaced; the rest went away.
+  size_t matched_;
+
+  string directory_;
+  string contents_;
+  int entries_;
+  int changed_;
+};
+
+#endif  // NINJA_COMMAND_EXPORT_H_
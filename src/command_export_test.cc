@@ -0,0 +1,105 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "command_export.h"
+
+#include "graph.h"
+#include "state.h"
+#include "test.h"
+
+namespace {
+
+TEST(CommandExportTest, EvaluateCommandsInOrder) {
+  State state;
+  string manifest = "rule cc\n  command = cc $in -o $out\n";
+  // Enough edges for several threads.
+  const int kEdges = 10000;
+  for (int i = 0; i < kEdges; ++i) {
+    char line[64];
+    snprintf(line, sizeof(line), "build %d.o: cc %d.c\n", i, i);
+    manifest += line;
+  }
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state, manifest.c_str()));
+
+  vector<string> commands;
+  EvaluateCommands(state.edges_, 4, &commands);
+  ASSERT_EQ((size_t)kEdges, commands.size());
+  EXPECT_EQ("cc 0.c -o 0.o", commands[0]);
+  EXPECT_EQ("cc 4242.c -o 4242.o", commands[4242]);
+  EXPECT_EQ("cc 9999.c -o 9999.o", commands[kEdges - 1]);
+}
+
+TEST(CommandExportTest, CompilationDatabase) {
+  CompilationDatabase database("/src");
+  database.AddEntry("cc \"a b.c\"", "a b.c");
+  database.AddEntry("cc b.c", "b.c");
+  EXPECT_EQ("[\n"
+            "  {\n"
+            "    \"directory\": \"/src\",\n"
+            "    \"command\": \"cc \\\"a b.c\\\"\",\n"
+            "    \"file\": \"a b.c\"\n"
+            "  },\n"
+            "  {\n"
+            "    \"directory\": \"/src\",\n"
+            "    \"command\": \"cc b.c\",\n"
+            "    \"file\": \"b.c\"\n"
+            "  }\n"
+            "]\n", database.Finish());
+  EXPECT_EQ(2, database.changed());
+
+  CompilationDatabase empty("/src");
+  EXPECT_EQ("[\n]\n", empty.Finish());
+}
+
+TEST(CommandExportTest, CompilationDatabaseIncremental) {
+  CompilationDatabase first("/src");
+  first.AddEntry("cc a.c", "a.c");
+  first.AddEntry("cc b.c", "b.c");
+  first.AddEntry("cc c.c", "c.c");
+  string previous = first.Finish();
+
+  // Nothing changed.
+  CompilationDatabase same("/src");
+  string err;
+  ASSERT_TRUE(same.LoadPrevious(previous, &err));
+  same.AddEntry("cc a.c", "a.c");
+  same.AddEntry("cc b.c", "b.c");
+  same.AddEntry("cc c.c", "c.c");
+  EXPECT_EQ(previous, same.Finish());
+  EXPECT_EQ(0, same.changed());
+
+  // One command changed, one entry went away.
+  CompilationDatabase changed("/src");
+  ASSERT_TRUE(changed.LoadPrevious(previous, &err));
+  changed.AddEntry("cc -O2 a.c", "a.c");
+  changed.AddEntry("cc b.c", "b.c");
+  string contents = changed.Finish();
+  EXPECT_EQ(2, changed.changed());
+  EXPECT_NE(string::npos, contents.find("cc -O2 a.c"));
+  EXPECT_EQ(string::npos, contents.find("c.c\""));
+
+  // Entries for another directory are all new.
+  CompilationDatabase moved("/elsewhere");
+  ASSERT_TRUE(moved.LoadPrevious(previous, &err));
+  moved.AddEntry("cc a.c", "a.c");
+  moved.Finish();
+  EXPECT_EQ(4, moved.changed());
+
+  CompilationDatabase bad("/src");
+  EXPECT_FALSE(bad.LoadPrevious("[{\"file\": 1},", &err));
+  EXPECT_EQ("expected '{'", err);
+}
+
+}  // anonymous namespace
@@ -24,6 +24,8 @@
 
 extern bool g_explaining;
 
+extern bool g_print_stats;
+
 extern bool g_keep_depfile;
 
 extern bool g_keep_rsp;
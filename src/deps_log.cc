@@ -22,6 +22,9 @@
 #include <unistd.h>
 #endif
 
+#include <map>
+#include <thread>
+
 #include "graph.h"
 #include "metrics.h"
 #include "state.h"
@@ -36,44 +39,188 @@ const int kCurrentVersion = 3;
 // internal buffers having to have this size.
 const unsigned kMaxRecordSize = (1 << 19) - 1;
 
+namespace {
+
+bool WriteHeader(FILE* f) {
+  return fwrite(kFileSignature, sizeof(kFileSignature) - 1, 1, f) == 1 &&
+         fwrite(&kCurrentVersion, 4, 1, f) == 1;
+}
+
+void AppendInt(string* out, unsigned value) {
+  out->append(reinterpret_cast<const char*>(&value), 4);
+}
+
+bool AppendPathRecord(string* out, const string& path, int id) {
+  int path_size = path.size();
+  int padding = (4 - path_size % 4) % 4;  // Pad path to 4 byte boundary.
+
+  unsigned size = path_size + padding + 4;
+  if (size > kMaxRecordSize) {
+    errno = ERANGE;
+    return false;
+  }
+  assert(path_size > 0);
+  AppendInt(out, size);
+  out->append(path);
+  out->append(padding, '\0');
+  AppendInt(out, ~(unsigned)id);
+  return true;
+}
+
+/// Append the start of a deps record; the caller appends the input ids.
+bool AppendDepsRecordHeader(string* out, int out_id, int mtime,
+                            int node_count) {
+  unsigned size = 4 * (1 + 1 + node_count);
+  if (size > kMaxRecordSize) {
+    errno = ERANGE;
+    return false;
+  }
+  size |= 0x80000000;  // Deps record: set high bit.
+  AppendInt(out, size);
+  AppendInt(out, out_id);
+  AppendInt(out, mtime);
+  return true;
+}
+
+}  // namespace
+
+/// State shared with the thread of a background recompaction.  The thread
+/// can't use Node::id(), which the main thread keeps assigning for the old
+/// log, so it numbers the paths of the new log in |ids| itself.  Until the
+/// thread is joined, the main thread only touches |delta| and |retired|.
+struct DepsLog::BackgroundRecompaction {
+  explicit BackgroundRecompaction(const string& path)
+      : path(path), temp_path(path + ".recompact"), file(NULL),
+        success(false) {}
+
+  /// Write |entries| to |temp_path|.  Runs on |thread|.
+  void Run();
+
+  /// Write a deps record to |file|, preceded by path records for the nodes
+  /// that don't have an id in the new log yet.
+  bool WriteDeps(Node* node, Deps* deps);
+  bool GetId(Node* node, int* id, string* records);
+
+  string path;
+  string temp_path;
+
+  /// The live deps entries when the recompaction started.
+  vector<pair<Node*, Deps*> > entries;
+
+  /// Deps recorded since the recompaction started, and the ones they
+  /// replaced.  Those stay alive until the thread is done with |entries|.
+  vector<pair<Node*, Deps*> > delta;
+  vector<Deps*> retired;
+
+  FILE* file;
+  map<Node*, int> ids;
+  vector<Node*> nodes;
+  vector<bool> has_deps;
+  bool success;
+  string err;
+
+  std::thread thread;
+};
+
+void DepsLog::BackgroundRecompaction::Run() {
+  // Truncate any left-over file from a previous recompaction that crashed.
+  file = fopen(temp_path.c_str(), "wb");
+  if (!file || !WriteHeader(file)) {
+    err = strerror(errno);
+    return;
+  }
+
+  for (vector<pair<Node*, Deps*> >::iterator i = entries.begin();
+       i != entries.end(); ++i) {
+    if (!WriteDeps(i->first, i->second)) {
+      err = strerror(errno);
+      return;
+    }
+  }
+
+  success = true;
+}
+
+bool DepsLog::BackgroundRecompaction::WriteDeps(Node* node, Deps* deps) {
+  string records;
+  int out_id;
+  if (!GetId(node, &out_id, &records))
+    return false;
+  vector<int> input_ids(deps->node_count);
+  for (int i = 0; i < deps->node_count; ++i) {
+    if (!GetId(deps->nodes[i], &input_ids[i], &records))
+      return false;
+  }
+
+  if (!AppendDepsRecordHeader(&records, out_id, deps->mtime,
+                              deps->node_count))
+    return false;
+  for (int i = 0; i < deps->node_count; ++i)
+    AppendInt(&records, input_ids[i]);
+  if (fwrite(records.data(), records.size(), 1, file) < 1)
+    return false;
+  has_deps[out_id] = true;
+  return true;
+}
+
+bool DepsLog::BackgroundRecompaction::GetId(Node* node, int* id,
+                                            string* records) {
+  map<Node*, int>::iterator i = ids.find(node);
+  if (i != ids.end()) {
+    *id = i->second;
+    return true;
+  }
+
+  *id = nodes.size();
+  if (!AppendPathRecord(records, node->path(), *id))
+    return false;
+  ids.insert(make_pair(node, *id));
+  nodes.push_back(node);
+  has_deps.push_back(false);
+  return true;
+}
+
 DepsLog::~DepsLog() {
   Close();
 }
 
 bool DepsLog::OpenForWrite(const string& path, string* err) {
   if (needs_recompaction_) {
-    if (!Recompact(path, err))
+    if (background_recompaction_) {
+      StartBackgroundRecompaction(path);
+      needs_recompaction_ = false;
+    } else if (!Recompact(path, err)) {
       return false;
+    }
   }
   
-  file_ = fopen(path.c_str(), "ab");
-  if (!file_) {
+  FILE* file = fopen(path.c_str(), "ab");
+  if (!file) {
     *err = strerror(errno);
     return false;
   }
-  // Set the buffer size to this and flush the file buffer after every record
-  // to make sure records aren't written partially.
-  setvbuf(file_, NULL, _IOFBF, kMaxRecordSize + 1);
-  SetCloseOnExec(fileno(file_));
+  SetCloseOnExec(fileno(file));
 
   // Opening a file in append mode doesn't set the file pointer to the file's
   // end on Windows. Do that explicitly.
-  fseek(file_, 0, SEEK_END);
+  fseek(file, 0, SEEK_END);
 
-  if (ftell(file_) == 0) {
-    if (fwrite(kFileSignature, sizeof(kFileSignature) - 1, 1, file_) < 1) {
-      *err = strerror(errno);
-      return false;
-    }
-    if (fwrite(&kCurrentVersion, 4, 1, file_) < 1) {
+  if (ftell(file) == 0) {
+    if (!WriteHeader(file)) {
       *err = strerror(errno);
+      fclose(file);
       return false;
     }
   }
-  if (fflush(file_) != 0) {
+  if (fflush(file) != 0) {
     *err = strerror(errno);
+    fclose(file);
     return false;
   }
+
+  // Records are written whole by the log writer, so they are never written
+  // partially unless the disk fills up.
+  log_writer_.Open(file);
   return true;
 }
 
@@ -88,19 +235,27 @@ bool DepsLog::RecordDeps(Node* node, TimeStamp mtime,
   // Track whether there's any new data to be recorded.
   bool made_change = false;
 
-  // Assign ids to all nodes that are missing one.
+  // Assign ids to all nodes that are missing one, collecting the records
+  // to write them together with the deps record.
+  string records;
+  bool ids_assigned = true;
   if (node->id() < 0) {
-    if (!RecordId(node))
-      return false;
+    ids_assigned = RecordId(node, &records);
     made_change = true;
   }
-  for (int i = 0; i < node_count; ++i) {
+  for (int i = 0; ids_assigned && i < node_count; ++i) {
     if (nodes[i]->id() < 0) {
-      if (!RecordId(nodes[i]))
-        return false;
+      ids_assigned = RecordId(nodes[i], &records);
       made_change = true;
     }
   }
+  if (!ids_assigned) {
+    // The ids assigned so far must still make it to disk.
+    int error = errno;
+    log_writer_.Append(records);
+    errno = error;
+    return false;
+  }
 
   // See if the new data is different than the existing data, if any.
   if (!made_change) {
@@ -124,26 +279,15 @@ bool DepsLog::RecordDeps(Node* node, TimeStamp mtime,
     return true;
 
   // Update on-disk representation.
-  unsigned size = 4 * (1 + 1 + node_count);
-  if (size > kMaxRecordSize) {
-    errno = ERANGE;
-    return false;
-  }
-  size |= 0x80000000;  // Deps record: set high bit.
-  if (fwrite(&size, 4, 1, file_) < 1)
-    return false;
-  int id = node->id();
-  if (fwrite(&id, 4, 1, file_) < 1)
+  if (!AppendDepsRecordHeader(&records, node->id(), mtime, node_count)) {
+    int error = errno;
+    log_writer_.Append(records);
+    errno = error;
     return false;
-  int timestamp = mtime;
-  if (fwrite(&timestamp, 4, 1, file_) < 1)
-    return false;
-  for (int i = 0; i < node_count; ++i) {
-    id = nodes[i]->id();
-    if (fwrite(&id, 4, 1, file_) < 1)
-      return false;
   }
-  if (fflush(file_) != 0)
+  for (int i = 0; i < node_count; ++i)
+    AppendInt(&records, nodes[i]->id());
+  if (!log_writer_.Append(records))
     return false;
 
   // Update in-memory representation.
@@ -152,13 +296,90 @@ bool DepsLog::RecordDeps(Node* node, TimeStamp mtime,
     deps->nodes[i] = nodes[i];
   UpdateDeps(node->id(), deps);
 
+  if (recompaction_)
+    recompaction_->delta.push_back(make_pair(node, deps));
+
   return true;
 }
 
 void DepsLog::Close() {
-  if (file_)
-    fclose(file_);
-  file_ = NULL;
+  log_writer_.Close();
+
+  if (recompaction_) {
+    string err;
+    if (!FinishBackgroundRecompaction(&err))
+      Warning("recompacting deps log: %s", err.c_str());
+  }
+}
+
+void DepsLog::StartBackgroundRecompaction(const string& path) {
+  METRIC_RECORD(".ninja_deps recompact start");
+  recompaction_ = new BackgroundRecompaction(path);
+  for (int old_id = 0; old_id < (int)deps_.size(); ++old_id) {
+    Deps* deps = deps_[old_id];
+    if (deps && IsDepsEntryLiveFor(nodes_[old_id]))
+      recompaction_->entries.push_back(make_pair(nodes_[old_id], deps));
+  }
+  recompaction_->thread = std::thread(&BackgroundRecompaction::Run,
+                                      recompaction_);
+}
+
+bool DepsLog::FinishBackgroundRecompaction(string* err) {
+  METRIC_RECORD(".ninja_deps recompact finish");
+  BackgroundRecompaction* recompaction = recompaction_;
+  recompaction_ = NULL;
+  recompaction->thread.join();
+
+  bool success = recompaction->success;
+  for (vector<pair<Node*, Deps*> >::iterator i = recompaction->delta.begin();
+       success && i != recompaction->delta.end(); ++i) {
+    if (!recompaction->WriteDeps(i->first, i->second)) {
+      recompaction->err = strerror(errno);
+      success = false;
+    }
+  }
+  if (recompaction->file && fclose(recompaction->file) != 0 && success) {
+    recompaction->err = strerror(errno);
+    success = false;
+  }
+  if (success && !RenameOverwriting(recompaction->temp_path,
+                                    recompaction->path, &recompaction->err)) {
+    success = false;
+  }
+
+  if (success) {
+    // Switch to the ids of the new log.  deps_ has the latest deps of every
+    // node, which are the ones the new log ends with; deps of nodes that
+    // weren't written were dead.
+    vector<Deps*> deps(recompaction->nodes.size());
+    for (int old_id = 0; old_id < (int)nodes_.size(); ++old_id) {
+      Node* node = nodes_[old_id];
+      Deps* old_deps = old_id < (int)deps_.size() ? deps_[old_id] : NULL;
+      map<Node*, int>::iterator i = recompaction->ids.find(node);
+      if (i == recompaction->ids.end()) {
+        node->set_id(-1);
+        delete old_deps;
+        continue;
+      }
+      node->set_id(i->second);
+      if (recompaction->has_deps[i->second])
+        deps[i->second] = old_deps;
+      else
+        delete old_deps;
+    }
+    nodes_.swap(recompaction->nodes);
+    deps_.swap(deps);
+  } else {
+    // The old log has all the records; just drop the partial new one.
+    unlink(recompaction->temp_path.c_str());
+    *err = recompaction->err;
+  }
+
+  for (vector<Deps*>::iterator i = recompaction->retired.begin();
+       i != recompaction->retired.end(); ++i)
+    delete *i;
+  delete recompaction;
+  return success;
 }
 
 bool DepsLog::Load(const string& path, State* state, string* err) {
@@ -345,17 +566,7 @@ bool DepsLog::Recompact(const string& path, string* err) {
   deps_.swap(new_log.deps_);
   nodes_.swap(new_log.nodes_);
 
-  if (unlink(path.c_str()) < 0) {
-    *err = strerror(errno);
-    return false;
-  }
-
-  if (rename(temp_path.c_str(), path.c_str()) < 0) {
-    *err = strerror(errno);
-    return false;
-  }
-
-  return true;
+  return RenameOverwriting(temp_path, path, err);
 }
 
 bool DepsLog::IsDepsEntryLiveFor(Node* node) {
@@ -373,34 +584,20 @@ bool DepsLog::UpdateDeps(int out_id, Deps* deps) {
     deps_.resize(out_id + 1);
 
   bool delete_old = deps_[out_id] != NULL;
-  if (delete_old)
-    delete deps_[out_id];
+  if (delete_old) {
+    // A background recompaction may still be reading the old deps.
+    if (recompaction_)
+      recompaction_->retired.push_back(deps_[out_id]);
+    else
+      delete deps_[out_id];
+  }
   deps_[out_id] = deps;
   return delete_old;
 }
 
-bool DepsLog::RecordId(Node* node) {
-  int path_size = node->path().size();
-  int padding = (4 - path_size % 4) % 4;  // Pad path to 4 byte boundary.
-
-  unsigned size = path_size + padding + 4;
-  if (size > kMaxRecordSize) {
-    errno = ERANGE;
-    return false;
-  }
-  if (fwrite(&size, 4, 1, file_) < 1)
-    return false;
-  if (fwrite(node->path().data(), path_size, 1, file_) < 1) {
-    assert(node->path().size() > 0);
-    return false;
-  }
-  if (padding && fwrite("\0\0", padding, 1, file_) < 1)
-    return false;
+bool DepsLog::RecordId(Node* node, string* records) {
   int id = nodes_.size();
-  unsigned checksum = ~(unsigned)id;
-  if (fwrite(&checksum, 4, 1, file_) < 1)
-    return false;
-  if (fflush(file_) != 0)
+  if (!AppendPathRecord(records, node->path(), id))
     return false;
 
   node->set_id(id);
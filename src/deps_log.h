@@ -21,6 +21,7 @@ using namespace std;
 
 #include <stdio.h>
 
+#include "log_writer.h"
 #include "timestamp.h"
 
 struct Node;
@@ -64,15 +65,29 @@ struct State;
 /// wins, allowing updates to just be appended to the file.  A separate
 /// repacking step can run occasionally to remove dead records.
 struct DepsLog {
-  DepsLog() : needs_recompaction_(false), file_(NULL) {}
+  DepsLog() : needs_recompaction_(false), background_recompaction_(false),
+              recompaction_(NULL) {}
   ~DepsLog();
 
   // Writing (build-time) interface.
   bool OpenForWrite(const string& path, string* err);
+  /// Record the deps of \a node.  They are written to the log on a
+  /// background thread; a false return means an earlier write failed.
   bool RecordDeps(Node* node, TimeStamp mtime, const vector<Node*>& nodes);
   bool RecordDeps(Node* node, TimeStamp mtime, int node_count, Node** nodes);
+  /// Wait until all recorded deps have been written to the log.
+  bool Flush() { return log_writer_.Flush(); }
+  /// Close the log.  If a background recompaction is running, wait for it
+  /// and swap the recompacted log in.
   void Close();
 
+  /// If set, OpenForWrite() recompacts the log on a background thread,
+  /// like BuildLog::set_background_recompaction().  Node ids keep referring
+  /// to the old log until Close().
+  void set_background_recompaction(bool background) {
+    background_recompaction_ = background;
+  }
+
   // Reading (startup-time) interface.
   struct Deps {
     Deps(int mtime, int node_count)
@@ -99,16 +114,27 @@ struct DepsLog {
   /// Used for tests.
   const vector<Node*>& nodes() const { return nodes_; }
   const vector<Deps*>& deps() const { return deps_; }
+  bool recompacting_in_background() const { return recompaction_ != NULL; }
 
  private:
+  struct BackgroundRecompaction;
+
+  /// Start recompacting the log at \a path on a background thread.
+  void StartBackgroundRecompaction(const string& path);
+  /// Wait for the background recompaction, then append the records written
+  /// since it started, replace the log with it and switch to its ids.
+  bool FinishBackgroundRecompaction(string* err);
+
   // Updates the in-memory representation.  Takes ownership of |deps|.
   // Returns true if a prior deps record was deleted.
   bool UpdateDeps(int out_id, Deps* deps);
-  // Write a node name record, assigning it an id.
-  bool RecordId(Node* node);
+  // Append a node name record to |records|, assigning it an id.
+  bool RecordId(Node* node, string* records);
 
   bool needs_recompaction_;
-  FILE* file_;
+  LogWriter log_writer_;
+  bool background_recompaction_;
+  BackgroundRecompaction* recompaction_;
 
   /// Maps id -> Node.
   vector<Node*> nodes_;
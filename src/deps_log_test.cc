@@ -322,6 +322,91 @@ TEST_F(DepsLogTest, Recompact) {
   }
 }
 
+// Verify that a background recompaction keeps the deps recorded while it
+// runs and switches the in-memory log to the new ids.
+TEST_F(DepsLogTest, BackgroundRecompact) {
+  const char kManifest[] =
+"rule cc\n"
+"  command = cc\n"
+"  deps = gcc\n"
+"build out.o: cc\n"
+"build other_out.o: cc\n";
+
+  // Write enough redundant records to trigger a recompaction on next load.
+  int file_size;
+  {
+    State state;
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state, kManifest));
+    DepsLog log;
+    string err;
+    ASSERT_TRUE(log.OpenForWrite(kTestFilename, &err));
+    ASSERT_EQ("", err);
+
+    vector<Node*> deps;
+    deps.push_back(state.GetNode("foo.h", 0));
+    for (int i = 0; i < 1200; ++i)
+      log.RecordDeps(state.GetNode("out.o", 0), i, deps);
+    log.RecordDeps(state.GetNode("other_out.o", 0), 1, deps);
+    log.RecordDeps(state.GetNode("dead.o", 0), 1, deps);
+    log.Close();
+
+    struct stat st;
+    ASSERT_EQ(0, stat(kTestFilename, &st));
+    file_size = (int)st.st_size;
+  }
+
+  {
+    State state;
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state, kManifest));
+    DepsLog log;
+    string err;
+    ASSERT_TRUE(log.Load(kTestFilename, &state, &err));
+    log.set_background_recompaction(true);
+    ASSERT_TRUE(log.OpenForWrite(kTestFilename, &err));
+    ASSERT_EQ("", err);
+    ASSERT_TRUE(log.recompacting_in_background());
+
+    Node* out = state.GetNode("out.o", 0);
+    vector<Node*> deps;
+    deps.push_back(state.GetNode("bar.h", 0));
+    ASSERT_TRUE(log.RecordDeps(out, 5000, deps));
+    log.Close();
+    ASSERT_FALSE(log.recompacting_in_background());
+
+    DepsLog::Deps* out_deps = log.GetDeps(out);
+    ASSERT_TRUE(out_deps);
+    ASSERT_EQ(5000, out_deps->mtime);
+    ASSERT_EQ("bar.h", out_deps->nodes[0]->path());
+    ASSERT_EQ(out, log.nodes()[out->id()]);
+    Node* other_out = state.GetNode("other_out.o", 0);
+    ASSERT_TRUE(log.GetDeps(other_out));
+    ASSERT_EQ(other_out, log.nodes()[other_out->id()]);
+    ASSERT_FALSE(log.GetDeps(state.GetNode("dead.o", 0)));
+    ASSERT_EQ(-1, state.GetNode("dead.o", 0)->id());
+  }
+
+  {
+    State state;
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state, kManifest));
+    DepsLog log;
+    string err;
+    ASSERT_TRUE(log.Load(kTestFilename, &state, &err));
+    ASSERT_EQ("", err);
+
+    DepsLog::Deps* deps = log.GetDeps(state.GetNode("out.o", 0));
+    ASSERT_TRUE(deps);
+    ASSERT_EQ(5000, deps->mtime);
+    ASSERT_EQ(1, deps->node_count);
+    ASSERT_EQ("bar.h", deps->nodes[0]->path());
+    ASSERT_TRUE(log.GetDeps(state.GetNode("other_out.o", 0)));
+    ASSERT_FALSE(log.GetDeps(state.GetNode("dead.o", 0)));
+
+    struct stat st;
+    ASSERT_EQ(0, stat(kTestFilename, &st));
+    ASSERT_LT((int)st.st_size, file_size);
+  }
+}
+
 // Verify that invalid file headers cause a new build.
 TEST_F(DepsLogTest, InvalidHeader) {
   const char *kInvalidHeaders[] = {
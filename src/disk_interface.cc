@@ -26,13 +26,14 @@
 #include <sstream>
 #include <windows.h>
 #include <direct.h>  // _mkdir
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include "metrics.h"
 #include "util.h"
 
-namespace {
-
 string DirName(const string& path) {
 #ifdef _WIN32
   static const char kPathSeparators[] = "\\/";
@@ -50,6 +51,8 @@ string DirName(const string& path) {
   return path.substr(0, slash_pos);
 }
 
+namespace {
+
 int MakeDir(const string& path) {
 #ifdef _WIN32
   return _mkdir(path.c_str());
@@ -147,6 +150,12 @@ bool DiskInterface::MakeDirs(const string& path) {
   return MakeDir(dir);
 }
 
+void DiskInterface::RemoveFiles(const string& dir, const vector<string>& paths,
+                                vector<int>* results, vector<string>* errors) {
+  for (size_t i = 0; i < paths.size(); ++i)
+    (*results)[i] = RemoveFile(paths[i]);
+}
+
 // RealDiskInterface -----------------------------------------------------------
 
 TimeStamp RealDiskInterface::Stat(const string& path, string* err) const {
@@ -197,6 +206,20 @@ TimeStamp RealDiskInterface::Stat(const string& path, string* err) const {
 #endif
 }
 
+int64_t RealDiskInterface::FileSize(const string& path) const {
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA attrs;
+  if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &attrs))
+    return -1;
+  return ((int64_t)attrs.nFileSizeHigh << 32) | attrs.nFileSizeLow;
+#else
+  struct stat st;
+  if (lstat(path.c_str(), &st) < 0)
+    return -1;
+  return st.st_size;
+#endif
+}
+
 bool RealDiskInterface::WriteFile(const string& path, const string& contents) {
   FILE* fp = fopen(path.c_str(), "w");
   if (fp == NULL) {
@@ -256,6 +279,50 @@ int RealDiskInterface::RemoveFile(const string& path) {
   }
 }
 
+void RealDiskInterface::RemoveFiles(const string& dir,
+                                    const vector<string>& paths,
+                                    vector<int>* results,
+                                    vector<string>* errors) {
+#ifdef _WIN32
+  DiskInterface::RemoveFiles(dir, paths, results, errors);
+#else
+  // Removing by name relative to the open directory saves looking up the
+  // directory again for every file, which is slow on network filesystems.
+  int dir_fd = open(dir.empty() ? "." : dir.c_str(),
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  for (size_t i = 0; i < paths.size(); ++i) {
+    const string& path = paths[i];
+    int at_fd = AT_FDCWD;
+    const char* name = path.c_str();
+    if (dir_fd >= 0 && path.find('/', dir.empty() ? 0 : dir.size() + 1) ==
+                           string::npos &&
+        (dir.empty() ||
+         (path.compare(0, dir.size(), dir) == 0 && path[dir.size()] == '/'))) {
+      at_fd = dir_fd;
+      name += dir.empty() ? 0 : dir.size() + 1;
+    }
+    // Like remove(), take empty directories too.
+    int result = unlinkat(at_fd, name, 0);
+    if (result < 0 && (errno == EISDIR || errno == EPERM)) {
+      int unlink_errno = errno;
+      result = unlinkat(at_fd, name, AT_REMOVEDIR);
+      if (result < 0 && errno == ENOTDIR)
+        errno = unlink_errno;
+    }
+    if (result == 0) {
+      (*results)[i] = 0;
+    } else if (errno == ENOENT) {
+      (*results)[i] = 1;
+    } else {
+      (*results)[i] = -1;
+      (*errors)[i] = "remove(" + path + "): " + strerror(errno);
+    }
+  }
+  if (dir_fd >= 0)
+    close(dir_fd);
+#endif
+}
+
 void RealDiskInterface::AllowStatCache(bool allow) {
 #ifdef _WIN32
   use_cache_ = allow;
@@ -17,9 +17,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 using namespace std;
 
 #include "timestamp.h"
+#include "util.h"  // int64_t
 
 /// Interface for reading files from disk.  See DiskInterface for details.
 /// This base offers the minimum interface needed just to read files.
@@ -39,6 +41,10 @@ struct FileReader {
                           string* err) = 0;
 };
 
+/// Return the directory part of \a path without trailing separators, or
+/// the empty string if \a path has none.
+string DirName(const string& path);
+
 /// Interface for accessing the disk.
 ///
 /// Abstract so it can be mocked out for tests.  The real implementation
@@ -48,7 +54,12 @@ struct DiskInterface: public FileReader {
   /// other errors.
   virtual TimeStamp Stat(const string& path, string* err) const = 0;
 
-  /// Create a directory, returning false on failure.
+  /// The size of the file at \a path in bytes, or -1 if it is missing or
+  /// can't be stat()ed.  Can be called from several threads at once.
+  virtual int64_t FileSize(const string& path) const { return -1; }
+
+  /// Create a directory, returning false on failure.  Existing directories
+  /// count as success.  Can be called from several threads at once.
   virtual bool MakeDir(const string& path) = 0;
 
   /// Create a file, with the specified name and contents
@@ -62,6 +73,14 @@ struct DiskInterface: public FileReader {
   ///          -1 if an error occurs.
   virtual int RemoveFile(const string& path) = 0;
 
+  /// Remove the files \a paths, all in the directory \a dir, setting
+  /// (*results)[i] as RemoveFile() would return it for paths[i], and
+  /// on error, (*errors)[i] to the message.  The vectors must be as long as
+  /// \a paths.  Can be called from several threads at once if RemoveFile()
+  /// can.
+  virtual void RemoveFiles(const string& dir, const vector<string>& paths,
+                           vector<int>* results, vector<string>* errors);
+
   /// Create all the parent directories for path; like mkdir -p
   /// `basename path`.
   bool MakeDirs(const string& path);
@@ -76,10 +95,13 @@ struct RealDiskInterface : public DiskInterface {
                       {}
   virtual ~RealDiskInterface() {}
   virtual TimeStamp Stat(const string& path, string* err) const;
+  virtual int64_t FileSize(const string& path) const;
   virtual bool MakeDir(const string& path);
   virtual bool WriteFile(const string& path, const string& contents);
   virtual Status ReadFile(const string& path, string* contents, string* err);
   virtual int RemoveFile(const string& path);
+  virtual void RemoveFiles(const string& dir, const vector<string>& paths,
+                           vector<int>* results, vector<string>* errors);
 
   /// Whether stat information can be cached.  Only has an effect on Windows.
   void AllowStatCache(bool allow);
@@ -200,6 +200,46 @@ TEST_F(DiskInterfaceTest, RemoveFile) {
   EXPECT_EQ(1, disk_.RemoveFile("does not exist"));
 }
 
+#ifndef _WIN32
+TEST_F(DiskInterfaceTest, RemoveFiles) {
+  ASSERT_TRUE(disk_.MakeDir("dir"));
+  ASSERT_TRUE(disk_.MakeDir("dir/empty"));
+  ASSERT_TRUE(disk_.MakeDir("dir/full"));
+  ASSERT_TRUE(Touch("dir/a"));
+  ASSERT_TRUE(Touch("dir/full/b"));
+  ASSERT_TRUE(Touch("c"));
+
+  vector<string> paths;
+  paths.push_back("dir/a");
+  paths.push_back("dir/missing");
+  paths.push_back("dir/empty");
+  paths.push_back("dir/full");
+  // Not in dir after all; removed by its whole path.
+  paths.push_back("c");
+  vector<int> results(paths.size());
+  vector<string> errors(paths.size());
+  disk_.RemoveFiles("dir", paths, &results, &errors);
+  EXPECT_EQ(0, results[0]);
+  EXPECT_EQ(1, results[1]);
+  EXPECT_EQ(0, results[2]);
+  EXPECT_EQ(-1, results[3]);
+  EXPECT_EQ(0u, errors[3].find("remove(dir/full): "));
+  EXPECT_EQ(0, results[4]);
+  EXPECT_EQ("", errors[0] + errors[1] + errors[2] + errors[4]);
+
+  string err;
+  EXPECT_EQ(0, disk_.Stat("dir/a", &err));
+  EXPECT_EQ(0, disk_.Stat("dir/empty", &err));
+  EXPECT_EQ(0, disk_.Stat("c", &err));
+  EXPECT_LT(0, disk_.Stat("dir/full/b", &err));
+
+  // A directory that is gone holds nothing to remove.
+  paths.assign(1, "gone/d");
+  disk_.RemoveFiles("gone", paths, &results, &errors);
+  EXPECT_EQ(1, results[0]);
+}
+#endif
+
 struct StatTest : public StateTestWithBuiltinRules,
                   public DiskInterface {
   StatTest() : scan_(&state_, NULL, NULL, this) {}
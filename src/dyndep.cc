@@ -0,0 +1,108 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "dyndep.h"
+
+#include "debug_flags.h"
+#include "disk_interface.h"
+#include "dyndep_parser.h"
+#include "graph.h"
+#include "state.h"
+#include "util.h"
+
+bool DyndepLoader::LoadDyndeps(Node* node, string* err) const {
+  DyndepFile ddf;
+  return LoadDyndeps(node, &ddf, err);
+}
+
+bool DyndepLoader::LoadDyndeps(Node* node, DyndepFile* ddf,
+                               string* err) const {
+  // Whatever happens, the file has been dealt with.
+  node->set_dyndep_pending(false);
+
+  EXPLAIN("loading dyndep file '%s'", node->path().c_str());
+  if (!LoadDyndepFile(node, ddf, err))
+    return false;
+
+  // Every edge that names the file must be in it.
+  for (vector<Edge*>::const_iterator oe = node->out_edges().begin();
+       oe != node->out_edges().end(); ++oe) {
+    Edge* edge = *oe;
+    if (edge->dyndep_ != node)
+      continue;
+    DyndepFile::iterator ddi = ddf->find(edge);
+    if (ddi == ddf->end()) {
+      *err = "'" + edge->outputs_[0]->path() + "' "
+             "not mentioned in its dyndep file "
+             "'" + node->path() + "'";
+      return false;
+    }
+    ddi->second.used_ = true;
+    if (!UpdateEdge(edge, &ddi->second, err))
+      return false;
+  }
+
+  // And the file may only speak for those edges.
+  for (DyndepFile::const_iterator i = ddf->begin(); i != ddf->end(); ++i) {
+    if (!i->second.used_) {
+      *err = "dyndep file '" + node->path() + "' mentions output "
+             "'" + i->first->outputs_[0]->path() + "' whose build statement "
+             "does not have a dyndep binding for the file";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DyndepLoader::UpdateEdge(Edge* edge, const Dyndeps* dyndeps,
+                              string* err) const {
+  // The parser gave every edge with a dyndep binding its own scope.
+  if (dyndeps->restat_)
+    edge->env_->AddBinding("restat", "1");
+
+  edge->outputs_.insert(edge->outputs_.end(),
+                        dyndeps->implicit_outputs_.begin(),
+                        dyndeps->implicit_outputs_.end());
+  edge->implicit_outs_ += dyndeps->implicit_outputs_.size();
+  for (vector<Node*>::const_iterator i = dyndeps->implicit_outputs_.begin();
+       i != dyndeps->implicit_outputs_.end(); ++i) {
+    if (Edge* old_in_edge = (*i)->in_edge()) {
+      // A depfile may have named the output before anything said which
+      // edge makes it; the phony edge made up for it can go.
+      if (!old_in_edge->generated_by_dep_loader_) {
+        *err = "multiple rules generate " + (*i)->path();
+        return false;
+      }
+      old_in_edge->outputs_.clear();
+    }
+    (*i)->set_in_edge(edge);
+  }
+
+  edge->inputs_.insert(edge->inputs_.end() - edge->order_only_deps_,
+                       dyndeps->implicit_inputs_.begin(),
+                       dyndeps->implicit_inputs_.end());
+  edge->implicit_deps_ += dyndeps->implicit_inputs_.size();
+  for (vector<Node*>::const_iterator i = dyndeps->implicit_inputs_.begin();
+       i != dyndeps->implicit_inputs_.end(); ++i) {
+    (*i)->AddOutEdge(edge);
+  }
+  return true;
+}
+
+bool DyndepLoader::LoadDyndepFile(Node* node, DyndepFile* ddf,
+                                  string* err) const {
+  DyndepParser parser(state_, disk_interface_, ddf);
+  return parser.Load(node->path(), err);
+}
@@ -0,0 +1,65 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NINJA_DYNDEP_H_
+#define NINJA_DYNDEP_H_
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+struct DiskInterface;
+struct Edge;
+struct Node;
+struct State;
+
+/// What a dyndep file says about one edge: inputs and outputs that only
+/// became known once the file was built.
+struct Dyndeps {
+  Dyndeps() : used_(false), restat_(false) {}
+  /// Whether an edge with a dyndep binding for the file asked for these.
+  bool used_;
+  bool restat_;
+  vector<Node*> implicit_inputs_;
+  vector<Node*> implicit_outputs_;
+};
+
+/// The contents of a dyndep file, by the edge each statement is for.
+typedef map<Edge*, Dyndeps> DyndepFile;
+
+/// DyndepLoader loads the files named by "dyndep" bindings, and adds what
+/// they say to the edges that name them.
+struct DyndepLoader {
+  DyndepLoader(State* state, DiskInterface* disk_interface)
+      : state_(state), disk_interface_(disk_interface) {}
+
+  /// Load the dyndep file \a node and update the edges that name it.
+  /// @return false on error.
+  bool LoadDyndeps(Node* node, string* err) const;
+
+  /// Like LoadDyndeps(node, err), also filling \a ddf with what the file
+  /// says, so that a plan can pick up the new dependencies.
+  bool LoadDyndeps(Node* node, DyndepFile* ddf, string* err) const;
+
+ private:
+  bool LoadDyndepFile(Node* node, DyndepFile* ddf, string* err) const;
+  bool UpdateEdge(Edge* edge, const Dyndeps* dyndeps, string* err) const;
+
+  State* state_;
+  DiskInterface* disk_interface_;
+};
+
+#endif  // NINJA_DYNDEP_H_
@@ -0,0 +1,73 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NINJA_DYNDEP_PARSER_H_
+#define NINJA_DYNDEP_PARSER_H_
+
+#include <string>
+using namespace std;
+
+#include "dyndep.h"
+#include "eval_env.h"
+#include "lexer.h"
+#include "util.h"  // uint64_t
+
+struct FileReader;
+struct State;
+
+/// Parses dyndep files, which use a subset of the .ninja syntax:
+///
+///   ninja_dyndep_version = 1
+///   build out | implicit outputs: dyndep | implicit inputs
+///     restat = 1
+///
+/// Every statement is for an edge that already exists in \a state.
+struct DyndepParser {
+  DyndepParser(State* state, FileReader* file_reader, DyndepFile* dyndep_file)
+      : state_(state), file_reader_(file_reader), dyndep_file_(dyndep_file) {}
+
+  /// Load and parse a file.
+  bool Load(const string& filename, string* err);
+
+  /// Parse a text string of input.  Used by tests.
+  bool ParseTest(const string& input, string* err) {
+    return Parse("input", input, err);
+  }
+
+private:
+  /// Parse a file, given its contents as a string.
+  bool Parse(const string& filename, const string& input, string* err);
+
+  bool ParseDyndepVersion(string* err);
+  bool ParseLet(string* key, EvalString* val, string* err);
+  bool ParseEdge(string* err);
+
+  /// Evaluate and canonicalize \a path, which may not be empty.
+  bool EvaluatePath(const EvalString& path, string* result,
+                    uint64_t* slash_bits, string* err);
+
+  /// If the next token is not \a expected, produce an error string
+  /// saying "expected foo, got bar".
+  bool ExpectToken(Lexer::Token expected, string* err);
+
+  State* state_;
+  FileReader* file_reader_;
+  DyndepFile* dyndep_file_;
+  /// Dyndep files have no variables of their own; this stays empty.
+  BindingEnv env_;
+  Lexer lexer_;
+};
+
+#endif  // NINJA_DYNDEP_PARSER_H_
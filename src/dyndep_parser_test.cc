@@ -0,0 +1,141 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "dyndep_parser.h"
+
+#include <map>
+#include <vector>
+
+#include "dyndep.h"
+#include "graph.h"
+#include "state.h"
+#include "test.h"
+
+struct DyndepParserTest : public testing::Test {
+  void AssertParse(const char* input) {
+    DyndepParser parser(&state_, &fs_, &dyndep_file_);
+    string err;
+    EXPECT_TRUE(parser.ParseTest(input, &err));
+    ASSERT_EQ("", err);
+  }
+
+  /// Parse \a input, which should fail, and return the error.
+  string ParseError(const char* input) {
+    DyndepParser parser(&state_, &fs_, &dyndep_file_);
+    string err;
+    EXPECT_FALSE(parser.ParseTest(input, &err));
+    return err;
+  }
+
+  virtual void SetUp() {
+    ::AssertParse(&state_,
+"rule touch\n"
+"  command = touch $out\n"
+"build out otherout: touch\n");
+  }
+
+  State state_;
+  VirtualFileSystem fs_;
+  DyndepFile dyndep_file_;
+};
+
+TEST_F(DyndepParserTest, Empty) {
+  EXPECT_EQ("input:1: expected 'ninja_dyndep_version = ...'\n",
+            ParseError(""));
+}
+
+TEST_F(DyndepParserTest, Version) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse("ninja_dyndep_version = 1\n"));
+  ASSERT_NO_FATAL_FAILURE(AssertParse("ninja_dyndep_version = 1.0\n"));
+  EXPECT_EQ(0u, dyndep_file_.size());
+}
+
+TEST_F(DyndepParserTest, UnsupportedVersion) {
+  EXPECT_EQ("input:1: unsupported 'ninja_dyndep_version = 2'\n"
+            "ninja_dyndep_version = 2\n"
+            "                        ^ near here",
+            ParseError("ninja_dyndep_version = 2\n"));
+}
+
+TEST_F(DyndepParserTest, VersionFirst) {
+  EXPECT_EQ("input:1: expected 'ninja_dyndep_version = ...'\n",
+            ParseError("build out: dyndep\n"));
+  EXPECT_EQ("input:2: unexpected identifier\n",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "x = y\n"));
+}
+
+TEST_F(DyndepParserTest, Statement) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(
+"ninja_dyndep_version = 1\n"
+"build out | out.imp: dyndep | in.imp in2.imp\n"
+"  restat = 1\n"));
+  ASSERT_EQ(1u, dyndep_file_.size());
+  DyndepFile::iterator i = dyndep_file_.find(state_.edges_[0]);
+  ASSERT_NE(i, dyndep_file_.end());
+  EXPECT_TRUE(i->second.restat_);
+  ASSERT_EQ(1u, i->second.implicit_outputs_.size());
+  EXPECT_EQ("out.imp", i->second.implicit_outputs_[0]->path());
+  ASSERT_EQ(2u, i->second.implicit_inputs_.size());
+  EXPECT_EQ("in.imp", i->second.implicit_inputs_[0]->path());
+  EXPECT_EQ("in2.imp", i->second.implicit_inputs_[1]->path());
+}
+
+TEST_F(DyndepParserTest, OtherOutput) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(
+"ninja_dyndep_version = 1\n"
+"build ./otherout: dyndep\n"));
+  ASSERT_EQ(1u, dyndep_file_.size());
+  EXPECT_FALSE(dyndep_file_.begin()->second.restat_);
+}
+
+TEST_F(DyndepParserTest, Errors) {
+  EXPECT_EQ("input:2: no build statement exists for 'missing'\n"
+            "build missing: dyndep\n"
+            "             ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build missing: dyndep\n"));
+  EXPECT_EQ("input:2: explicit outputs not supported\n"
+            "build out otherout: dyndep\n"
+            "                  ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build out otherout: dyndep\n"));
+  dyndep_file_.clear();
+  EXPECT_EQ("input:2: expected build command name 'dyndep'\n"
+            "build out: touch\n"
+            "         ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build out: touch\n"));
+  dyndep_file_.clear();
+  EXPECT_EQ("input:2: order-only inputs not supported\n"
+            "build out: dyndep || in\n"
+            "                  ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build out: dyndep || in\n"));
+  dyndep_file_.clear();
+  EXPECT_EQ("input:3: binding is not 'restat'\n"
+            "  command = x\n"
+            "             ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build out: dyndep\n"
+                       "  command = x\n"));
+  dyndep_file_.clear();
+  EXPECT_EQ("input:3: multiple statements for 'out'\n"
+            "build out: dyndep\n"
+            "         ^ near here",
+            ParseError("ninja_dyndep_version = 1\n"
+                       "build out: dyndep\n"
+                       "build out: dyndep\n"));
+}
@@ -67,12 +67,17 @@ bool Rule::IsReservedBinding(const string& var) {
       var == "depfile" ||
       var == "description" ||
       var == "deps" ||
+      var == "dyndep" ||
       var == "generator" ||
       var == "pool" ||
+      var == "priority" ||
+      var == "resources" ||
       var == "restat" ||
       var == "rspfile" ||
       var == "rspfile_content" ||
-      var == "msvc_deps_prefix";
+      var == "msvc_deps_prefix" ||
+      var == "cgroup_cpu_max" ||
+      var == "cgroup_memory_max";
 }
 
 const map<string, const Rule*>& BindingEnv::GetRules() const {
@@ -31,13 +31,133 @@ bool Node::Stat(DiskInterface* disk_interface, string* err) {
   return (mtime_ = disk_interface->Stat(path_, err)) != -1;
 }
 
-bool DependencyScan::RecomputeDirty(Node* node, string* err) {
-  vector<Node*> stack;
-  return RecomputeDirty(node, &stack, err);
+/// An edge being visited by DependencyScan::RecomputeDirty, with how far
+/// the visit has got.  A visit on the stack waits for the node on top of it.
+struct DependencyScan::NodeVisit {
+  NodeVisit(Node* node)
+      : node(node), step(kDyndep), input(0), input_visited(false),
+        dirty(false), most_recent_input(NULL) {}
+
+  /// The output of the edge that the walk reached it by.
+  Node* node;
+  enum Step {
+    /// Visit the dyndep file, if the edge has one yet to be loaded.
+    kDyndep,
+    /// Load the dyndep file, the output mtimes and the deps.
+    kDeps,
+    /// Visit the inputs, one by one.
+    kInputs
+  } step;
+  /// The input to visit next, and whether that has been started already.
+  size_t input;
+  bool input_visited;
+  bool dirty;
+  Node* most_recent_input;
+};
+
+bool DependencyScan::RecomputeDirty(Node* initial_node, string* err) {
+  // Walk the graph with an explicit stack rather than recursing: chains of
+  // generated edges can be deeper than the call stack.
+  vector<NodeVisit> stack;
+  if (!VisitNode(initial_node, &stack, err))
+    return false;
+
+  while (!stack.empty()) {
+    // Don't keep references into |stack| across VisitNode(), which may
+    // reallocate it.
+    size_t depth = stack.size();
+    Edge* edge = stack.back().node->in_edge();
+
+    if (stack.back().step == NodeVisit::kDyndep) {
+      stack.back().step = NodeVisit::kDeps;
+      // A dyndep file that is there already says what else the edge reads
+      // and writes; load it before looking at those.  One that is yet to be
+      // built makes the edge dirty as any other input would, and the plan
+      // loads it once it is.
+      if (edge->dyndep_ && edge->dyndep_->dyndep_pending()) {
+        if (!VisitNode(edge->dyndep_, &stack, err))
+          return false;
+        if (stack.size() != depth)
+          continue;
+      }
+    }
+
+    if (stack.back().step == NodeVisit::kDeps) {
+      NodeVisit& visit = stack.back();
+      visit.step = NodeVisit::kInputs;
+      if (edge->dyndep_ && edge->dyndep_->dyndep_pending() &&
+          (!edge->dyndep_->in_edge() ||
+           edge->dyndep_->in_edge()->outputs_ready())) {
+        if (!LoadDyndeps(edge->dyndep_, err))
+          return false;
+      }
+
+      // Load output mtimes so we can compare them to the most recent input
+      // below.
+      for (vector<Node*>::iterator o = edge->outputs_.begin();
+           o != edge->outputs_.end(); ++o) {
+        if (!(*o)->StatIfNecessary(disk_interface_, err))
+          return false;
+      }
+
+      if (!dep_loader_.LoadDeps(edge, err)) {
+        if (!err->empty())
+          return false;
+        // Failed to load dependency info: rebuild to regenerate it.
+        // LoadDeps() did EXPLAIN() already, no need to do it here.
+        visit.dirty = edge->deps_missing_ = true;
+      }
+    }
+
+    // Visit all inputs; we're dirty if any of the inputs are dirty.
+    // Inputs are looked up by index, as loading a dyndep file further down
+    // may add to them.
+    bool waiting = false;
+    while (stack.back().input < edge->inputs_.size()) {
+      NodeVisit& visit = stack.back();
+      Node* input = edge->inputs_[visit.input];
+      if (!visit.input_visited) {
+        visit.input_visited = true;
+        if (!VisitNode(input, &stack, err))
+          return false;
+        if (stack.size() != depth) {
+          waiting = true;
+          break;
+        }
+      }
+
+      // If an input is not ready, neither are our outputs.
+      if (Edge* in_edge = input->in_edge()) {
+        if (!in_edge->outputs_ready_)
+          edge->outputs_ready_ = false;
+      }
+
+      if (!edge->is_order_only(visit.input)) {
+        // If a regular input is dirty (or missing), we're dirty.
+        // Otherwise consider mtime.
+        if (input->dirty()) {
+          EXPLAIN("%s is dirty", input->path().c_str());
+          visit.dirty = true;
+        } else if (!visit.most_recent_input ||
+                   input->mtime() > visit.most_recent_input->mtime()) {
+          visit.most_recent_input = input;
+        }
+      }
+      visit.input_visited = false;
+      ++visit.input;
+    }
+    if (waiting)
+      continue;
+
+    if (!FinishEdge(&stack.back(), err))
+      return false;
+    stack.pop_back();
+  }
+  return true;
 }
 
-bool DependencyScan::RecomputeDirty(Node* node, vector<Node*>* stack,
-                                    string* err) {
+bool DependencyScan::VisitNode(Node* node, vector<NodeVisit>* stack,
+                               string* err) {
   Edge* edge = node->in_edge();
   if (!edge) {
     // If we already visited this leaf node then we are done.
@@ -56,65 +176,26 @@ bool DependencyScan::RecomputeDirty(Node* node, vector<Node*>* stack,
   if (edge->mark_ == Edge::VisitDone)
     return true;
 
-  // If we encountered this edge earlier in the call stack we have a cycle.
+  // If we encountered this edge earlier in the walk we have a cycle.
   if (!VerifyDAG(node, stack, err))
     return false;
 
-  // Mark the edge temporarily while in the call stack.
+  // Mark the edge temporarily while it is on the stack.
   edge->mark_ = Edge::VisitInStack;
-  stack->push_back(node);
-
-  bool dirty = false;
+  stack->push_back(NodeVisit(node));
   edge->outputs_ready_ = true;
   edge->deps_missing_ = false;
+  return true;
+}
 
-  // Load output mtimes so we can compare them to the most recent input below.
-  for (vector<Node*>::iterator o = edge->outputs_.begin();
-       o != edge->outputs_.end(); ++o) {
-    if (!(*o)->StatIfNecessary(disk_interface_, err))
-      return false;
-  }
-
-  if (!dep_loader_.LoadDeps(edge, err)) {
-    if (!err->empty())
-      return false;
-    // Failed to load dependency info: rebuild to regenerate it.
-    // LoadDeps() did EXPLAIN() already, no need to do it here.
-    dirty = edge->deps_missing_ = true;
-  }
-
-  // Visit all inputs; we're dirty if any of the inputs are dirty.
-  Node* most_recent_input = NULL;
-  for (vector<Node*>::iterator i = edge->inputs_.begin();
-       i != edge->inputs_.end(); ++i) {
-    // Visit this input.
-    if (!RecomputeDirty(*i, stack, err))
-      return false;
-
-    // If an input is not ready, neither are our outputs.
-    if (Edge* in_edge = (*i)->in_edge()) {
-      if (!in_edge->outputs_ready_)
-        edge->outputs_ready_ = false;
-    }
-
-    if (!edge->is_order_only(i - edge->inputs_.begin())) {
-      // If a regular input is dirty (or missing), we're dirty.
-      // Otherwise consider mtime.
-      if ((*i)->dirty()) {
-        EXPLAIN("%s is dirty", (*i)->path().c_str());
-        dirty = true;
-      } else {
-        if (!most_recent_input || (*i)->mtime() > most_recent_input->mtime()) {
-          most_recent_input = *i;
-        }
-      }
-    }
-  }
+bool DependencyScan::FinishEdge(NodeVisit* visit, string* err) {
+  Edge* edge = visit->node->in_edge();
+  bool dirty = visit->dirty;
 
   // We may also be dirty due to output state: missing outputs, out of
   // date outputs, etc.  Visit all outputs and determine whether they're dirty.
   if (!dirty)
-    if (!RecomputeOutputsDirty(edge, most_recent_input, &dirty, err))
+    if (!RecomputeOutputsDirty(edge, visit->most_recent_input, &dirty, err))
       return false;
 
   // Finally, visit each output and update their dirty state if necessary.
@@ -133,25 +214,25 @@ bool DependencyScan::RecomputeDirty(Node* node, vector<Node*>* stack,
     edge->outputs_ready_ = false;
 
   // Mark the edge as finished during this walk now that it will no longer
-  // be in the call stack.
+  // be on the stack.
   edge->mark_ = Edge::VisitDone;
-  assert(stack->back() == node);
-  stack->pop_back();
-
   return true;
 }
 
-bool DependencyScan::VerifyDAG(Node* node, vector<Node*>* stack, string* err) {
+bool DependencyScan::VerifyDAG(Node* node, vector<NodeVisit>* stack,
+                               string* err) {
   Edge* edge = node->in_edge();
   assert(edge != NULL);
 
   // If we have no temporary mark on the edge then we do not yet have a cycle.
+  // This is all a walk without cycles ever checks; the stack is only
+  // searched to report the cycle.
   if (edge->mark_ != Edge::VisitInStack)
     return true;
 
-  // We have this edge earlier in the call stack.  Find it.
-  vector<Node*>::iterator start = stack->begin();
-  while (start != stack->end() && (*start)->in_edge() != edge)
+  // We have this edge earlier on the stack.  Find it.
+  vector<NodeVisit>::iterator start = stack->begin();
+  while (start != stack->end() && start->node->in_edge() != edge)
     ++start;
   assert(start != stack->end());
 
@@ -161,15 +242,15 @@ bool DependencyScan::VerifyDAG(Node* node, vector<Node*>* stack, string* err) {
   //   build a b: cat c
   //   build c: cat a
   // should report a -> c -> a instead of b -> c -> a.
-  *start = node;
+  start->node = node;
 
   // Construct the error message rejecting the cycle.
   *err = "dependency cycle: ";
-  for (vector<Node*>::const_iterator i = start; i != stack->end(); ++i) {
-    err->append((*i)->path());
+  for (vector<NodeVisit>::const_iterator i = start; i != stack->end(); ++i) {
+    err->append(i->node->path());
     err->append(" -> ");
   }
-  err->append((*start)->path());
+  err->append(start->node->path());
 
   if ((start + 1) == stack->end() && edge->maybe_phonycycle_diagnostic()) {
     // The manifest parser would have filtered out the self-referencing
@@ -180,6 +261,15 @@ bool DependencyScan::VerifyDAG(Node* node, vector<Node*>* stack, string* err) {
   return false;
 }
 
+bool DependencyScan::LoadDyndeps(Node* node, string* err) const {
+  return dyndep_loader_.LoadDyndeps(node, err);
+}
+
+bool DependencyScan::LoadDyndeps(Node* node, DyndepFile* ddf,
+                                 string* err) const {
+  return dyndep_loader_.LoadDyndeps(node, ddf, err);
+}
+
 bool DependencyScan::RecomputeOutputsDirty(Edge* edge, Node* most_recent_input,
                                            bool* outputs_dirty, string* err) {
   string command = edge->EvaluateCommand(/*incl_rsp_file=*/true);
@@ -272,15 +362,6 @@ bool DependencyScan::RecomputeOutputDirty(Edge* edge,
   return false;
 }
 
-bool Edge::AllInputsReady() const {
-  for (vector<Node*>::const_iterator i = inputs_.begin();
-       i != inputs_.end(); ++i) {
-    if ((*i)->in_edge() && !(*i)->in_edge()->outputs_ready())
-      return false;
-  }
-  return true;
-}
-
 /// An Env for an Edge, providing $in and $out.
 struct EdgeEnv : public Env {
   enum EscapeKind { kShellEscape, kDoNotEscape };
@@ -394,6 +475,11 @@ string Edge::GetUnescapedRspfile() {
   return env.LookupVariable("rspfile");
 }
 
+string Edge::GetUnescapedDyndep() {
+  EdgeEnv env(this, EdgeEnv::kDoNotEscape);
+  return env.LookupVariable("dyndep");
+}
+
 void Edge::Dump(const char* prefix) const {
   printf("%s[ ", prefix);
   for (vector<Node*>::const_iterator i = inputs_.begin();
@@ -582,6 +668,7 @@ void ImplicitDepLoader::CreatePhonyInEdge(Node* node) {
     return;
 
   Edge* phony_edge = state_->AddEdge(&State::kPhonyRule);
+  phony_edge->generated_by_dep_loader_ = true;
   node->set_in_edge(phony_edge);
   phony_edge->outputs_.push_back(node);
 
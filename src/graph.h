@@ -20,6 +20,7 @@
 #include <vector>
 using namespace std;
 
+#include "dyndep.h"
 #include "eval_env.h"
 #include "timestamp.h"
 #include "util.h"
@@ -40,6 +41,7 @@ struct Node {
         slash_bits_(slash_bits),
         mtime_(-1),
         dirty_(false),
+        dyndep_pending_(false),
         in_edge_(NULL),
         id_(-1) {}
 
@@ -87,6 +89,9 @@ struct Node {
   void set_dirty(bool dirty) { dirty_ = dirty; }
   void MarkDirty() { dirty_ = true; }
 
+  bool dyndep_pending() const { return dyndep_pending_; }
+  void set_dyndep_pending(bool pending) { dyndep_pending_ = pending; }
+
   Edge* in_edge() const { return in_edge_; }
   void set_in_edge(Edge* edge) { in_edge_ = edge; }
 
@@ -95,6 +100,7 @@ struct Node {
 
   const vector<Edge*>& out_edges() const { return out_edges_; }
   void AddOutEdge(Edge* edge) { out_edges_.push_back(edge); }
+  void ClearOutEdges() { out_edges_.clear(); }
 
   void Dump(const char* prefix="") const;
 
@@ -116,6 +122,10 @@ private:
   /// edges to build.
   bool dirty_;
 
+  /// Whether this is a dyndep file that some edge names and that hasn't
+  /// been loaded yet.
+  bool dyndep_pending_;
+
   /// The Edge that produces this Node, or NULL when there is no
   /// known edge to produce it.
   Edge* in_edge_;
@@ -135,13 +145,13 @@ struct Edge {
     VisitDone
   };
 
-  Edge() : rule_(NULL), pool_(NULL), weight_(1), env_(NULL), mark_(VisitNone), id_(0),
-           outputs_ready_(false), deps_missing_(false),
+  Edge() : rule_(NULL), pool_(NULL), weight_(1), priority_(0),
+           critical_time_(0), dyndep_(NULL), env_(NULL), mark_(VisitNone),
+           id_(0), pending_inputs_(0), outputs_ready_(false),
+           deps_missing_(false), delayed_(false),
+           generated_by_dep_loader_(false),
            implicit_deps_(0), order_only_deps_(0), implicit_outs_(0) {}
 
-  /// Return true if all inputs' in-edges are ready.
-  bool AllInputsReady() const;
-
   /// Expand all variables in a command and return it as a string.
   /// If incl_rsp_file is enabled, the string will also contain the
   /// full contents of a response file (if applicable)
@@ -155,19 +165,39 @@ struct Edge {
   string GetUnescapedDepfile();
   /// Like GetBinding("rspfile"), but without shell escaping.
   string GetUnescapedRspfile();
+  /// Like GetBinding("dyndep"), but without shell escaping.
+  string GetUnescapedDyndep();
 
   void Dump(const char* prefix="") const;
 
   const Rule* rule_;
   Pool* pool_;
   int weight_;
+  /// How much of each of its pool's resources the edge uses; empty if none.
+  vector<int> resources_;
+  /// Edges with a higher priority leave their pool's queue first.
+  int priority_;
+  /// The expected time, in milliseconds, from starting this edge to the end
+  /// of the longest chain of wanted edges that depend on it.  Among edges of
+  /// the same priority, those with more left to do leave the queue first.
+  int64_t critical_time_;
+  /// The dyndep file, one of the inputs, that adds to the edge's inputs
+  /// and outputs once it is built; NULL if none.
+  Node* dyndep_;
   vector<Node*> inputs_;
   vector<Node*> outputs_;
   BindingEnv* env_;
   VisitMark mark_;
   size_t id_;
+  /// The inputs, counted once for each time they are listed, whose in-edges
+  /// the plan is yet to finish.  The edge is ready to run at zero.
+  int pending_inputs_;
   bool outputs_ready_;
   bool deps_missing_;
+  /// Whether the edge waits in its pool's queue.
+  bool delayed_;
+  /// Whether ImplicitDepLoader made the edge up for a file a depfile named.
+  bool generated_by_dep_loader_;
 
   const Rule& rule() const { return *rule_; }
   Pool* pool() const { return pool_; }
@@ -262,7 +292,8 @@ struct DependencyScan {
                  DiskInterface* disk_interface)
       : build_log_(build_log),
         disk_interface_(disk_interface),
-        dep_loader_(state, deps_log, disk_interface) {}
+        dep_loader_(state, deps_log, disk_interface),
+        dyndep_loader_(state, disk_interface) {}
 
   /// Update the |dirty_| state of the given node by inspecting its input edge.
   /// Examine inputs, outputs, and command lines to judge whether an edge
@@ -287,9 +318,19 @@ struct DependencyScan {
     return dep_loader_.deps_log();
   }
 
+  /// Load the dyndep file \a node, adding what it says to the edges that
+  /// name it, and to \a ddf if given.  Returns false on failure.
+  bool LoadDyndeps(Node* node, string* err) const;
+  bool LoadDyndeps(Node* node, DyndepFile* ddf, string* err) const;
+
  private:
-  bool RecomputeDirty(Node* node, vector<Node*>* stack, string* err);
-  bool VerifyDAG(Node* node, vector<Node*>* stack, string* err);
+  struct NodeVisit;
+  /// Start visiting \a node, pushing its in-edge on \a stack unless it has
+  /// none or was visited already.
+  bool VisitNode(Node* node, vector<NodeVisit>* stack, string* err);
+  /// Work out whether the edge of \a visit is dirty now that its inputs are.
+  bool FinishEdge(NodeVisit* visit, string* err);
+  bool VerifyDAG(Node* node, vector<NodeVisit>* stack, string* err);
 
   /// Recompute whether a given single output should be marked dirty.
   /// Returns true if so.
@@ -299,6 +340,7 @@ struct DependencyScan {
   BuildLog* build_log_;
   DiskInterface* disk_interface_;
   ImplicitDepLoader dep_loader_;
+  DyndepLoader dyndep_loader_;
 };
 
 #endif  // NINJA_GRAPH_H_
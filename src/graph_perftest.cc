@@ -0,0 +1,113 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <stdio.h>
+
+#include "disk_interface.h"
+#include "graph.h"
+#include "state.h"
+#include "util.h"
+#include "metrics.h"
+
+/// Every source exists, every output is missing; nothing touches the disk.
+struct SourcesOnlyDiskInterface : public DiskInterface {
+  virtual TimeStamp Stat(const string& path, string* err) const {
+    return path.compare(0, 3, "src") == 0 ? 1 : 0;
+  }
+  virtual bool MakeDir(const string& path) { return true; }
+  virtual bool WriteFile(const string& path, const string& contents) {
+    return true;
+  }
+  virtual int RemoveFile(const string& path) { return 1; }
+  virtual Status ReadFile(const string& path, string* contents, string* err) {
+    return NotFound;
+  }
+};
+
+/// A chain of \a depth edges, each reading the output of the one before.
+Node* BuildDeepChain(State* state, int depth) {
+  char path[32];
+  for (int i = 0; i < depth; ++i) {
+    Edge* edge = state->AddEdge(&State::kPhonyRule);
+    snprintf(path, sizeof(path), i == 0 ? "src" : "out%d", i);
+    state->AddIn(edge, path, 0);
+    snprintf(path, sizeof(path), "out%d", i + 1);
+    state->AddOut(edge, path, 0);
+  }
+  return state->LookupNode(path);
+}
+
+/// One target with \a width inputs, each built from its own source and all
+/// including the same header.
+Node* BuildWideFanout(State* state, int width) {
+  Edge* all = state->AddEdge(&State::kPhonyRule);
+  state->AddOut(all, "all", 0);
+  char path[32];
+  for (int i = 0; i < width; ++i) {
+    Edge* edge = state->AddEdge(&State::kPhonyRule);
+    snprintf(path, sizeof(path), "src%d", i);
+    state->AddIn(edge, path, 0);
+    state->AddIn(edge, "src.h", 0);
+    snprintf(path, sizeof(path), "out%d", i);
+    state->AddOut(edge, path, 0);
+    state->AddIn(all, path, 0);
+  }
+  return state->LookupNode("all");
+}
+
+/// Scan \a target a few times, printing how long it took.
+bool Measure(const char* name, State* state, Node* target) {
+  SourcesOnlyDiskInterface disk_interface;
+  DependencyScan scan(state, NULL, NULL, &disk_interface);
+
+  vector<int> times;
+  for (int j = 0; j < 5; ++j) {
+    state->Reset();
+    int64_t start = GetTimeMillis();
+    string err;
+    if (!scan.RecomputeDirty(target, &err)) {
+      fprintf(stderr, "%s: %s\n", name, err.c_str());
+      return false;
+    }
+    times.push_back((int)(GetTimeMillis() - start));
+  }
+
+  int min = times[0];
+  int max = times[0];
+  float total = 0;
+  for (size_t i = 0; i < times.size(); ++i) {
+    total += times[i];
+    if (times[i] < min)
+      min = times[i];
+    else if (times[i] > max)
+      max = times[i];
+  }
+  printf("%s: min %dms  max %dms  avg %.1fms\n",
+         name, min, max, total / times.size());
+  return true;
+}
+
+int main() {
+  const int kDepth = 1000000;
+  State chain;
+  if (!Measure("deep chain", &chain, BuildDeepChain(&chain, kDepth)))
+    return 1;
+
+  const int kWidth = 1000000;
+  State fanout;
+  if (!Measure("wide fanout", &fanout, BuildWideFanout(&fanout, kWidth)))
+    return 1;
+  return 0;
+}
@@ -347,6 +347,36 @@ TEST_F(GraphTest, DependencyCycle) {
   ASSERT_EQ("dependency cycle: out -> mid -> in -> pre -> out", err);
 }
 
+// The scan must not recurse once per level: generated chains can be
+// deeper than the call stack.
+TEST_F(GraphTest, DeepChain) {
+  const Rule* cat = state_.bindings_.LookupRule("cat");
+  const int kDepth = 200000;
+  char path[32];
+  for (int i = 0; i < kDepth; ++i) {
+    Edge* edge = state_.AddEdge(cat);
+    snprintf(path, sizeof(path), "out%d", i);
+    state_.AddIn(edge, i == 0 ? "in" : path, 0);
+    snprintf(path, sizeof(path), "out%d", i + 1);
+    state_.AddOut(edge, path, 0);
+  }
+  fs_.Create("in", "");
+
+  string err;
+  EXPECT_TRUE(scan_.RecomputeDirty(GetNode(path), &err));
+  ASSERT_EQ("", err);
+  EXPECT_TRUE(GetNode(path)->dirty());
+  EXPECT_FALSE(GetNode("in")->dirty());
+
+  // Closing the chain into a cycle is found at the same depth.
+  state_.Reset();
+  Edge* edge = state_.AddEdge(cat);
+  state_.AddIn(edge, path, 0);
+  state_.AddOut(edge, "in", 0);
+  EXPECT_FALSE(scan_.RecomputeDirty(GetNode(path), &err));
+  EXPECT_EQ(0u, err.find("dependency cycle: out200000 -> out199999 -> "));
+}
+
 TEST_F(GraphTest, CycleInEdgesButNotInNodes1) {
   string err;
   AssertParse(&state_,
@@ -14,67 +14,241 @@
 
 #include "graphviz.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <algorithm>
+#include <deque>
 
 #include "graph.h"
+#include "json.h"
+
+namespace {
+
+/// Output is collected and written in blocks of about this size.
+const size_t kFlushSize = 1 << 20;
+
+}  // anonymous namespace
+
+GraphViz::GraphViz(FILE* out)
+    : format_(kDot), max_depth_(-1), collapse_phony_(false), out_(out),
+      edge_count_(0) {}
 
 void GraphViz::AddTarget(Node* node) {
-  if (visited_nodes_.find(node) != visited_nodes_.end())
-    return;
+  set<Node*> seen;
+  vector<Input> targets;
+  ResolveInput(node, 0, &seen, &targets);
 
-  string pathstr = node->path();
-  replace(pathstr.begin(), pathstr.end(), '\\', '/');
-  printf("\"%p\" [label=\"%s\"]\n", node, pathstr.c_str());
-  visited_nodes_.insert(node);
+  // Nodes to visit, with the number of edges they are from a target.  It
+  // is used as a stack, except that with a depth limit the walk is breadth
+  // first, so a node is first found by its shortest path from the target.
+  bool breadth_first = max_depth_ >= 0;
+  deque<pair<Node*, int> > queue;
+  vector<pair<Node*, int> > next;
+  for (vector<Input>::iterator t = targets.begin(); t != targets.end(); ++t)
+    queue.push_back(make_pair(t->node, 0));
+  while (!queue.empty()) {
+    Node* node = queue.front().first;
+    int depth = queue.front().second;
+    queue.pop_front();
 
-  Edge* edge = node->in_edge();
+    // Only a depth limit gives a reason to visit a node again: found
+    // closer to this target than to an earlier one, it may reach further.
+    map<Node*, int>::iterator visited = visited_nodes_.find(node);
+    if (visited != visited_nodes_.end()) {
+      if (!breadth_first || visited->second <= depth)
+        continue;
+      visited->second = depth;
+    } else {
+      PrintNode(node);
+      visited_nodes_[node] = depth;
+    }
 
-  if (!edge) {
-    // Leaf node.
-    // Draw as a rect?
+    if (max_depth_ >= 0 && depth >= max_depth_)
+      continue;
+    Edge* edge = node->in_edge();
+    if (!edge || exclude_rules_.count(edge->rule_->name()) ||
+        (collapse_phony_ && edge->is_phony())) {
+      continue;
+    }
+
+    seen.clear();
+    vector<Input> inputs;
+    for (size_t i = 0; i < edge->inputs_.size(); ++i) {
+      int kind = edge->is_order_only(i) ? 2 : edge->is_implicit(i) ? 1 : 0;
+      ResolveInput(edge->inputs_[i], kind, &seen, &inputs);
+    }
+    if (visited_edges_.insert(edge).second)
+      PrintEdge(edge, inputs);
+    // Visit the inputs in order, as a recursive walk would.
+    next.clear();
+    for (vector<Input>::iterator in = inputs.begin(); in != inputs.end();
+         ++in) {
+      next.push_back(make_pair(in->node, depth + 1));
+    }
+    queue.insert(breadth_first ? queue.end() : queue.begin(), next.begin(),
+                 next.end());
+  }
+}
+
+bool GraphViz::Excluded(Node* node) const {
+  for (vector<string>::const_iterator p = exclude_paths_.begin();
+       p != exclude_paths_.end(); ++p) {
+    if (node->path().find(*p) != string::npos)
+      return true;
+  }
+  return false;
+}
+
+void GraphViz::ResolveInput(Node* node, int kind, set<Node*>* seen,
+                            vector<Input>* inputs) {
+  vector<Input> stack;
+  Input input = { node, kind };
+  stack.push_back(input);
+  while (!stack.empty()) {
+    input = stack.back();
+    stack.pop_back();
+    if (Excluded(input.node) || !seen->insert(input.node).second)
+      continue;
+    Edge* edge = input.node->in_edge();
+    // A phony edge without inputs names a file; keep it.
+    if (!collapse_phony_ || !edge || !edge->is_phony() ||
+        edge->inputs_.empty()) {
+      inputs->push_back(input);
+      continue;
+    }
+    for (size_t i = edge->inputs_.size(); i-- > 0; ) {
+      int kind = edge->is_order_only(i) ? 2 : edge->is_implicit(i) ? 1 : 0;
+      Input phony_input = { edge->inputs_[i], max(input.kind, kind) };
+      stack.push_back(phony_input);
+    }
+  }
+}
+
+void GraphViz::PrintNode(Node* node) {
+  if (format_ == kJSONLines) {
+    NodeId(node);
     return;
   }
+  string pathstr = node->path();
+  replace(pathstr.begin(), pathstr.end(), '\\', '/');
+  Print("\"%p\" [label=\"%s\"]\n", node, pathstr.c_str());
+}
+
+void GraphViz::PrintEdge(Edge* edge, const vector<Input>& inputs) {
+  if (format_ == kJSONLines) {
+    // Describe the nodes first, so the edge only refers back.
+    vector<int> outputs;
+    for (vector<Node*>::iterator out = edge->outputs_.begin();
+         out != edge->outputs_.end(); ++out) {
+      outputs.push_back(Excluded(*out) ? -1 : NodeId(*out));
+    }
+    vector<int> ids;
+    for (vector<Input>::const_iterator in = inputs.begin();
+         in != inputs.end(); ++in) {
+      ids.push_back(NodeId(in->node));
+    }
 
-  if (visited_edges_.find(edge) != visited_edges_.end())
+    string line;
+    AppendJSONString(edge->rule_->name(), &line);
+    Print("{\"edge\": %d, \"rule\": %s", edge_count_++, line.c_str());
+    const char* kKinds[] = { "inputs", "implicit", "order_only" };
+    for (int kind = 0; kind < 3; ++kind) {
+      line.clear();
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].kind != kind)
+          continue;
+        char id[16];
+        snprintf(id, sizeof(id), "%s%d", line.empty() ? "" : ", ", ids[i]);
+        line += id;
+      }
+      Print(", \"%s\": [%s]", kKinds[kind], line.c_str());
+    }
+    line.clear();
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (outputs[i] < 0)
+        continue;
+      char id[16];
+      snprintf(id, sizeof(id), "%s%d", line.empty() ? "" : ", ", outputs[i]);
+      line += id;
+    }
+    Print(", \"outputs\": [%s]}\n", line.c_str());
     return;
-  visited_edges_.insert(edge);
+  }
 
-  if (edge->inputs_.size() == 1 && edge->outputs_.size() == 1) {
+  if (edge->inputs_.size() == 1 && inputs.size() == 1 &&
+      edge->outputs_.size() == 1) {
     // Can draw simply.
     // Note extra space before label text -- this is cosmetic and feels
     // like a graphviz bug.
-    printf("\"%p\" -> \"%p\" [label=\" %s\"]\n",
-           edge->inputs_[0], edge->outputs_[0], edge->rule_->name().c_str());
+    Print("\"%p\" -> \"%p\" [label=\" %s\"]\n",
+          inputs[0].node, edge->outputs_[0], edge->rule_->name().c_str());
   } else {
-    printf("\"%p\" [label=\"%s\", shape=ellipse]\n",
-           edge, edge->rule_->name().c_str());
+    Print("\"%p\" [label=\"%s\", shape=ellipse]\n",
+          edge, edge->rule_->name().c_str());
     for (vector<Node*>::iterator out = edge->outputs_.begin();
          out != edge->outputs_.end(); ++out) {
-      printf("\"%p\" -> \"%p\"\n", edge, *out);
+      Print("\"%p\" -> \"%p\"\n", edge, *out);
     }
-    for (vector<Node*>::iterator in = edge->inputs_.begin();
-         in != edge->inputs_.end(); ++in) {
+    for (vector<Input>::const_iterator in = inputs.begin();
+         in != inputs.end(); ++in) {
       const char* order_only = "";
-      if (edge->is_order_only(in - edge->inputs_.begin()))
+      if (in->kind == 2)
         order_only = " style=dotted";
-      printf("\"%p\" -> \"%p\" [arrowhead=none%s]\n", (*in), edge, order_only);
+      Print("\"%p\" -> \"%p\" [arrowhead=none%s]\n", in->node, edge,
+            order_only);
     }
   }
+}
+
+int GraphViz::NodeId(Node* node) {
+  map<Node*, int>::iterator i = node_ids_.find(node);
+  if (i != node_ids_.end())
+    return i->second;
+  int id = node_ids_.size();
+  node_ids_[node] = id;
+  string path;
+  AppendJSONString(node->path(), &path);
+  Print("{\"node\": %d, \"path\": %s}\n", id, path.c_str());
+  return id;
+}
 
-  for (vector<Node*>::iterator in = edge->inputs_.begin();
-       in != edge->inputs_.end(); ++in) {
-    AddTarget(*in);
+void GraphViz::Print(const char* format, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, format);
+  int len = vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  if (len < (int)sizeof(buf)) {
+    buffer_.append(buf, len);
+  } else {
+    // Rare long paths and rule names.
+    size_t size = buffer_.size();
+    buffer_.resize(size + len + 1);
+    va_start(ap, format);
+    vsnprintf(&buffer_[size], len + 1, format, ap);
+    va_end(ap);
+    buffer_.resize(size + len);
   }
+  if (buffer_.size() >= kFlushSize)
+    Flush();
+}
+
+void GraphViz::Flush() {
+  fwrite(buffer_.data(), 1, buffer_.size(), out_);
+  buffer_.clear();
 }
 
 void GraphViz::Start() {
-  printf("digraph ninja {\n");
-  printf("rankdir=\"LR\"\n");
-  printf("node [fontsize=10, shape=box, height=0.25]\n");
-  printf("edge [fontsize=10]\n");
+  if (format_ == kJSONLines)
+    return;
+  Print("digraph ninja {\n");
+  Print("rankdir=\"LR\"\n");
+  Print("node [fontsize=10, shape=box, height=0.25]\n");
+  Print("edge [fontsize=10]\n");
 }
 
 void GraphViz::Finish() {
-  printf("}\n");
+  if (format_ == kDot)
+    Print("}\n");
+  Flush();
 }
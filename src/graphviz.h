@@ -15,21 +15,68 @@
 #ifndef NINJA_GRAPHVIZ_H_
 #define NINJA_GRAPHVIZ_H_
 
+#include <stdio.h>
+
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "graph.h"
 
 struct Node;
 struct Edge;
 
-/// Runs the process of creating GraphViz .dot file output.
+/// Runs the process of creating GraphViz .dot file output, or with
+/// kJSONLines, a line of JSON per node and per edge for analysis tools.
+/// The graph is walked without recursion, so chains of any depth are fine.
 struct GraphViz {
+  enum Format { kDot, kJSONLines };
+
+  explicit GraphViz(FILE* out = stdout);
+
   void Start();
   void AddTarget(Node* node);
   void Finish();
 
-  std::set<Node*> visited_nodes_;
+  Format format_;
+  /// How many edges to follow from a target, or -1 for no limit.
+  int max_depth_;
+  /// Draw the inputs of phony edges in place of their outputs.
+  bool collapse_phony_;
+  /// Leave out nodes whose path contains one of these strings, and edges
+  /// of these rules, along with everything only reached through them.
+  vector<string> exclude_paths_;
+  set<string> exclude_rules_;
+
+ private:
+  /// An input of an edge as drawn, after phony edges were collapsed.
+  struct Input {
+    Node* node;
+    /// 0 explicit, 1 implicit, 2 order-only.
+    int kind;
+  };
+
+  bool Excluded(Node* node) const;
+  /// Add the nodes \a node stands for to \a inputs: itself, or when phony
+  /// edges are collapsed, the inputs of the phony edge that builds it.
+  void ResolveInput(Node* node, int kind, set<Node*>* seen,
+                    vector<Input>* inputs);
+  void PrintNode(Node* node);
+  void PrintEdge(Edge* edge, const vector<Input>& inputs);
+  /// The id of \a node in kJSONLines output, describing the node first.
+  int NodeId(Node* node);
+  void Print(const char* format, ...);
+  void Flush();
+
+  FILE* out_;
+  string buffer_;
+  /// The fewest edges each visited node was found from a target, when
+  /// there is a depth limit.
+  map<Node*, int> visited_nodes_;
   EdgeSet visited_edges_;
+  map<Node*, int> node_ids_;
+  int edge_count_;
 };
 
 #endif  // NINJA_GRAPHVIZ_H_
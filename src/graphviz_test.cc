@@ -0,0 +1,155 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "graphviz.h"
+
+#include "state.h"
+#include "test.h"
+
+namespace {
+
+struct GraphVizTest : public StateTestWithBuiltinRules {
+  virtual void SetUp() {
+    out_ = tmpfile();
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build foo.o: cat foo.c | gen.h || dir\n"
+"build bar.o: cat bar.c\n"
+"build objs: phony foo.o bar.o\n"
+"build app: cat objs\n"
+"build dir: phony\n"));
+  }
+
+  virtual void TearDown() {
+    fclose(out_);
+  }
+
+  /// The JSON-lines output of \a graph, which writes to out_, for
+  /// \a target.
+  string Graph(GraphViz* graph, const char* target) {
+    graph->format_ = GraphViz::kJSONLines;
+    graph->Start();
+    graph->AddTarget(GetNode(target));
+    graph->Finish();
+    return Contents();
+  }
+
+  /// Everything written to out_.
+  string Contents() {
+    rewind(out_);
+    string contents;
+    char buf[256];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), out_)) > 0)
+      contents.append(buf, len);
+    return contents;
+  }
+
+  FILE* out_;
+};
+
+TEST_F(GraphVizTest, JSONLines) {
+  GraphViz graph(out_);
+  EXPECT_EQ(
+"{\"node\": 0, \"path\": \"app\"}\n"
+"{\"node\": 1, \"path\": \"objs\"}\n"
+"{\"edge\": 0, \"rule\": \"cat\", \"inputs\": [1], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [0]}\n"
+"{\"node\": 2, \"path\": \"foo.o\"}\n"
+"{\"node\": 3, \"path\": \"bar.o\"}\n"
+"{\"edge\": 1, \"rule\": \"phony\", \"inputs\": [2, 3], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [1]}\n"
+"{\"node\": 4, \"path\": \"foo.c\"}\n"
+"{\"node\": 5, \"path\": \"gen.h\"}\n"
+"{\"node\": 6, \"path\": \"dir\"}\n"
+"{\"edge\": 2, \"rule\": \"cat\", \"inputs\": [4], \"implicit\": [5], "
+"\"order_only\": [6], \"outputs\": [2]}\n"
+"{\"edge\": 3, \"rule\": \"phony\", \"inputs\": [], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [6]}\n"
+"{\"node\": 7, \"path\": \"bar.c\"}\n"
+"{\"edge\": 4, \"rule\": \"cat\", \"inputs\": [7], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [3]}\n",
+      Graph(&graph, "app"));
+}
+
+TEST_F(GraphVizTest, CollapsePhony) {
+  GraphViz graph(out_);
+  graph.collapse_phony_ = true;
+  graph.max_depth_ = 1;
+  EXPECT_EQ(
+"{\"node\": 0, \"path\": \"app\"}\n"
+"{\"node\": 1, \"path\": \"foo.o\"}\n"
+"{\"node\": 2, \"path\": \"bar.o\"}\n"
+"{\"edge\": 0, \"rule\": \"cat\", \"inputs\": [1, 2], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [0]}\n",
+      Graph(&graph, "app"));
+}
+
+TEST_F(GraphVizTest, Exclude) {
+  GraphViz graph(out_);
+  graph.exclude_paths_.push_back("gen");
+  graph.exclude_rules_.insert("phony");
+  EXPECT_EQ(
+"{\"node\": 0, \"path\": \"foo.o\"}\n"
+"{\"node\": 1, \"path\": \"foo.c\"}\n"
+"{\"node\": 2, \"path\": \"dir\"}\n"
+"{\"edge\": 0, \"rule\": \"cat\", \"inputs\": [1], \"implicit\": [], "
+"\"order_only\": [2], \"outputs\": [0]}\n",
+      Graph(&graph, "foo.o"));
+}
+
+// A node found closer to a later target is followed further.
+TEST_F(GraphVizTest, DepthFromSeveralTargets) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build a: cat b\n"
+"build b: cat c\n"
+"build c: cat d\n"));
+  GraphViz graph(out_);
+  graph.format_ = GraphViz::kJSONLines;
+  graph.max_depth_ = 1;
+  graph.Start();
+  graph.AddTarget(GetNode("a"));
+  graph.AddTarget(GetNode("b"));
+  graph.Finish();
+  EXPECT_EQ(
+"{\"node\": 0, \"path\": \"a\"}\n"
+"{\"node\": 1, \"path\": \"b\"}\n"
+"{\"edge\": 0, \"rule\": \"cat\", \"inputs\": [1], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [0]}\n"
+"{\"node\": 2, \"path\": \"c\"}\n"
+"{\"edge\": 1, \"rule\": \"cat\", \"inputs\": [2], \"implicit\": [], "
+"\"order_only\": [], \"outputs\": [1]}\n",
+      Contents());
+}
+
+// A chain far deeper than a recursive walk's stack would allow.
+TEST_F(GraphVizTest, DeepChain) {
+  State state;
+  const int kDepth = 100000;
+  string manifest = "rule cp\n  command = cp $in $out\n";
+  for (int i = 1; i <= kDepth; ++i) {
+    char line[64];
+    snprintf(line, sizeof(line), "build n%d: cp n%d\n", i, i - 1);
+    manifest += line;
+  }
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state, manifest.c_str()));
+
+  GraphViz graph(out_);
+  graph.format_ = GraphViz::kJSONLines;
+  graph.AddTarget(state.LookupNode("n100000"));
+  graph.Finish();
+  EXPECT_LT(kDepth * 100, ftell(out_));
+}
+
+}  // anonymous namespace
@@ -0,0 +1,154 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "job_limiter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "debug_flags.h"
+#include "metrics.h"
+#include "status.h"
+
+bool MachineLoad::Read() {
+  string text, err;
+  if (::ReadFile("/proc/stat", &text, &err) < 0 || !ParseStat(text))
+    return false;
+
+  // Pressure stall information needs Linux 4.20 and CONFIG_PSI.
+  string cpu, io;
+  have_pressure =
+      ::ReadFile("/proc/pressure/cpu", &cpu, &err) == 0 &&
+      ::ReadFile("/proc/pressure/io", &io, &err) == 0 &&
+      ParsePressure(cpu, &cpu_stall_micros) &&
+      ParsePressure(io, &io_stall_micros);
+  return true;
+}
+
+bool MachineLoad::ParseStat(const string& text) {
+  // The first line sums up all CPUs:
+  //   cpu  user nice system idle iowait irq softirq steal guest guest_nice
+  // Guest time is already counted as user time.
+  if (text.compare(0, 4, "cpu ") != 0)
+    return false;
+  const char* p = text.c_str() + 4;
+  uint64_t ticks[8];
+  for (int i = 0; i < 8; ++i) {
+    char* end;
+    ticks[i] = strtoull(p, &end, 10);
+    if (end == p) {
+      // Old kernels don't have all the columns.
+      if (i < 4)
+        return false;
+      ticks[i] = 0;
+    }
+    p = end;
+  }
+  total_ticks = 0;
+  for (int i = 0; i < 8; ++i)
+    total_ticks += ticks[i];
+  busy_ticks = total_ticks - ticks[3] - ticks[4];  // Minus idle and iowait.
+
+  const char* running = strstr(text.c_str(), "\nprocs_running ");
+  runnable = running ? atoi(running + strlen("\nprocs_running ")) : 0;
+  return true;
+}
+
+bool MachineLoad::ParsePressure(const string& text, uint64_t* stall_micros) {
+  //   some avg10=0.00 avg60=0.00 avg300=0.00 total=12345
+  if (text.compare(0, 5, "some ") != 0)
+    return false;
+  size_t total = text.find(" total=");
+  size_t end = text.find('\n');
+  if (total == string::npos || total > end)
+    return false;
+  *stall_micros = strtoull(text.c_str() + total + strlen(" total="), NULL, 10);
+  return true;
+}
+
+JobLimiter::JobLimiter(int initial, int max_jobs, int processors,
+                       Status* status)
+    : limit_(max(1, min(initial, max_jobs))), max_jobs_(max_jobs),
+      processors_(max(1, processors)), status_(status), have_last_(false),
+      last_millis_(0), next_sample_millis_(0) {}
+
+int JobLimiter::Limit(int running, int64_t now_millis) {
+  if (now_millis < next_sample_millis_)
+    return limit_;
+
+  METRIC_RECORD("job limiter sample");
+  MachineLoad load;
+  if (!load.Read()) {
+    // Nothing to go by; stick to -j.
+    limit_ = max_jobs_;
+    next_sample_millis_ = numeric_limits<int64_t>::max();
+    return limit_;
+  }
+  if (have_last_)
+    Update(last_, load, now_millis - last_millis_, running);
+  last_ = load;
+  have_last_ = true;
+  last_millis_ = now_millis;
+  next_sample_millis_ = now_millis + kSampleIntervalMillis;
+  return limit_;
+}
+
+void JobLimiter::Update(const MachineLoad& previous, const MachineLoad& current,
+                        int64_t elapsed_millis, int running) {
+  if (current.total_ticks <= previous.total_ticks || elapsed_millis <= 0)
+    return;
+
+  double busy = (double)(current.busy_ticks - previous.busy_ticks) /
+                (current.total_ticks - previous.total_ticks);
+  double cpu_pressure = 0, io_pressure = 0;
+  if (previous.have_pressure && current.have_pressure) {
+    cpu_pressure = (double)(current.cpu_stall_micros -
+                            previous.cpu_stall_micros) / (elapsed_millis * 1000);
+    io_pressure = (double)(current.io_stall_micros -
+                           previous.io_stall_micros) / (elapsed_millis * 1000);
+  }
+
+  int limit = limit_;
+  const char* reason = NULL;
+  if (current.runnable > 2 * processors_) {
+    // Far more tasks want a CPU than there are; they only slow each other
+    // down.  Back off quickly.
+    limit -= max(1, limit / 4);
+    reason = "too many runnable tasks";
+  } else if (io_pressure > 0.5) {
+    // More jobs would only queue up for the disk.
+    limit -= max(1, limit / 8);
+    reason = "stalled on I/O";
+  } else if (busy < 0.9 && cpu_pressure < 0.2 && running >= limit_) {
+    // Every job is taken but CPUs are idle, e.g. because jobs wait for
+    // the network.  Raise the limit in proportion to the idle CPUs.
+    limit += max(1, (int)((0.9 - busy) * processors_));
+    reason = "idle CPUs";
+  }
+  limit = max(1, min(limit, max_jobs_));
+  if (limit == limit_)
+    return;
+
+  if (status_ && g_print_stats) {
+    status_->Info("jobs %d -> %d, %s (%.0f%% busy, %d runnable, "
+                  "%.0f%% cpu / %.0f%% io pressure)",
+                  limit_, limit, reason, busy * 100, current.runnable,
+                  cpu_pressure * 100, io_pressure * 100);
+  }
+  limit_ = limit;
+}
@@ -0,0 +1,95 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NINJA_JOB_LIMITER_H_
+#define NINJA_JOB_LIMITER_H_
+
+#include <string>
+using namespace std;
+
+#include "util.h"  // int64_t
+
+struct Status;
+
+/// Counters describing how busy the machine is, as read from /proc.
+/// Only the difference between two samples is meaningful.
+struct MachineLoad {
+  MachineLoad()
+      : busy_ticks(0), total_ticks(0), runnable(0), have_pressure(false),
+        cpu_stall_micros(0), io_stall_micros(0) {}
+
+  /// Time all CPUs spent running something, and in total.
+  uint64_t busy_ticks;
+  uint64_t total_ticks;
+  /// Number of tasks running or waiting for a CPU right now.
+  int runnable;
+
+  /// Whether the kernel reports pressure stall information (PSI).
+  bool have_pressure;
+  /// Time during which some task waited for a CPU, or for I/O.
+  uint64_t cpu_stall_micros;
+  uint64_t io_stall_micros;
+
+  /// Read the current counters.  Returns false if /proc/stat can't be read,
+  /// e.g. on anything but Linux.
+  bool Read();
+
+  /// Parse the contents of /proc/stat.
+  bool ParseStat(const string& text);
+  /// Parse the contents of a /proc/pressure file for the "some" total.
+  static bool ParsePressure(const string& text, uint64_t* stall_micros);
+};
+
+/// Varies the number of commands run at once between one and the -j
+/// value, to keep the CPUs busy without overloading the machine.  Every
+/// few hundred milliseconds it compares the machine's load with the last
+/// sample: idle CPUs while all jobs are taken mean more jobs can run, while
+/// a long queue of runnable tasks or tasks stalled on I/O mean fewer should.
+struct JobLimiter {
+  /// Start at \a initial jobs, and never exceed \a max_jobs.  With -d stats,
+  /// each change is reported to \a status, if given.
+  JobLimiter(int initial, int max_jobs, int processors,
+             Status* status = NULL);
+
+  /// The number of jobs to run, taking a new sample if one is due.
+  /// \a running is the number of jobs running now.
+  int Limit(int running, int64_t now_millis);
+
+  /// When the next sample is due.
+  int64_t next_sample_millis() const { return next_sample_millis_; }
+
+  /// Whether the limit is below the maximum, so it might be raised.
+  bool limited() const { return limit_ < max_jobs_; }
+
+  /// Adjust the limit to the change from \a previous to \a current, which
+  /// were sampled \a elapsed_millis apart.  Exposed for testing.
+  void Update(const MachineLoad& previous, const MachineLoad& current,
+              int64_t elapsed_millis, int running);
+
+  static const int kSampleIntervalMillis = 300;
+
+ private:
+  int limit_;
+  int max_jobs_;
+  int processors_;
+  Status* status_;
+
+  /// The last sample, and whether reading it worked.
+  MachineLoad last_;
+  bool have_last_;
+  int64_t last_millis_;
+  int64_t next_sample_millis_;
+};
+
+#endif  // NINJA_JOB_LIMITER_H_
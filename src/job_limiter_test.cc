@@ -0,0 +1,95 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "job_limiter.h"
+
+#include "test.h"
+
+namespace {
+
+/// A sample where \a busy out of every 100 ticks were busy since \a base.
+MachineLoad Sample(const MachineLoad& base, int busy, int runnable) {
+  MachineLoad load = base;
+  load.busy_ticks += busy;
+  load.total_ticks += 100;
+  load.runnable = runnable;
+  return load;
+}
+
+TEST(MachineLoadTest, ParseStat) {
+  MachineLoad load;
+  EXPECT_TRUE(load.ParseStat(
+"cpu  100 5 20 800 50 1 2 3 7 0\n"
+"cpu0 50 2 10 400 25 0 1 1 3 0\n"
+"intr 12345\n"
+"procs_running 6\n"
+"procs_blocked 1\n"));
+  EXPECT_EQ(981u, load.total_ticks);
+  EXPECT_EQ(131u, load.busy_ticks);
+  EXPECT_EQ(6, load.runnable);
+
+  EXPECT_FALSE(load.ParseStat("intr 12345\n"));
+}
+
+TEST(MachineLoadTest, ParsePressure) {
+  uint64_t stall = 0;
+  EXPECT_TRUE(MachineLoad::ParsePressure(
+"some avg10=1.50 avg60=0.20 avg300=0.05 total=123456\n"
+"full avg10=0.00 avg60=0.00 avg300=0.00 total=789\n", &stall));
+  EXPECT_EQ(123456u, stall);
+  EXPECT_FALSE(MachineLoad::ParsePressure("full total=1\n", &stall));
+}
+
+TEST(JobLimiterTest, RaiseWhenIdle) {
+  JobLimiter limiter(4, 10, 8);
+  MachineLoad start;
+  // Half the CPUs idle with every job taken: raise by the idle CPUs.
+  limiter.Update(start, Sample(start, 50, 4), 300, 4);
+  EXPECT_EQ(7, limiter.Limit(4, -1));
+
+  // Jobs aren't all taken; the idle CPUs aren't for lack of jobs.
+  limiter.Update(start, Sample(start, 50, 4), 300, 3);
+  EXPECT_EQ(7, limiter.Limit(3, -1));
+
+  // Never past -j.
+  limiter.Update(start, Sample(start, 10, 4), 300, 7);
+  EXPECT_EQ(10, limiter.Limit(10, -1));
+  EXPECT_FALSE(limiter.limited());
+}
+
+TEST(JobLimiterTest, LowerWhenOverloaded) {
+  JobLimiter limiter(8, 8, 4);
+  MachineLoad start;
+  limiter.Update(start, Sample(start, 100, 12), 300, 8);
+  EXPECT_EQ(6, limiter.Limit(8, -1));
+  EXPECT_TRUE(limiter.limited());
+
+  // Busy but not overloaded: keep it.
+  limiter.Update(start, Sample(start, 100, 6), 300, 6);
+  EXPECT_EQ(6, limiter.Limit(6, -1));
+
+  // Tasks stalled on I/O for most of the time.
+  start.have_pressure = true;
+  MachineLoad stalled = Sample(start, 60, 2);
+  stalled.io_stall_micros = 200000;
+  limiter.Update(start, stalled, 300, 6);
+  EXPECT_EQ(5, limiter.Limit(6, -1));
+
+  // Never below one job.
+  for (int i = 0; i < 10; ++i)
+    limiter.Update(start, Sample(start, 100, 100), 300, 1);
+  EXPECT_EQ(1, limiter.Limit(1, -1));
+}
+
+}  // anonymous namespace
@@ -0,0 +1,233 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "json.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void AppendJSONString(const string& in, string* out) {
+  out->push_back('"');
+  for (string::const_iterator c = in.begin(); c != in.end(); ++c) {
+    switch (*c) {
+      case '"': *out += "\\\""; break;
+      case '\\': *out += "\\\\"; break;
+      case '\n': *out += "\\n"; break;
+      case '\t': *out += "\\t"; break;
+      default:
+        if ((unsigned char)*c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", *c);
+          *out += buf;
+        } else {
+          out->push_back(*c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+namespace {
+
+/// Reads the flat JSON objects ParseFlatJSONObject() accepts.
+struct FlatJSONReader {
+  explicit FlatJSONReader(const string& text)
+      : p_(text.c_str()), end_(text.c_str() + text.size()), kind_("object") {}
+
+  bool ReadObject(map<string, JSONValue>* object, string* err);
+  bool ReadArray(vector<map<string, JSONValue> >* objects,
+                 vector<string>* raw, string* err);
+  bool ExpectEnd(string* err) {
+    SkipSpace();
+    if (p_ != end_)
+      return Fail("unexpected text after the " + string(kind_), err);
+    return true;
+  }
+
+ private:
+  void SkipSpace() {
+    while (p_ < end_ && strchr(" \t\r\n", *p_))
+      ++p_;
+  }
+  bool Expect(char c, string* err);
+  bool ReadString(string* str, string* err);
+  bool ReadValue(JSONValue* value, string* err);
+  bool Fail(const string& message, string* err) {
+    *err = message;
+    return false;
+  }
+
+  const char* p_;
+  const char* end_;
+  /// What the text holds, for errors.
+  const char* kind_;
+};
+
+bool FlatJSONReader::ReadObject(map<string, JSONValue>* object, string* err) {
+  SkipSpace();
+  if (!Expect('{', err))
+    return false;
+  SkipSpace();
+  if (p_ < end_ && *p_ == '}') {
+    ++p_;
+  } else {
+    for (;;) {
+      SkipSpace();
+      string key;
+      if (!ReadString(&key, err))
+        return false;
+      SkipSpace();
+      if (!Expect(':', err))
+        return false;
+      SkipSpace();
+      if (!ReadValue(&(*object)[key], err))
+        return false;
+      SkipSpace();
+      if (p_ < end_ && *p_ == ',') {
+        ++p_;
+        continue;
+      }
+      if (!Expect('}', err))
+        return false;
+      break;
+    }
+  }
+  return true;
+}
+
+bool FlatJSONReader::ReadArray(vector<map<string, JSONValue> >* objects,
+                               vector<string>* raw, string* err) {
+  kind_ = "array";
+  SkipSpace();
+  if (!Expect('[', err))
+    return false;
+  SkipSpace();
+  if (p_ < end_ && *p_ == ']') {
+    ++p_;
+    return true;
+  }
+  for (;;) {
+    SkipSpace();
+    const char* start = p_;
+    objects->push_back(map<string, JSONValue>());
+    if (!ReadObject(&objects->back(), err))
+      return false;
+    raw->push_back(string(start, p_));
+    SkipSpace();
+    if (p_ < end_ && *p_ == ',') {
+      ++p_;
+      continue;
+    }
+    return Expect(']', err);
+  }
+}
+
+bool FlatJSONReader::Expect(char c, string* err) {
+  if (p_ == end_ || *p_ != c)
+    return Fail(string("expected '") + c + "'", err);
+  ++p_;
+  return true;
+}
+
+bool FlatJSONReader::ReadString(string* str, string* err) {
+  if (!Expect('"', err))
+    return false;
+  for (;;) {
+    if (p_ == end_)
+      return Fail("unterminated string", err);
+    char c = *p_++;
+    if (c == '"')
+      return true;
+    if (c != '\\') {
+      str->push_back(c);
+      continue;
+    }
+    if (p_ == end_)
+      return Fail("unterminated string", err);
+    switch (c = *p_++) {
+      case '"': case '\\': case '/': str->push_back(c); break;
+      case 'b': str->push_back('\b'); break;
+      case 'f': str->push_back('\f'); break;
+      case 'n': str->push_back('\n'); break;
+      case 'r': str->push_back('\r'); break;
+      case 't': str->push_back('\t'); break;
+      case 'u': {
+        if (end_ - p_ < 4)
+          return Fail("bad \\u escape", err);
+        char hex[5] = { p_[0], p_[1], p_[2], p_[3], 0 };
+        char* hex_end;
+        unsigned long code = strtoul(hex, &hex_end, 16);
+        if (hex_end != hex + 4)
+          return Fail("bad \\u escape", err);
+        p_ += 4;
+        // Paths are bytes; encode the code point as UTF-8.  Surrogate
+        // pairs are left as they are, which no path needs.
+        if (code < 0x80) {
+          str->push_back((char)code);
+        } else if (code < 0x800) {
+          str->push_back((char)(0xc0 | (code >> 6)));
+          str->push_back((char)(0x80 | (code & 0x3f)));
+        } else {
+          str->push_back((char)(0xe0 | (code >> 12)));
+          str->push_back((char)(0x80 | ((code >> 6) & 0x3f)));
+          str->push_back((char)(0x80 | (code & 0x3f)));
+        }
+        break;
+      }
+      default:
+        return Fail(string("bad escape '\\") + c + "'", err);
+    }
+  }
+}
+
+bool FlatJSONReader::ReadValue(JSONValue* value, string* err) {
+  const char* start = p_;
+  if (p_ < end_ && *p_ == '"') {
+    if (!ReadString(&value->str, err))
+      return false;
+    value->is_string = true;
+  } else {
+    while (p_ < end_ && (isalnum((unsigned char)*p_) || strchr("+-.", *p_)))
+      ++p_;
+    string word(start, p_);
+    if (word.empty())
+      return Fail("expected a string, number, true, false or null", err);
+    if (word != "true" && word != "false" && word != "null") {
+      char* number_end;
+      strtod(word.c_str(), &number_end);
+      if (*number_end)
+        return Fail("bad value '" + word + "'", err);
+    }
+  }
+  value->raw.assign(start, p_);
+  return true;
+}
+
+}  // anonymous namespace
+
+bool ParseFlatJSONObject(const string& text, map<string, JSONValue>* object,
+                         string* err) {
+  FlatJSONReader reader(text);
+  return reader.ReadObject(object, err) && reader.ExpectEnd(err);
+}
+
+bool ParseFlatJSONArray(const string& text,
+                        vector<map<string, JSONValue> >* objects,
+                        vector<string>* raw, string* err) {
+  FlatJSONReader reader(text);
+  return reader.ReadArray(objects, raw, err) && reader.ExpectEnd(err);
+}
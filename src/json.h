@@ -0,0 +1,47 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NINJA_JSON_H_
+#define NINJA_JSON_H_
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+/// Append \a in to \a out as a quoted JSON string.
+void AppendJSONString(const string& in, string* out);
+
+/// A value of a flat JSON object: the text it was written as, and for a
+/// string, the string it stands for.
+struct JSONValue {
+  JSONValue() : is_string(false) {}
+  string raw;
+  string str;
+  bool is_string;
+};
+
+/// Parse \a text, a JSON object whose values are all strings, numbers,
+/// true, false or null, into \a object.  Returns false on error.
+bool ParseFlatJSONObject(const string& text, map<string, JSONValue>* object,
+                         string* err);
+
+/// Parse \a text, a JSON array of such flat objects, into \a objects,
+/// setting (*raw)[i] to the text object i was written as.
+bool ParseFlatJSONArray(const string& text,
+                        vector<map<string, JSONValue> >* objects,
+                        vector<string>* raw, string* err);
+
+#endif  // NINJA_JSON_H_
@@ -0,0 +1,84 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "json.h"
+
+#include "test.h"
+
+TEST(JSONTest, AppendString) {
+  string out;
+  AppendJSONString("a \"b\" \\ c\n\x01", &out);
+  EXPECT_EQ("\"a \\\"b\\\" \\\\ c\\n\\u0001\"", out);
+}
+
+TEST(JSONTest, ParseFlatObject) {
+  map<string, JSONValue> object;
+  string err;
+  EXPECT_TRUE(ParseFlatJSONObject(
+      " {\"id\": -1.5e3, \"s\": \"a\\\"\\u00e9\\n\", \"t\": true,"
+      "\"n\":null} ", &object, &err));
+  EXPECT_EQ("", err);
+  ASSERT_EQ(4u, object.size());
+  EXPECT_EQ("-1.5e3", object["id"].raw);
+  EXPECT_FALSE(object["id"].is_string);
+  EXPECT_TRUE(object["s"].is_string);
+  EXPECT_EQ("a\"\xc3\xa9\n", object["s"].str);
+  EXPECT_EQ("\"a\\\"\\u00e9\\n\"", object["s"].raw);
+  EXPECT_EQ("true", object["t"].raw);
+  EXPECT_EQ("null", object["n"].raw);
+
+  object.clear();
+  EXPECT_TRUE(ParseFlatJSONObject("{}", &object, &err));
+  EXPECT_EQ(0u, object.size());
+}
+
+TEST(JSONTest, ParseErrors) {
+  map<string, JSONValue> object;
+  string err;
+  EXPECT_FALSE(ParseFlatJSONObject("", &object, &err));
+  EXPECT_EQ("expected '{'", err);
+  EXPECT_FALSE(ParseFlatJSONObject("{\"a\": [1]}", &object, &err));
+  EXPECT_EQ("expected a string, number, true, false or null", err);
+  EXPECT_FALSE(ParseFlatJSONObject("{\"a\": yes}", &object, &err));
+  EXPECT_EQ("bad value 'yes'", err);
+  EXPECT_FALSE(ParseFlatJSONObject("{\"a\": \"b}", &object, &err));
+  EXPECT_EQ("unterminated string", err);
+  EXPECT_FALSE(ParseFlatJSONObject("{\"a\": 1 \"b\": 2}", &object, &err));
+  EXPECT_EQ("expected '}'", err);
+  EXPECT_FALSE(ParseFlatJSONObject("{} {}", &object, &err));
+  EXPECT_EQ("unexpected text after the object", err);
+}
+
+TEST(JSONTest, ParseFlatArray) {
+  vector<map<string, JSONValue> > objects;
+  vector<string> raw;
+  string err;
+  EXPECT_TRUE(ParseFlatJSONArray("[ {\"a\": 1}, {\"b\": \"x\"} ]\n",
+                                 &objects, &raw, &err));
+  ASSERT_EQ(2u, objects.size());
+  EXPECT_EQ("1", objects[0]["a"].raw);
+  EXPECT_EQ("x", objects[1]["b"].str);
+  ASSERT_EQ(2u, raw.size());
+  EXPECT_EQ("{\"b\": \"x\"}", raw[1]);
+
+  objects.clear();
+  EXPECT_TRUE(ParseFlatJSONArray("[]", &objects, &raw, &err));
+  EXPECT_EQ(0u, objects.size());
+
+  EXPECT_FALSE(ParseFlatJSONArray("[{}] x", &objects, &raw, &err));
+  EXPECT_EQ("unexpected text after the array", err);
+  EXPECT_FALSE(ParseFlatJSONArray("{}", &objects, &raw, &err));
+  EXPECT_EQ("expected '['", err);
+}
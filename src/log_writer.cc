@@ -0,0 +1,121 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "log_writer.h"
+
+#include <errno.h>
+
+#include <chrono>
+
+LogWriter::LogWriter(int flush_interval_millis)
+    : flush_interval_millis_(flush_interval_millis), file_(NULL),
+      appended_bytes_(0), written_bytes_(0),
+      flush_requested_(false), closing_(false), error_(0) {}
+
+LogWriter::~LogWriter() {
+  Close();
+}
+
+void LogWriter::Open(FILE* file) {
+  Close();
+  file_ = file;
+  error_ = 0;
+  closing_ = false;
+  thread_ = std::thread(&LogWriter::Run, this);
+}
+
+bool LogWriter::Append(const void* data, size_t size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (error_) {
+    errno = error_;
+    return false;
+  }
+  bool was_empty = pending_.empty();
+  pending_.append(static_cast<const char*>(data), size);
+  appended_bytes_ += size;
+  if (was_empty || pending_.size() >= kBatchSize)
+    wake_.notify_one();
+  return true;
+}
+
+bool LogWriter::Flush() {
+  if (!file_)
+    return true;
+  std::unique_lock<std::mutex> lock(mutex_);
+  uint64_t target = appended_bytes_;
+  flush_requested_ = true;
+  wake_.notify_one();
+  while (written_bytes_ < target)
+    written_.wait(lock);
+  if (error_) {
+    errno = error_;
+    return false;
+  }
+  return true;
+}
+
+void LogWriter::Close() {
+  if (!file_)
+    return;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closing_ = true;
+    wake_.notify_one();
+  }
+  thread_.join();
+  fclose(file_);
+  file_ = NULL;
+}
+
+size_t LogWriter::pending_size() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return appended_bytes_ - written_bytes_;
+}
+
+void LogWriter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    while (pending_.empty() && !closing_)
+      wake_.wait(lock);
+    if (pending_.empty())
+      break;  // Closing, and everything is written.
+
+    // Give the build a moment to queue more records, so that they can be
+    // written together, unless somebody is waiting for them.
+    if (flush_interval_millis_ > 0) {
+      std::chrono::steady_clock::time_point deadline =
+          std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(flush_interval_millis_);
+      while (!closing_ && !flush_requested_ && pending_.size() < kBatchSize &&
+             wake_.wait_until(lock, deadline) != std::cv_status::timeout) {
+      }
+    }
+
+    batch_.clear();
+    batch_.swap(pending_);
+    uint64_t batch_end = appended_bytes_;
+    flush_requested_ = false;
+
+    lock.unlock();
+    bool success = fwrite(batch_.data(), batch_.size(), 1, file_) == 1 &&
+                   fflush(file_) == 0;
+    int error = errno;
+    lock.lock();
+
+    if (!success && !error_)
+      error_ = error ? error : EIO;
+    written_bytes_ = batch_end;
+    written_.notify_all();
+  }
+}
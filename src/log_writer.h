@@ -0,0 +1,92 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NINJA_LOG_WRITER_H_
+#define NINJA_LOG_WRITER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+using namespace std;
+
+/// Appends records to a log file from a background thread, so that the
+/// build doesn't wait for the disk between finishing one command and
+/// starting the next.  Records are collected in memory and written out in
+/// batches, at most \a flush_interval_millis after they were appended.
+/// Every record is written whole with a single fwrite(), so an interrupted
+/// write can only cut off the tail of the log, like an interrupted fwrite()
+/// did before.  Also used for the pipe to a frontend, with no interval:
+/// records queued while a write is in progress go out with the next one.
+struct LogWriter {
+  explicit LogWriter(int flush_interval_millis = kFlushIntervalMillis);
+  ~LogWriter();
+
+  /// Start writing to \a file, which is owned by the writer from now on.
+  void Open(FILE* file);
+  bool is_open() const { return file_ != NULL; }
+
+  /// Queue \a size bytes at \a data as one record.  Returns false, with
+  /// errno set, if an earlier write failed.
+  bool Append(const void* data, size_t size);
+  bool Append(const string& record) {
+    return Append(record.data(), record.size());
+  }
+
+  /// Wait until everything appended so far has been written and flushed.
+  /// Returns false, with errno set, if a write failed.
+  bool Flush();
+
+  /// Write out all records, stop the writer thread and close the file.
+  void Close();
+
+  /// Number of bytes appended but not written yet.
+  size_t pending_size();
+
+  /// Most records wait at most this long before being written.
+  static const int kFlushIntervalMillis = 50;
+  /// Write right away once this many bytes are queued.
+  static const size_t kBatchSize = 64 * 1024;
+
+ private:
+  /// The writer thread's main loop.
+  void Run();
+
+  int flush_interval_millis_;
+  FILE* file_;
+  std::thread thread_;
+
+  std::mutex mutex_;
+  /// Signalled when the writer thread has something to do.
+  std::condition_variable wake_;
+  /// Signalled when the writer thread has written a batch.
+  std::condition_variable written_;
+
+  /// Records waiting to be written, and the batch being written.
+  string pending_;
+  string batch_;
+  /// Total bytes appended and written so far, to tell Flush() callers
+  /// when their records are on disk.
+  uint64_t appended_bytes_;
+  uint64_t written_bytes_;
+  bool flush_requested_;
+  bool closing_;
+  /// errno of the first failed write, or 0.
+  int error_;
+};
+
+#endif  // NINJA_LOG_WRITER_H_
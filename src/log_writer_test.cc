@@ -0,0 +1,103 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "log_writer.h"
+
+#include "util.h"
+#include "test.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kTestFilename[] = "LogWriterTest-tempfile";
+
+struct LogWriterTest : public testing::Test {
+  virtual void SetUp() {
+    // In case a crashing test left a stale file behind.
+    unlink(kTestFilename);
+  }
+  virtual void TearDown() {
+    unlink(kTestFilename);
+  }
+
+  string Contents() {
+    string contents, err;
+    EXPECT_EQ(0, ::ReadFile(kTestFilename, &contents, &err));
+    return contents;
+  }
+};
+
+TEST_F(LogWriterTest, FlushAndClose) {
+  LogWriter writer;
+  EXPECT_FALSE(writer.is_open());
+  writer.Open(fopen(kTestFilename, "ab"));
+  EXPECT_TRUE(writer.is_open());
+
+  EXPECT_TRUE(writer.Append("one\n"));
+  EXPECT_TRUE(writer.Append("two\n"));
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ("one\ntwo\n", Contents());
+
+  // Close() writes out whatever is still queued.
+  EXPECT_TRUE(writer.Append("three\n"));
+  writer.Close();
+  EXPECT_FALSE(writer.is_open());
+  EXPECT_EQ("one\ntwo\nthree\n", Contents());
+
+  // The writer can be reopened.
+  writer.Open(fopen(kTestFilename, "ab"));
+  EXPECT_TRUE(writer.Append("four\n"));
+  writer.Close();
+  EXPECT_EQ("one\ntwo\nthree\nfour\n", Contents());
+}
+
+TEST_F(LogWriterTest, LargeBatch) {
+  string record(1000, 'x');
+  LogWriter writer;
+  writer.Open(fopen(kTestFilename, "ab"));
+  for (int i = 0; i < 200; ++i)
+    EXPECT_TRUE(writer.Append(record));
+  writer.Close();
+  EXPECT_EQ(200 * record.size(), Contents().size());
+}
+
+TEST_F(LogWriterTest, NoFlushInterval) {
+  LogWriter writer(0);
+  writer.Open(fopen(kTestFilename, "ab"));
+  EXPECT_TRUE(writer.Append("one\n"));
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(0u, writer.pending_size());
+  EXPECT_TRUE(writer.Append("two\n"));
+  writer.Close();
+  EXPECT_EQ("one\ntwo\n", Contents());
+}
+
+TEST_F(LogWriterTest, WriteError) {
+  FILE* f = fopen(kTestFilename, "ab");
+  fclose(f);
+
+  // Writes to a file opened for reading fail; later appends report that.
+  LogWriter writer;
+  writer.Open(fopen(kTestFilename, "rb"));
+  EXPECT_TRUE(writer.Append("lost\n"));
+  EXPECT_FALSE(writer.Flush());
+  EXPECT_FALSE(writer.Append("lost too\n"));
+  writer.Close();
+  EXPECT_EQ("", Contents());
+}
+
+}  // anonymous namespace
@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <vector>
 
 #include "disk_interface.h"
@@ -126,6 +127,7 @@ bool ManifestParser::ParsePool(string* err) {
     return lexer_.Error("duplicate pool '" + name + "'", err);
 
   int depth = -1;
+  ResourceList resources;
 
   while (lexer_.PeekToken(Lexer::INDENT)) {
     string key;
@@ -138,15 +140,35 @@ bool ManifestParser::ParsePool(string* err) {
       depth = atol(depth_string.c_str());
       if (depth < 0)
         return lexer_.Error("invalid pool depth", err);
+    } else if (key == "resources") {
+      // The capacities of the resources, e.g. "mem=32 licenses=2".
+      string resources_string = value.Evaluate(env_);
+      if (!ParseResourceList(resources_string, &resources)) {
+        return lexer_.Error("invalid resources '" + resources_string + "'",
+                            err);
+      }
     } else {
       return lexer_.Error("unexpected variable '" + key + "'", err);
     }
   }
 
-  if (depth < 0)
+  // Pools of resources only need a depth to also limit the number of jobs.
+  if (depth < 0 && resources.empty())
     return lexer_.Error("expected 'depth =' line", err);
 
-  state_->AddPool(new Pool(name, depth));
+  for (size_t i = 0; i < resources.size(); ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (resources[j].first == resources[i].first) {
+        return lexer_.Error("duplicate resource '" + resources[i].first + "'",
+                            err);
+      }
+    }
+  }
+
+  Pool* pool = new Pool(name, depth < 0 ? 0 : depth);
+  for (size_t i = 0; i < resources.size(); ++i)
+    pool->AddResource(resources[i].first, resources[i].second);
+  state_->AddPool(pool);
   return true;
 }
 
@@ -346,6 +368,23 @@ bool ManifestParser::ParseEdge(string* err) {
     edge->weight_ = weight;
   }
 
+  string priority_string = edge->GetBinding("priority");
+  if (!priority_string.empty()) {
+    char* end;
+    edge->priority_ = strtol(priority_string.c_str(), &end, 10);
+    if (*end)
+      return lexer_.Error("invalid priority '" + priority_string + "'", err);
+  }
+
+  string resources = edge->GetBinding("resources");
+  if (!resources.empty()) {
+    string resources_err;
+    if (!edge->pool_->ParseResourceUsage(resources, &edge->resources_,
+                                         &resources_err)) {
+      return lexer_.Error(resources_err, err);
+    }
+  }
+
   edge->outputs_.reserve(outs.size());
   for (size_t i = 0, e = outs.size(); i != e; ++i) {
     string path = outs[i].Evaluate(env);
@@ -410,6 +449,24 @@ bool ManifestParser::ParseEdge(string* err) {
     }
   }
 
+  // The dyndep file is built like any other input, and loaded once it is.
+  string dyndep = edge->GetUnescapedDyndep();
+  if (!dyndep.empty()) {
+    string path_err;
+    uint64_t slash_bits;
+    if (!CanonicalizePath(&dyndep, &slash_bits, &path_err))
+      return lexer_.Error(path_err, err);
+    edge->dyndep_ = state_->GetNode(dyndep, slash_bits);
+    edge->dyndep_->set_dyndep_pending(true);
+    if (find(edge->inputs_.begin(), edge->inputs_.end(), edge->dyndep_) ==
+        edge->inputs_.end()) {
+      return lexer_.Error("dyndep '" + dyndep + "' is not an input", err);
+    }
+    // The file may make the edge restat, which is a binding on its env.
+    if (env == env_)
+      edge->env_ = new BindingEnv(env_);
+  }
+
   // Multiple outputs aren't (yet?) supported with depslog.
   string deps_type = edge->GetBinding("deps");
   if (!deps_type.empty() && edge->outputs_.size() - edge->implicit_outs_ > 1) {
@@ -826,6 +826,119 @@ TEST_F(ParserTest, Errors) {
                                   "build out: run in\n", &err));
     EXPECT_EQ("input:5: unknown pool name 'unnamed_pool'\n", err);
   }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("pool foo\n"
+                                  "  resources = mem=4 mem=2\n", &err));
+    EXPECT_EQ("input:3: duplicate resource 'mem'\n", err);
+  }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("pool foo\n"
+                                  "  resources = mem\n", &err));
+    EXPECT_EQ("input:2: invalid resources 'mem'\n"
+              "  resources = mem\n"
+              "                 ^ near here"
+              , err);
+  }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("pool foo\n"
+                                  "  resources = mem=4\n"
+                                  "rule run\n"
+                                  "  command = echo\n"
+                                  "  pool = foo\n"
+                                  "build out: run in\n"
+                                  "  resources = cpu=1\n", &err));
+    EXPECT_EQ("input:8: pool 'foo' has no resource 'cpu'\n", err);
+  }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("pool foo\n"
+                                  "  resources = mem=4\n"
+                                  "rule run\n"
+                                  "  command = echo\n"
+                                  "  pool = foo\n"
+                                  "  resources = mem=5\n"
+                                  "build out: run in\n", &err));
+    EXPECT_EQ("input:8: pool 'foo' has only 4 of 'mem'\n", err);
+  }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("rule run\n"
+                                  "  command = echo\n"
+                                  "build out: run in\n"
+                                  "  priority = high\n", &err));
+    EXPECT_EQ("input:5: invalid priority 'high'\n", err);
+  }
+
+  {
+    State local_state;
+    ManifestParser parser(&local_state, NULL);
+    string err;
+    EXPECT_FALSE(parser.ParseTest("rule touch\n"
+                                  "  command = touch $out\n"
+                                  "build out: touch in\n"
+                                  "  dyndep = dd\n", &err));
+    EXPECT_EQ("input:5: dyndep 'dd' is not an input\n", err);
+  }
+}
+
+TEST_F(ParserTest, Dyndep) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(
+"rule touch\n"
+"  command = touch $out\n"
+"  dyndep = $out.dd\n"
+"build out: touch || out.dd\n"
+"build other: touch\n"
+"  dyndep =\n"));
+  Edge* edge = state.LookupNode("out")->in_edge();
+  ASSERT_TRUE(edge->dyndep_);
+  EXPECT_EQ("out.dd", edge->dyndep_->path());
+  EXPECT_TRUE(edge->dyndep_->dyndep_pending());
+  EXPECT_FALSE(state.LookupNode("other")->in_edge()->dyndep_);
+}
+
+TEST_F(ParserTest, PoolResources) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(
+"pool link\n"
+"  resources = mem=32 cpu=8\n"
+"rule link\n"
+"  command = link $in > $out\n"
+"  pool = link\n"
+"  resources = mem=$mem cpu=4\n"
+"build a: link a.o\n"
+"  mem = 8\n"
+"build b: link b.o\n"
+"  resources = cpu=1\n"));
+  Pool* pool = state.LookupPool("link");
+  ASSERT_TRUE(pool);
+  EXPECT_EQ(0, pool->depth());
+  EXPECT_TRUE(pool->ShouldDelayEdge());
+
+  Edge* a = state.LookupNode("a")->in_edge();
+  ASSERT_EQ(2u, a->resources_.size());
+  EXPECT_EQ(8, a->resources_[0]);
+  EXPECT_EQ(4, a->resources_[1]);
+  Edge* b = state.LookupNode("b")->in_edge();
+  ASSERT_EQ(2u, b->resources_.size());
+  EXPECT_EQ(0, b->resources_[0]);
+  EXPECT_EQ(1, b->resources_[1]);
 }
 
 TEST_F(ParserTest, MissingInput) {
@@ -848,7 +961,7 @@ TEST_F(ParserTest, MultipleOutputs) {
 
 TEST_F(ParserTest, MultipleImplicitOutputsWithDeps) {
   State local_state;
-  ManifestParser parser(&local_state, NULL, kDupeEdgeActionWarn);
+  ManifestParser parser(&local_state, NULL);
   string err;
   EXPECT_TRUE(parser.ParseTest("rule cc\n  command = foo\n  deps = gcc\n"
                                "build a.o | a.gcno: cc c.cc\n",
@@ -12,6 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// It's easiest just to ask for the printf format macros right away.
+#ifndef _WIN32
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#endif
+
 #include "metrics.h"
 
 #include <errno.h>
@@ -19,19 +26,28 @@
 #include <string.h>
 
 #ifndef _WIN32
+#include <inttypes.h>
 #include <sys/time.h>
 #else
 #include <windows.h>
 #endif
 
 #include <algorithm>
+#include <mutex>
 
+#include "json.h"
 #include "util.h"
 
 Metrics* g_metrics = NULL;
 
 namespace {
 
+/// Guards the metrics, which background threads record too.
+std::mutex g_metrics_mutex;
+
+/// The innermost ScopedMetric on each thread.
+thread_local ScopedMetric* g_current_scope = NULL;
+
 #ifndef _WIN32
 /// Compute a platform-specific high-res timer value that fits into an int64.
 int64_t HighResTimer() {
@@ -75,46 +91,167 @@ int64_t TimerToMicros(int64_t dt) {
 }  // anonymous namespace
 
 
+Metric::Metric(const string& name)
+    : name(name), count(0), sum(0), self_sum(0), max(0), parent(NULL) {
+  fill(histogram, histogram + kBuckets, 0);
+}
+
+int Metric::BucketFor(int64_t micros) {
+  if (micros < kLinearBuckets)
+    return micros < 0 ? 0 : (int)micros;
+  int log2 = 0;
+  while (micros >> (log2 + 1))
+    ++log2;
+  // The two bits below the highest one pick one of four buckets.
+  int sub_bucket = (int)(micros >> (log2 - 2)) & 3;
+  return kLinearBuckets + (log2 - 4) * kBucketsPerPowerOfTwo + sub_bucket;
+}
+
+int64_t Metric::BucketMax(int bucket) {
+  if (bucket < kLinearBuckets)
+    return bucket;
+  int log2 = (bucket - kLinearBuckets) / kBucketsPerPowerOfTwo + 4;
+  int sub_bucket = (bucket - kLinearBuckets) % kBucketsPerPowerOfTwo;
+  return ((int64_t)(4 + sub_bucket + 1) << (log2 - 2)) - 1;
+}
+
+void Metric::Record(int64_t micros, int64_t child_micros) {
+  ++count;
+  sum += micros;
+  self_sum += micros - child_micros;
+  if (micros > max)
+    max = micros;
+  ++histogram[BucketFor(micros)];
+}
+
+int64_t Metric::Percentile(double percentile) const {
+  int64_t target = (int64_t)(count * percentile / 100 + 0.999999);
+  if (target < 1)
+    target = 1;
+  int64_t seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += histogram[bucket];
+    if (seen >= target)
+      return min(BucketMax(bucket), max);
+  }
+  return max;
+}
+
 ScopedMetric::ScopedMetric(Metric* metric) {
   metric_ = metric;
   if (!metric_)
     return;
+  outer_ = g_current_scope;
+  child_micros_ = 0;
+  g_current_scope = this;
   start_ = HighResTimer();
 }
 ScopedMetric::~ScopedMetric() {
   if (!metric_)
     return;
-  metric_->count++;
   int64_t dt = TimerToMicros(HighResTimer() - start_);
-  metric_->sum += dt;
+  g_current_scope = outer_;
+
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  metric_->Record(dt, child_micros_);
+  if (!outer_)
+    return;
+  outer_->child_micros_ += dt;
+
+  // Report the metric under the scope it first ran in, unless it is still
+  // running further out, as in recursive code, so that the tree has no
+  // loops.
+  if (metric_->count == 1) {
+    for (ScopedMetric* scope = outer_; scope; scope = scope->outer_) {
+      if (scope->metric_ == metric_)
+        return;
+    }
+    Metric* parent = outer_->metric_;
+    for (Metric* m = parent; m; m = m->parent) {
+      if (m == metric_)
+        return;
+    }
+    metric_->parent = parent;
+  }
 }
 
 Metric* Metrics::NewMetric(const string& name) {
-  Metric* metric = new Metric;
-  metric->name = name;
-  metric->count = 0;
-  metric->sum = 0;
+  Metric* metric = new Metric(name);
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
   metrics_.push_back(metric);
   return metric;
 }
 
 void Metrics::Report() {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
   int width = 0;
   for (vector<Metric*>::iterator i = metrics_.begin();
        i != metrics_.end(); ++i) {
-    width = max((int)(*i)->name.size(), width);
+    int depth = 0;
+    for (Metric* m = (*i)->parent; m; m = m->parent)
+      ++depth;
+    width = max((int)(*i)->name.size() + 2 * depth, width);
   }
 
-  printf("%-*s\t%-6s\t%-9s\t%s\n", width,
-         "metric", "count", "avg (us)", "total (ms)");
+  printf("%-*s\t%-6s\t%-9s\t%-7s\t%-7s\t%-7s\t%-7s\t%s\n", width,
+         "metric", "count", "avg (us)", "p50", "p90", "p99", "max", "total (ms)");
+  ReportTree(NULL, 0, width);
+}
+
+void Metrics::ReportTree(Metric* parent, int depth, int width) {
   for (vector<Metric*>::iterator i = metrics_.begin();
        i != metrics_.end(); ++i) {
     Metric* metric = *i;
+    if (metric->parent != parent)
+      continue;
     double total = metric->sum / (double)1000;
     double avg = metric->sum / (double)metric->count;
-    printf("%-*s\t%-6d\t%-8.1f\t%.1f\n", width, metric->name.c_str(),
-           metric->count, avg, total);
+    printf("%*s%-*s\t%-6d\t%-8.1f\t%-7" PRId64 "\t%-7" PRId64 "\t%-7" PRId64
+           "\t%-7" PRId64 "\t%.1f\n",
+           2 * depth, "", width - 2 * depth, metric->name.c_str(),
+           metric->count, avg, metric->Percentile(50), metric->Percentile(90),
+           metric->Percentile(99), metric->max, total);
+    ReportTree(metric, depth + 1, width);
+  }
+}
+
+bool Metrics::ReportJSON(const string& path, string* err) {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  string json = "{\"metrics\": [";
+  for (vector<Metric*>::iterator i = metrics_.begin();
+       i != metrics_.end(); ++i) {
+    Metric* metric = *i;
+    json += i == metrics_.begin() ? "\n  {\"name\": " : ",\n  {\"name\": ";
+    AppendJSONString(metric->name, &json);
+    json += ", \"parent\": ";
+    if (metric->parent)
+      AppendJSONString(metric->parent->name, &json);
+    else
+      json += "null";
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             ", \"count\": %d, \"total_us\": %" PRId64
+             ", \"self_us\": %" PRId64 ", \"p50_us\": %" PRId64
+             ", \"p90_us\": %" PRId64 ", \"p99_us\": %" PRId64
+             ", \"max_us\": %" PRId64 "}",
+             metric->count, metric->sum, metric->self_sum,
+             metric->Percentile(50), metric->Percentile(90),
+             metric->Percentile(99), metric->max);
+    json += buf;
+  }
+  json += "\n]}\n";
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) {
+    *err = strerror(errno);
+    return false;
   }
+  bool success = fwrite(json.data(), json.size(), 1, file) == 1;
+  if (fclose(file) != 0)
+    success = false;
+  if (!success)
+    *err = strerror(errno);
+  return success;
 }
 
 uint64_t Stopwatch::Now() const {
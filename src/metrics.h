@@ -26,16 +26,42 @@ using namespace std;
 
 /// A single metrics we're tracking, like "depfile load time".
 struct Metric {
+  explicit Metric(const string& name);
+
   string name;
   /// Number of times we've hit the code path.
   int count;
   /// Total time (in micros) we've spent on the code path.
   int64_t sum;
+  /// Part of sum not spent in other metrics' scopes nested in this one.
+  int64_t self_sum;
+  /// Longest time (in micros) spent on the code path at once.
+  int64_t max;
+  /// The metric whose scope this one first ran in, or NULL.
+  Metric* parent;
+
+  /// Record one pass through the code path that took \a micros, of which
+  /// \a child_micros were spent in nested scopes.
+  void Record(int64_t micros, int64_t child_micros);
+
+  /// The time (in micros) that \a percentile percent of the passes took at
+  /// most, to within a quarter, as times are counted in buckets.
+  int64_t Percentile(double percentile) const;
+
+  /// Number of passes per bucket of times: a bucket for each time below
+  /// 16us, then four buckets for each power of two.
+  enum { kLinearBuckets = 16, kBucketsPerPowerOfTwo = 4, kBuckets = 256 };
+  int histogram[kBuckets];
+
+  static int BucketFor(int64_t micros);
+  /// The largest time counted in \a bucket.
+  static int64_t BucketMax(int bucket);
 };
 
 
 /// A scoped object for recording a metric across the body of a function.
-/// Used by the METRIC_RECORD macro.
+/// Used by the METRIC_RECORD macro.  Scopes nest: time spent in an inner
+/// scope on the same thread is subtracted from the outer one's self time.
 struct ScopedMetric {
   explicit ScopedMetric(Metric* metric);
   ~ScopedMetric();
@@ -45,6 +71,10 @@ private:
   /// Timestamp when the measurement started.
   /// Value is platform-dependent.
   int64_t start_;
+  /// The enclosing scope on this thread, and the time spent in the scopes
+  /// nested in this one.
+  ScopedMetric* outer_;
+  int64_t child_micros_;
 };
 
 /// The singleton that stores metrics and prints the report.
@@ -54,7 +84,12 @@ struct Metrics {
   /// Print a summary report to stdout.
   void Report();
 
+  /// Write all metrics to \a path as JSON, for tools to compare runs.
+  bool ReportJSON(const string& path, string* err);
+
 private:
+  void ReportTree(Metric* parent, int depth, int width);
+
   vector<Metric*> metrics_;
 };
 
@@ -0,0 +1,68 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metrics.h"
+
+#include "test.h"
+
+TEST(MetricsTest, Buckets) {
+  // Every time falls within its bucket's range.
+  for (int64_t micros = 0; micros < 100000; micros += 7) {
+    int bucket = Metric::BucketFor(micros);
+    EXPECT_LE(micros, Metric::BucketMax(bucket));
+    if (bucket > 0)
+      EXPECT_GT(micros, Metric::BucketMax(bucket - 1));
+  }
+  EXPECT_LT(Metric::BucketFor(1LL << 62), (int)Metric::kBuckets);
+}
+
+TEST(MetricsTest, Percentiles) {
+  Metric metric("test");
+  EXPECT_EQ(0, metric.Percentile(50));
+
+  for (int i = 1; i <= 100; ++i)
+    metric.Record(i < 100 ? 10 : 5000, 0);
+  EXPECT_EQ(100, metric.count);
+  EXPECT_EQ(5000, metric.max);
+  EXPECT_EQ(10, metric.Percentile(50));
+  EXPECT_EQ(10, metric.Percentile(99));
+  EXPECT_EQ(5000, metric.Percentile(100));
+
+  // Percentiles are precise to within a quarter.
+  Metric spread("spread");
+  for (int i = 1; i <= 1000; ++i)
+    spread.Record(i, 0);
+  EXPECT_LE(900, spread.Percentile(90));
+  EXPECT_GE(900 * 5 / 4, spread.Percentile(90));
+}
+
+TEST(MetricsTest, NestedScopes) {
+  Metrics metrics;
+  Metric* outer = metrics.NewMetric("outer");
+  Metric* inner = metrics.NewMetric("inner");
+  {
+    ScopedMetric outer_scope(outer);
+    {
+      ScopedMetric inner_scope(inner);
+      // Recursion doesn't make a metric its own parent.
+      ScopedMetric recursive_scope(outer);
+    }
+  }
+  EXPECT_EQ(2, outer->count);
+  EXPECT_EQ(1, inner->count);
+  EXPECT_EQ(outer, inner->parent);
+  EXPECT_EQ((Metric*)NULL, outer->parent);
+  EXPECT_LE(inner->sum, outer->sum);
+  EXPECT_LE(outer->self_sum, outer->sum);
+}
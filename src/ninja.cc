@@ -35,14 +35,19 @@
 #include "build_log.h"
 #include "deps_log.h"
 #include "clean.h"
+#include "command_export.h"
 #include "debug_flags.h"
 #include "disk_interface.h"
+#include "dyndep.h"
 #include "graph.h"
 #include "graphviz.h"
 #include "manifest_parser.h"
 #include "metrics.h"
+#include "query_server.h"
+#include "simulate.h"
 #include "state.h"
 #include "status.h"
+#include "trace.h"
 #include "util.h"
 #include "version.h"
 
@@ -74,13 +79,19 @@ struct Options {
 
   /// Whether phony cycles should warn or print an error.
   bool phony_cycle_should_err;
+
+  /// File to write a trace of the build to, if any.
+  const char* trace_path;
+
+  /// File to write the '-d stats' metrics to as JSON, if any.
+  const char* stats_json_path;
 };
 
 /// The Ninja main() loads up a series of data structures; various tools need
 /// to poke into these, so store them as fields on an object.
 struct NinjaMain : public BuildLogUser {
   NinjaMain(const char* ninja_command, const BuildConfig& config) :
-      ninja_command_(ninja_command), config_(config),
+      ninja_command_(ninja_command), config_(config), trace_(NULL),
       start_time_millis_(GetTimeMillis()) {}
 
   /// Command line used to run Ninja.
@@ -101,6 +112,9 @@ struct NinjaMain : public BuildLogUser {
   BuildLog build_log_;
   DepsLog deps_log_;
 
+  /// Where to record the build, if --trace was given.
+  BuildTrace* trace_;
+
   /// The type of functions that are the entry points to tools (subcommands).
   typedef int (NinjaMain::*ToolFunc)(const Options*, int, char**);
 
@@ -112,6 +126,10 @@ struct NinjaMain : public BuildLogUser {
   bool CollectTargetsFromArgs(int argc, char* argv[],
                               vector<Node*>* targets, string* err);
 
+  /// Load the dyndep files that exist, for tools that show the graph
+  /// without building it.
+  void LoadDyndeps();
+
   // The various subcommands, run via "-t XXX".
   int ToolGraph(const Options* options, int argc, char* argv[]);
   int ToolQuery(const Options* options, int argc, char* argv[]);
@@ -121,8 +139,11 @@ struct NinjaMain : public BuildLogUser {
   int ToolTargets(const Options* options, int argc, char* argv[]);
   int ToolCommands(const Options* options, int argc, char* argv[]);
   int ToolClean(const Options* options, int argc, char* argv[]);
+  int ToolCleanDead(const Options* options, int argc, char* argv[]);
   int ToolCompilationDatabase(const Options* options, int argc, char* argv[]);
   int ToolRecompact(const Options* options, int argc, char* argv[]);
+  int ToolTrace(const Options* options, int argc, char* argv[]);
+  int ToolSimulate(const Options* options, int argc, char* argv[]);
   int ToolUrtle(const Options* options, int argc, char** argv);
 
   /// Open the build log.
@@ -150,9 +171,10 @@ struct NinjaMain : public BuildLogUser {
   void DumpMetrics();
 
   virtual bool IsPathDead(StringPiece s) const {
-    Node* n = state_.LookupNode(s);
-    if (!n || !n->in_edge())
-      return false;
+    return !IsPathInManifest(s) && IsPathDeadOnDisk(s);
+  }
+
+  virtual bool IsPathInManifest(StringPiece s) const {
     // Just checking n isn't enough: If an old output is both in the build log
     // and in the deps log, it will have a Node object in state_.  (It will also
     // have an in edge if one of its inputs is another output that's in the deps
@@ -160,10 +182,17 @@ struct NinjaMain : public BuildLogUser {
     // edge is rare, and the first recompaction will delete all old outputs from
     // the deps log, and then a second recompaction will clear the build log,
     // which seems good enough for this corner case.)
+    Node* n = state_.LookupNode(s);
+    return n && n->in_edge();
+  }
+
+  virtual bool IsPathDeadOnDisk(StringPiece s) const {
     // Do keep entries around for files which still exist on disk, for
-    // generators that want to use this information.
+    // generators that want to use this information.  This may run on the
+    // recompaction thread, so don't share disk_interface_'s stat cache.
+    RealDiskInterface disk_interface;
     string err;
-    TimeStamp mtime = disk_interface_.Stat(s.AsString(), &err);
+    TimeStamp mtime = disk_interface.Stat(s.AsString(), &err);
     if (mtime == -1)
       Error("%s", err.c_str());  // Log and ignore Stat() errors.
     return mtime == 0;
@@ -213,6 +242,8 @@ void Usage(const BuildConfig& config) {
 "  -j N     run N jobs in parallel [default=%d, derived from CPUs available]\n"
 "  -k N     keep going until N jobs fail [default=1]\n"
 "  -l N     do not start new jobs if the load average is greater than N\n"
+"  --adaptive-jobs  run between 1 and N jobs (-j), as many as keep the CPUs\n"
+"                   busy without overloading the machine\n"
 "  -n       dry run (don't run commands but act like they succeeded)\n"
 "  -v       show all command lines while building\n"
 "\n"
@@ -220,9 +251,14 @@ void Usage(const BuildConfig& config) {
 "  -t TOOL  run a subtool (use -t list to list subtools)\n"
 "    terminates toplevel options; further flags are passed to the tool\n"
 "  -w FLAG  adjust warnings (use -w list to list warnings)\n"
-#ifndef _WIN32
 "\n"
+"  --mkdirs  create all output directories before running any command\n"
+"  --collapse-phony  read through phony aliases instead of visiting them\n"
+"  --trace FILE  write a Chrome trace of the build to FILE\n"
+"  --stats-json FILE  write operation counts/timing info to FILE as JSON\n"
+#ifndef _WIN32
 "  --frontend COMMAND   execute COMMAND and pass serialized build output to it\n"
+"  --cgroup DIR  run each command in its own cgroup v2 below DIR\n"
 #endif
       , kNinjaVersion, config.parallelism);
 }
@@ -254,6 +290,7 @@ bool NinjaMain::RebuildManifest(const char* input_file, string* err,
 
   Builder builder(&state_, config_, &build_log_, &deps_log_, &disk_interface_,
                   status, start_time_millis_);
+  builder.set_trace(trace_);
   if (!builder.AddTarget(node, err))
     return false;
 
@@ -336,7 +373,92 @@ bool NinjaMain::CollectTargetsFromArgs(int argc, char* argv[],
   return true;
 }
 
+void NinjaMain::LoadDyndeps() {
+  DyndepLoader dyndep_loader(&state_, &disk_interface_);
+  for (vector<Edge*>::iterator e = state_.edges_.begin();
+       e != state_.edges_.end(); ++e) {
+    Node* dyndep = (*e)->dyndep_;
+    if (!dyndep || !dyndep->dyndep_pending())
+      continue;
+    string err;
+    if (disk_interface_.Stat(dyndep->path(), &err) <= 0)
+      continue;
+    // Show what is known, even if one of the files is broken.
+    if (!dyndep_loader.LoadDyndeps(dyndep, &err))
+      Warning("%s", err.c_str());
+  }
+}
+
 int NinjaMain::ToolGraph(const Options* options, int argc, char* argv[]) {
+  // The graph tool uses getopt, and expects argv[0] to contain the name of
+  // the tool, i.e. "graph".
+  argc++;
+  argv--;
+
+  enum {
+    OPT_DEPTH = 1, OPT_EXCLUDE_PATH, OPT_EXCLUDE_RULE, OPT_COLLAPSE_PHONY,
+    OPT_FORMAT
+  };
+  const option kGraphOptions[] = {
+    { "depth", required_argument, NULL, OPT_DEPTH },
+    { "exclude-path", required_argument, NULL, OPT_EXCLUDE_PATH },
+    { "exclude-rule", required_argument, NULL, OPT_EXCLUDE_RULE },
+    { "collapse-phony", no_argument, NULL, OPT_COLLAPSE_PHONY },
+    { "format", required_argument, NULL, OPT_FORMAT },
+    { "help", no_argument, NULL, 'h' },
+    { NULL, 0, NULL, 0 }
+  };
+  GraphViz graph;
+  optind = 1;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", kGraphOptions, NULL)) != -1) {
+    switch (opt) {
+    case OPT_DEPTH: {
+      char* end;
+      graph.max_depth_ = strtol(optarg, &end, 10);
+      if (*end != 0 || graph.max_depth_ < 0) {
+        Error("invalid --depth '%s'", optarg);
+        return 1;
+      }
+      break;
+    }
+    case OPT_EXCLUDE_PATH:
+      graph.exclude_paths_.push_back(optarg);
+      break;
+    case OPT_EXCLUDE_RULE:
+      graph.exclude_rules_.insert(optarg);
+      break;
+    case OPT_COLLAPSE_PHONY:
+      graph.collapse_phony_ = true;
+      break;
+    case OPT_FORMAT:
+      if (strcmp(optarg, "dot") == 0) {
+        graph.format_ = GraphViz::kDot;
+      } else if (strcmp(optarg, "jsonl") == 0) {
+        graph.format_ = GraphViz::kJSONLines;
+      } else {
+        Error("unknown --format '%s', expected dot or jsonl", optarg);
+        return 1;
+      }
+      break;
+    case 'h':
+    default:
+      printf("usage: ninja -t graph [options] [targets]\n"
+"\n"
+"options:\n"
+"  --depth N            follow at most N edges from the targets\n"
+"  --exclude-path STR   leave out files whose path contains STR\n"
+"  --exclude-rule RULE  leave out the edges of RULE\n"
+"  --collapse-phony     draw the inputs of phony edges in their place\n"
+"  --format FORMAT      dot (default), or jsonl: a JSON object per line\n"
+"                       for each file and each edge\n"
+             );
+      return 1;
+    }
+  }
+  argv += optind;
+  argc -= optind;
+
   vector<Node*> nodes;
   string err;
   if (!CollectTargetsFromArgs(argc, argv, &nodes, &err)) {
@@ -344,7 +466,7 @@ int NinjaMain::ToolGraph(const Options* options, int argc, char* argv[]) {
     return 1;
   }
 
-  GraphViz graph;
+  LoadDyndeps();
   graph.Start();
   for (vector<Node*>::const_iterator n = nodes.begin(); n != nodes.end(); ++n)
     graph.AddTarget(*n);
@@ -354,6 +476,67 @@ int NinjaMain::ToolGraph(const Options* options, int argc, char* argv[]) {
 }
 
 int NinjaMain::ToolQuery(const Options* options, int argc, char* argv[]) {
+  // The query tool uses getopt, and expects argv[0] to contain the name of
+  // the tool, i.e. "query".
+  argc++;
+  argv--;
+
+  enum { OPT_SERVER = 1, OPT_SOCKET = 2 };
+  const option kQueryOptions[] = {
+    { "server", no_argument, NULL, OPT_SERVER },
+    { "socket", required_argument, NULL, OPT_SOCKET },
+    { "help", no_argument, NULL, 'h' },
+    { NULL, 0, NULL, 0 }
+  };
+  bool server = false;
+  const char* socket_path = NULL;
+  optind = 1;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "h", kQueryOptions, NULL)) != -1) {
+    switch (opt) {
+    case OPT_SERVER:
+      server = true;
+      break;
+    case OPT_SOCKET:
+      server = true;
+      socket_path = optarg;
+      break;
+    case 'h':
+    default:
+      printf("usage: ninja -t query targets...\n"
+"       ninja -t query --server [--socket PATH]\n"
+"\n"
+"show the inputs and outputs of targets.  With --server, load the build\n"
+"once and answer JSON requests, one per line, on stdin and stdout or on\n"
+"the unix socket PATH, e.g.\n"
+"  {\"id\": 1, \"query\": \"inputs\", \"target\": \"foo.o\"}\n"
+"queries: inputs outputs reverse deps commands\n");
+      return 1;
+    }
+  }
+  argv += optind;
+  argc -= optind;
+
+  LoadDyndeps();
+  if (server) {
+    QueryServer query_server(&state_, &deps_log_);
+    string err;
+    if (socket_path) {
+#ifndef _WIN32
+      query_server.ServeSocket(socket_path, &err);
+#else
+      err = "--socket is not supported on Windows";
+#endif
+      Error("%s", err.c_str());
+      return 1;
+    }
+    if (!query_server.Serve(0, 1, &err)) {
+      Error("%s", err.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
   if (argc == 0) {
     Error("expected a target to query");
     return 1;
@@ -393,8 +576,80 @@ int NinjaMain::ToolQuery(const Options* options, int argc, char* argv[]) {
 
 #if defined(NINJA_HAVE_BROWSE)
 int NinjaMain::ToolBrowse(const Options* options, int argc, char* argv[]) {
-  RunBrowsePython(&state_, ninja_command_, options->input_file, argc, argv);
-  // If we get here, the browse failed.
+  // The browse tool uses getopt, and expects argv[0] to contain the name of
+  // the tool, i.e. "browse".
+  argc++;
+  argv--;
+
+  enum { OPT_NO_BROWSER = 1 };
+  const option kBrowseOptions[] = {
+    { "port", required_argument, NULL, 'p' },
+    { "hostname", required_argument, NULL, 'a' },
+    { "no-browser", no_argument, NULL, OPT_NO_BROWSER },
+    { "help", no_argument, NULL, 'h' },
+    { NULL, 0, NULL, 0 }
+  };
+  int port = 8000;
+  string hostname = "localhost";
+  bool open_browser = true;
+  optind = 1;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "p:a:h", kBrowseOptions,
+                            NULL)) != -1) {
+    switch (opt) {
+    case 'p': {
+      char* end;
+      port = strtol(optarg, &end, 10);
+      if (*end != 0 || port < 0 || port > 65535) {
+        Error("invalid port '%s'", optarg);
+        return 1;
+      }
+      break;
+    }
+    case 'a':
+      hostname = optarg;
+      break;
+    case OPT_NO_BROWSER:
+      open_browser = false;
+      break;
+    case 'h':
+    default:
+      printf("usage: ninja -t browse [options] [target]\n"
+"\n"
+"browse the dependency graph, starting at target (default all)\n"
+"\n"
+"options:\n"
+"  -p, --port PORT          port to listen on (default 8000)\n"
+"  -a, --hostname HOSTNAME  hostname to listen on (default localhost)\n"
+"  --no-browser             don't open a web browser\n"
+             );
+      return 1;
+    }
+  }
+  argv += optind;
+  argc -= optind;
+
+  BrowseServer server(&state_, &build_log_, &deps_log_,
+                      argc > 0 ? argv[0] : "all");
+  string err;
+  if (!server.Listen(hostname, port, &err)) {
+    Error("%s", err.c_str());
+    return 1;
+  }
+  if (hostname.empty()) {
+    char name[256];
+    if (gethostname(name, sizeof(name)) == 0)
+      hostname = name;
+  }
+  char url[512];
+  snprintf(url, sizeof(url), "http://%s:%d", hostname.c_str(), port);
+  printf("Web server running on %s:%d, ctl-C to abort...\n",
+         hostname.c_str(), port);
+  fflush(stdout);
+  if (open_browser)
+    OpenBrowser(url);
+  server.Run(&err);
+  Error("%s", err.c_str());
   return 1;
 }
 #endif  // _WIN32
@@ -556,7 +811,8 @@ int NinjaMain::ToolTargets(const Options* options, int argc, char* argv[]) {
 }
 
 enum PrintCommandMode { PCM_Single, PCM_All };
-void PrintCommands(Edge* edge, EdgeSet* seen, PrintCommandMode mode) {
+void CollectCommandEdges(Edge* edge, EdgeSet* seen, PrintCommandMode mode,
+                         vector<Edge*>* edges) {
   if (!edge)
     return;
   if (!seen->insert(edge).second)
@@ -565,11 +821,11 @@ void PrintCommands(Edge* edge, EdgeSet* seen, PrintCommandMode mode) {
   if (mode == PCM_All) {
     for (vector<Node*>::iterator in = edge->inputs_.begin();
          in != edge->inputs_.end(); ++in)
-      PrintCommands((*in)->in_edge(), seen, mode);
+      CollectCommandEdges((*in)->in_edge(), seen, mode, edges);
   }
 
   if (!edge->is_phony())
-    puts(edge->EvaluateCommand().c_str());
+    edges->push_back(edge);
 }
 
 int NinjaMain::ToolCommands(const Options* options, int argc, char* argv[]) {
@@ -607,9 +863,28 @@ int NinjaMain::ToolCommands(const Options* options, int argc, char* argv[]) {
     return 1;
   }
 
+  LoadDyndeps();
   EdgeSet seen;
+  vector<Edge*> edges;
   for (vector<Node*>::iterator in = nodes.begin(); in != nodes.end(); ++in)
-    PrintCommands((*in)->in_edge(), &seen, mode);
+    CollectCommandEdges((*in)->in_edge(), &seen, mode, &edges);
+
+  vector<string> commands;
+  EvaluateCommands(edges, config_.parallelism, &commands);
+
+  // Write in large blocks; a terminal would otherwise get a write per line.
+  const size_t kBufferSize = 1 << 20;
+  string buffer;
+  for (vector<string>::iterator c = commands.begin(); c != commands.end();
+       ++c) {
+    buffer += *c;
+    buffer.push_back('\n');
+    if (buffer.size() >= kBufferSize) {
+      fwrite(buffer.data(), 1, buffer.size(), stdout);
+      buffer.clear();
+    }
+  }
+  fwrite(buffer.data(), 1, buffer.size(), stdout);
 
   return 0;
 }
@@ -663,17 +938,105 @@ int NinjaMain::ToolClean(const Options* options, int argc, char* argv[]) {
   }
 }
 
-void EncodeJSONString(const char *str) {
-  while (*str) {
-    if (*str == '"' || *str == '\\')
-      putchar('\\');
-    putchar(*str);
-    str++;
+int NinjaMain::ToolCleanDead(const Options* options, int argc, char* argv[]) {
+  // The cleandead tool uses getopt, and expects argv[0] to contain the name
+  // of the tool, i.e. "cleandead".
+  argc++;
+  argv--;
+
+  BuildConfig config = config_;
+  optind = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, const_cast<char*>("hnv"))) != -1) {
+    switch (opt) {
+    case 'n':
+      config.dry_run = true;
+      break;
+    case 'v':
+      config.verbosity = BuildConfig::VERBOSE;
+      break;
+    case 'h':
+    default:
+      printf("usage: ninja -t cleandead [options]\n"
+"\n"
+"options:\n"
+"  -n     only print the files that would be removed\n"
+"  -v     print each file removed\n"
+             );
+      return 1;
+    }
+  }
+  if (optind < argc) {
+    Error("cleandead takes no targets; unexpected '%s'", argv[optind]);
+    return 1;
+  }
+
+  string log_path = ".ninja_log";
+  if (!build_dir_.empty())
+    log_path = build_dir_ + "/" + log_path;
+
+  string err;
+  if (!build_log_.Load(log_path, &err)) {
+    Error("loading build log %s: %s", log_path.c_str(), err.c_str());
+    return 1;
   }
+  if (!err.empty()) {
+    Warning("%s", err.c_str());
+    err.clear();
+  }
+
+  Cleaner cleaner(&state_, config, &disk_interface_);
+  int status = cleaner.CleanDead(build_log_.entries());
+
+  // The removed outputs are gone from disk now, so recompacting drops
+  // their entries.  Those that couldn't be removed are kept, to try again.
+  if (!config.dry_run && !build_log_.entries().empty() &&
+      !build_log_.Recompact(log_path, *this, &err)) {
+    Error("failed recompaction: %s", err.c_str());
+    return 1;
+  }
+  return status;
 }
 
 int NinjaMain::ToolCompilationDatabase(const Options* options, int argc, char* argv[]) {
-  bool first = true;
+  // The compdb tool uses getopt, and expects argv[0] to contain the name of
+  // the tool, i.e. "compdb".
+  argc++;
+  argv--;
+
+  string output;
+  bool incremental = false;
+
+  optind = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, const_cast<char*>("+hio:"))) != -1) {
+    switch (opt) {
+    case 'i':
+      incremental = true;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    case 'h':
+    default:
+      printf("usage: ninja -t compdb [options] [rules]\n"
+"\n"
+"options:\n"
+"  -o FILE  write the database to FILE instead of stdout\n"
+"  -i       incremental: keep FILE's entries whose command is unchanged,\n"
+"           and leave FILE alone if no entry changed\n"
+             );
+    return 1;
+    }
+  }
+  argv += optind;
+  argc -= optind;
+
+  if (incremental && output.empty()) {
+    Error("-i needs -o FILE");
+    return 1;
+  }
+
   vector<char> cwd;
 
   do {
@@ -685,30 +1048,52 @@ int NinjaMain::ToolCompilationDatabase(const Options* options, int argc, char* a
     return 1;
   }
 
-  putchar('[');
+  vector<Edge*> edges;
   for (vector<Edge*>::iterator e = state_.edges_.begin();
        e != state_.edges_.end(); ++e) {
     if ((*e)->inputs_.empty())
       continue;
     for (int i = 0; i != argc; ++i) {
-      if ((*e)->rule_->name() == argv[i]) {
-        if (!first)
-          putchar(',');
-
-        printf("\n  {\n    \"directory\": \"");
-        EncodeJSONString(&cwd[0]);
-        printf("\",\n    \"command\": \"");
-        EncodeJSONString((*e)->EvaluateCommand().c_str());
-        printf("\",\n    \"file\": \"");
-        EncodeJSONString((*e)->inputs_[0]->path().c_str());
-        printf("\"\n  }");
-
-        first = false;
-      }
+      if ((*e)->rule_->name() == argv[i])
+        edges.push_back(*e);
     }
   }
 
-  puts("\n]");
+  CompilationDatabase database(&cwd[0]);
+  string previous, err;
+  if (incremental) {
+    // A missing or unreadable database is just written anew.
+    if (::ReadFile(output, &previous, &err) == 0 &&
+        !database.LoadPrevious(previous, &err)) {
+      Warning("%s: %s; rewriting it", output.c_str(), err.c_str());
+    }
+    err.clear();
+  }
+
+  vector<string> commands;
+  EvaluateCommands(edges, config_.parallelism, &commands);
+  for (size_t i = 0; i < edges.size(); ++i)
+    database.AddEntry(commands[i], edges[i]->inputs_[0]->path());
+  string contents = database.Finish();
+
+  if (output.empty()) {
+    fwrite(contents.data(), 1, contents.size(), stdout);
+    return 0;
+  }
+  if (incremental) {
+    printf("ninja: compdb: %d entries changed\n", database.changed());
+    if (database.changed() == 0 && contents == previous)
+      return 0;
+  }
+  // Replace the file in one step, so tools reading it never see half.
+  string temp = output + ".tmp";
+  if (!disk_interface_.WriteFile(temp, contents) ||
+      !RenameOverwriting(temp, output, &err)) {
+    if (!err.empty())
+      Error("%s", err.c_str());
+    unlink(temp.c_str());
+    return 1;
+  }
   return 0;
 }
 
@@ -723,6 +1108,136 @@ int NinjaMain::ToolRecompact(const Options* options, int argc, char* argv[]) {
   return 0;
 }
 
+int NinjaMain::ToolTrace(const Options* options, int argc, char* argv[]) {
+  string log_path = ".ninja_log";
+  string build_dir = state_.bindings_.LookupVariable("builddir");
+  if (!build_dir.empty())
+    log_path = build_dir + "/" + log_path;
+
+  // Only read the log; opening it for writing could recompact it.
+  BuildLog build_log;
+  string err;
+  if (!build_log.Load(log_path, &err)) {
+    Error("loading build log %s: %s", log_path.c_str(), err.c_str());
+    return 1;
+  }
+  if (!err.empty())
+    Warning("%s", err.c_str());
+
+  TraceWriter writer(stdout);
+  WriteBuildLogTrace(build_log, &writer);
+  if (!writer.Close()) {
+    Error("writing trace: %s", strerror(errno));
+    return 1;
+  }
+  return 0;
+}
+
+int NinjaMain::ToolSimulate(const Options* options, int argc, char* argv[]) {
+  // The simulate tool uses getopt, and expects argv[0] to contain the name of
+  // the tool, i.e. "simulate".
+  argc++;
+  argv--;
+
+  int parallelism = config_.parallelism;
+  optind = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, const_cast<char*>("hj:"))) != -1) {
+    switch (opt) {
+    case 'j': {
+      char* end;
+      parallelism = strtol(optarg, &end, 10);
+      if (*end != 0 || parallelism <= 0) {
+        Error("invalid -j parameter");
+        return 1;
+      }
+      break;
+    }
+    case 'h':
+    default:
+      printf("usage: ninja -t simulate [options] [targets]\n"
+"\n"
+"predict how long a clean build of the targets takes, using the command\n"
+"durations recorded in the build log.  Nothing is run.\n"
+"\n"
+"options:\n"
+"  -j N   simulate N jobs in parallel [default=%d]\n",
+             config_.parallelism);
+      return 1;
+    }
+  }
+  argv += optind;
+  argc -= optind;
+
+  vector<Node*> targets;
+  string err;
+  if (!CollectTargetsFromArgs(argc, argv, &targets, &err)) {
+    Error("%s", err.c_str());
+    return 1;
+  }
+
+  // Scanning loads the dependencies recorded in the deps log, which order
+  // the build as much as the manifest does, and catches cycles.
+  DependencyScan scan(&state_, &build_log_, &deps_log_, &disk_interface_);
+  BuildSimulator simulator(&state_, &build_log_);
+  for (vector<Node*>::iterator i = targets.begin(); i != targets.end(); ++i) {
+    if (!scan.RecomputeDirty(*i, &err)) {
+      Error("%s", err.c_str());
+      return 1;
+    }
+    simulator.AddTarget(*i);
+  }
+
+  SimulationResult result;
+  if (!simulator.Run(parallelism, &result, &err)) {
+    Error("%s", err.c_str());
+    return 1;
+  }
+  if (result.commands == 0) {
+    printf("ninja: no commands to simulate.\n");
+    return 0;
+  }
+
+  printf("simulated clean build of %d commands with -j %d:\n",
+         result.commands, parallelism);
+  printf("  wall time         %.3fs\n", result.wall_millis / 1e3);
+  printf("  command time      %.3fs\n", result.command_millis / 1e3);
+  if (result.wall_millis > 0) {
+    printf("  utilization       %.1f%% of %d jobs\n",
+           100.0 * result.command_millis / result.wall_millis / parallelism,
+           parallelism);
+  }
+
+  // With unlimited jobs, the chain of commands that ends last is the
+  // critical path.
+  SimulationResult flat;
+  SimulationResult unlimited;
+  int flat_parallelism =
+      simulator.FindFlatParallelism(0.05, &flat, &unlimited, &err);
+  if (!flat_parallelism) {
+    Error("%s", err.c_str());
+    return 1;
+  }
+  printf("  speedup flattens  past -j %d, at %.3fs\n", flat_parallelism,
+         flat.wall_millis / 1e3);
+
+  printf("  critical path     %.3fs, %d commands:\n",
+         unlimited.critical_path_millis / 1e3,
+         (int)unlimited.critical_path.size());
+  for (vector<Edge*>::iterator i = unlimited.critical_path.begin();
+       i != unlimited.critical_path.end(); ++i) {
+    printf("    %10.3fs  %s\n", simulator.Duration(*i) / 1e3,
+           (*i)->outputs_[0]->path().c_str());
+  }
+
+  if (simulator.unknown_commands()) {
+    printf("%d commands aren't in the build log; they were assumed to take "
+           "%.3fs, the average.\n", simulator.unknown_commands(),
+           simulator.unknown_duration_millis() / 1e3);
+  }
+  return 0;
+}
+
 int NinjaMain::ToolUrtle(const Options* options, int argc, char** argv) {
   // RLE encoded.
   const char* urtle =
@@ -755,7 +1270,7 @@ const Tool* ChooseTool(const string& tool_name) {
   static const Tool kTools[] = {
 #if defined(NINJA_HAVE_BROWSE)
     { "browse", "browse dependency graph in a web browser",
-      Tool::RUN_AFTER_LOAD, &NinjaMain::ToolBrowse },
+      Tool::RUN_AFTER_LOGS, &NinjaMain::ToolBrowse },
 #endif
 #if defined(_MSC_VER)
     { "msvc", "build helper for MSVC cl.exe (EXPERIMENTAL)",
@@ -763,6 +1278,8 @@ const Tool* ChooseTool(const string& tool_name) {
 #endif
     { "clean", "clean built files",
       Tool::RUN_AFTER_LOAD, &NinjaMain::ToolClean },
+    { "cleandead", "clean files the manifest no longer builds",
+      Tool::RUN_AFTER_LOAD, &NinjaMain::ToolCleanDead },
     { "commands", "list all commands required to rebuild given targets",
       Tool::RUN_AFTER_LOAD, &NinjaMain::ToolCommands },
     { "deps", "show dependencies stored in the deps log",
@@ -777,6 +1294,10 @@ const Tool* ChooseTool(const string& tool_name) {
       Tool::RUN_AFTER_LOAD, &NinjaMain::ToolCompilationDatabase },
     { "recompact",  "recompacts ninja-internal data structures",
       Tool::RUN_AFTER_LOAD, &NinjaMain::ToolRecompact },
+    { "trace",  "dump the last build's timings as Chrome trace JSON",
+      Tool::RUN_AFTER_LOAD, &NinjaMain::ToolTrace },
+    { "simulate",  "predict the time of a clean build from the build log",
+      Tool::RUN_AFTER_LOGS, &NinjaMain::ToolSimulate },
     { "urtle", NULL,
       Tool::RUN_AFTER_FLAGS, &NinjaMain::ToolUrtle },
     { NULL, NULL, Tool::RUN_AFTER_FLAGS, NULL }
@@ -825,6 +1346,7 @@ bool DebugEnable(const string& name) {
     return false;
   } else if (name == "stats") {
     g_metrics = new Metrics;
+    g_print_stats = true;
     return true;
   } else if (name == "explain") {
     g_explaining = true;
@@ -911,6 +1433,7 @@ bool NinjaMain::OpenBuildLog(bool recompact_only) {
   }
 
   if (!config_.dry_run) {
+    build_log_.set_background_recompaction(true);
     if (!build_log_.OpenForWrite(log_path, *this, &err)) {
       Error("opening build log: %s", err.c_str());
       return false;
@@ -946,6 +1469,7 @@ bool NinjaMain::OpenDepsLog(bool recompact_only) {
   }
 
   if (!config_.dry_run) {
+    deps_log_.set_background_recompaction(true);
     if (!deps_log_.OpenForWrite(path, &err)) {
       Error("opening deps log: %s", err.c_str());
       return false;
@@ -985,10 +1509,22 @@ int NinjaMain::RunBuild(int argc, char** argv, Status* status) {
     return 1;
   }
 
+  // The targets are known, so aliases that become roots don't add to them.
+  if (config_.collapse_phony) {
+    int nodes, edges;
+    state_.CollapsePhonyAliases(&nodes, &edges);
+    if (config_.verbosity == BuildConfig::VERBOSE) {
+      status->Info("collapsed %d phony aliases and %d phony edges",
+                   nodes, edges);
+    }
+  }
+
   disk_interface_.AllowStatCache(g_experimental_statcache);
 
   Builder builder(&state_, config_, &build_log_, &deps_log_, &disk_interface_,
                   status, start_time_millis_);
+  builder.set_trace(trace_);
+  int64_t scan_start_millis = GetTimeMillis();
   for (size_t i = 0; i < targets.size(); ++i) {
     if (!builder.AddTarget(targets[i], &err)) {
       if (!err.empty()) {
@@ -1003,13 +1539,19 @@ int NinjaMain::RunBuild(int argc, char** argv, Status* status) {
 
   // Make sure restat rules do not see stale timestamps.
   disk_interface_.AllowStatCache(false);
+  if (trace_)
+    trace_->Phase("scan", scan_start_millis);
 
   if (builder.AlreadyUpToDate()) {
     status->Info("no work to do.");
     return 0;
   }
 
-  if (!builder.Build(&err)) {
+  int64_t build_start_millis = GetTimeMillis();
+  bool success = builder.Build(&err);
+  if (trace_)
+    trace_->Phase("build", build_start_millis);
+  if (!success) {
     status->Info("build stopped: %s.", err.c_str());
     if (err.find("interrupted by user") != string::npos) {
       return 2;
@@ -1052,12 +1594,26 @@ int ReadFlags(int* argc, char*** argv,
   enum {
     OPT_VERSION = 1,
     OPT_FRONTEND = 2,
+    OPT_MKDIRS = 3,
+    OPT_TRACE = 4,
+    OPT_STATS_JSON = 5,
+    OPT_ADAPTIVE_JOBS = 6,
+    OPT_CGROUP = 7,
+    OPT_COLLAPSE_PHONY = 8,
   };
   const option kLongOptions[] = {
 #ifndef _WIN32
     { "frontend", required_argument, NULL, OPT_FRONTEND },
 #endif
+    { "adaptive-jobs", no_argument, NULL, OPT_ADAPTIVE_JOBS },
+#ifndef _WIN32
+    { "cgroup", required_argument, NULL, OPT_CGROUP },
+#endif
+    { "collapse-phony", no_argument, NULL, OPT_COLLAPSE_PHONY },
     { "help", no_argument, NULL, 'h' },
+    { "mkdirs", no_argument, NULL, OPT_MKDIRS },
+    { "stats-json", required_argument, NULL, OPT_STATS_JSON },
+    { "trace", required_argument, NULL, OPT_TRACE },
     { "version", no_argument, NULL, OPT_VERSION },
     { NULL, 0, NULL, 0 }
   };
@@ -1125,6 +1681,27 @@ int ReadFlags(int* argc, char*** argv,
         return 0;
       case OPT_FRONTEND:
         config->frontend = optarg;
+        // Frontends get the output of running commands a few times a
+        // second, rather than all of it once they finish.
+        config->partial_output_millis = 250;
+        break;
+      case OPT_MKDIRS:
+        config->make_dirs_upfront = true;
+        break;
+      case OPT_TRACE:
+        options->trace_path = optarg;
+        break;
+      case OPT_STATS_JSON:
+        options->stats_json_path = optarg;
+        break;
+      case OPT_ADAPTIVE_JOBS:
+        config->adaptive_parallelism = true;
+        break;
+      case OPT_CGROUP:
+        config->cgroup_parent = optarg;
+        break;
+      case OPT_COLLAPSE_PHONY:
+        config->collapse_phony = true;
         break;
       case 'h':
       default:
@@ -1150,6 +1727,11 @@ int real_main(int argc, char** argv) {
   if (exit_code >= 0)
     return exit_code;
 
+  // --stats-json collects the same metrics as -d stats, without the table.
+  bool print_metrics = g_metrics != NULL;
+  if (options.stats_json_path && !g_metrics)
+    g_metrics = new Metrics;
+
   if (options.working_dir) {
     // The formatting of this string, complete with funny quotes, is
     // so Emacs can properly identify that the cwd has changed for
@@ -1173,10 +1755,21 @@ int real_main(int argc, char** argv) {
 
   Status* status = NULL;
 
+  BuildTrace trace;
+  if (options.trace_path) {
+    string err;
+    if (!trace.Open(options.trace_path, &err)) {
+      Error("opening trace %s: %s", options.trace_path, err.c_str());
+      return 1;
+    }
+  }
+
   // Limit number of rebuilds, to prevent infinite loops.
   const int kCycleLimit = 100;
   for (int cycle = 1; cycle <= kCycleLimit; ++cycle) {
     NinjaMain ninja(ninja_command, config);
+    if (options.trace_path)
+      ninja.trace_ = &trace;
 
     ManifestParserOptions parser_opts;
     if (options.dupe_edges_should_err) {
@@ -1187,10 +1780,12 @@ int real_main(int argc, char** argv) {
     }
     ManifestParser parser(&ninja.state_, &ninja.disk_interface_, parser_opts);
     string err;
+    int64_t phase_start_millis = GetTimeMillis();
     if (!parser.Load(options.input_file, &err)) {
       status->Error("%s", err.c_str());
       return 1;
     }
+    trace.Phase("load manifest", phase_start_millis);
 
     if (options.tool && options.tool->when == Tool::RUN_AFTER_LOAD)
       return (ninja.*options.tool->func)(&options, argc, argv);
@@ -1198,8 +1793,10 @@ int real_main(int argc, char** argv) {
     if (!ninja.EnsureBuildDirExists())
       return 1;
 
+    phase_start_millis = GetTimeMillis();
     if (!ninja.OpenBuildLog() || !ninja.OpenDepsLog())
       return 1;
+    trace.Phase("load logs", phase_start_millis);
 
     if (options.tool && options.tool->when == Tool::RUN_AFTER_LOGS)
       return (ninja.*options.tool->func)(&options, argc, argv);
@@ -1227,8 +1824,17 @@ int real_main(int argc, char** argv) {
     }
 
     int result = ninja.RunBuild(argc, argv, status);
-    if (g_metrics)
+    if (print_metrics)
       ninja.DumpMetrics();
+    if (options.stats_json_path &&
+        !g_metrics->ReportJSON(options.stats_json_path, &err)) {
+      Error("writing %s: %s", options.stats_json_path, err.c_str());
+      result = 1;
+    }
+    if (!trace.Close(&err)) {
+      Error("%s", err.c_str());
+      result = 1;
+    }
 
     delete status;
     return result;
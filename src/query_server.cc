@@ -0,0 +1,329 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "query_server.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "deps_log.h"
+#include "graph.h"
+#include "json.h"
+#include "metrics.h"
+#include "state.h"
+#include "util.h"
+
+namespace {
+
+void AppendPathList(vector<Node*>::const_iterator begin,
+                    vector<Node*>::const_iterator end, string* out) {
+  out->push_back('[');
+  for (vector<Node*>::const_iterator i = begin; i != end; ++i) {
+    if (i != begin)
+      *out += ", ";
+    AppendJSONString((*i)->path(), out);
+  }
+  out->push_back(']');
+}
+
+/// Write all of \a data to \a fd.
+bool WriteAll(int fd, const string& data, string* err) {
+  for (size_t written = 0; written < data.size(); ) {
+    int n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      *err = string("write: ") + strerror(errno);
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+#ifndef _WIN32
+/// Answer the requests of one client of ServeSocket() until it hangs up.
+void ServeClient(QueryServer* server, int client) {
+  string err;
+  if (!server->Serve(client, client, &err))
+    Warning("query client: %s", err.c_str());
+  close(client);
+}
+#endif
+
+}  // anonymous namespace
+
+void QueryServer::Answer(const string& request, string* response) {
+  METRIC_RECORD("query");
+  map<string, JSONValue> fields;
+  string err;
+  string result;
+  Node* node = NULL;
+  if (!ParseFlatJSONObject(request, &fields, &err)) {
+    err = "bad request: " + err;
+  } else if (!fields.count("query") || !fields["query"].is_string) {
+    err = "missing 'query'";
+  } else if ((node = LookupTarget(fields, &err))) {
+    const string& query = fields["query"].str;
+    if (query == "inputs") {
+      AppendInputs(node, &result);
+    } else if (query == "outputs") {
+      AppendOutputs(node, &result);
+    } else if (query == "reverse") {
+      AppendReverse(node, fields["transitive"].raw == "true", &result);
+    } else if (query == "deps") {
+      AppendDeps(node, &result, &err);
+    } else if (query == "commands") {
+      AppendCommands(node, &result);
+    } else {
+      err = "unknown query '" + query + "'";
+    }
+  }
+
+  *response += "{";
+  map<string, JSONValue>::iterator id = fields.find("id");
+  if (id != fields.end())
+    *response += "\"id\": " + id->second.raw + ", ";
+  if (node) {
+    *response += "\"target\": ";
+    AppendJSONString(node->path(), response);
+    *response += ", ";
+  }
+  if (err.empty()) {
+    *response += "\"result\": " + result;
+  } else {
+    *response += "\"error\": ";
+    AppendJSONString(err, response);
+  }
+  *response += "}\n";
+}
+
+Node* QueryServer::LookupTarget(const map<string, JSONValue>& request,
+                                string* err) {
+  map<string, JSONValue>::const_iterator target = request.find("target");
+  if (target == request.end() || !target->second.is_string) {
+    *err = "missing 'target'";
+    return NULL;
+  }
+  string path = target->second.str;
+  uint64_t slash_bits;
+  if (!CanonicalizePath(&path, &slash_bits, err))
+    return NULL;
+  Node* node = state_->LookupNode(path);
+  if (!node) {
+    *err = "unknown target '" + target->second.str + "'";
+    if (Node* suggestion = state_->SpellcheckNode(path))
+      *err += ", did you mean '" + suggestion->path() + "'?";
+  }
+  return node;
+}
+
+void QueryServer::AppendInputs(Node* node, string* result) {
+  Edge* edge = node->in_edge();
+  if (!edge) {
+    *result += "{\"rule\": null, \"explicit\": [], \"implicit\": [], "
+               "\"order_only\": []}";
+    return;
+  }
+  vector<Node*>::const_iterator explicit_end =
+      edge->inputs_.end() - edge->implicit_deps_ - edge->order_only_deps_;
+  vector<Node*>::const_iterator implicit_end =
+      edge->inputs_.end() - edge->order_only_deps_;
+  *result += "{\"rule\": ";
+  AppendJSONString(edge->rule().name(), result);
+  *result += ", \"explicit\": ";
+  AppendPathList(edge->inputs_.begin(), explicit_end, result);
+  *result += ", \"implicit\": ";
+  AppendPathList(explicit_end, implicit_end, result);
+  *result += ", \"order_only\": ";
+  AppendPathList(implicit_end, edge->inputs_.end(), result);
+  *result += "}";
+}
+
+void QueryServer::AppendOutputs(Node* node, string* result) {
+  Edge* edge = node->in_edge();
+  if (!edge) {
+    *result += "{\"explicit\": [], \"implicit\": []}";
+    return;
+  }
+  vector<Node*>::const_iterator explicit_end =
+      edge->outputs_.end() - edge->implicit_outs_;
+  *result += "{\"explicit\": ";
+  AppendPathList(edge->outputs_.begin(), explicit_end, result);
+  *result += ", \"implicit\": ";
+  AppendPathList(explicit_end, edge->outputs_.end(), result);
+  *result += "}";
+}
+
+void QueryServer::AppendReverse(Node* node, bool transitive, string* result) {
+  // Breadth first, so that the closest dependents come first.
+  vector<Node*> dependents;
+  set<Node*> seen;
+  seen.insert(node);
+  vector<Node*> queue(1, node);
+  for (size_t next = 0; next < queue.size(); ++next) {
+    const vector<Edge*>& out_edges = queue[next]->out_edges();
+    for (vector<Edge*>::const_iterator e = out_edges.begin();
+         e != out_edges.end(); ++e) {
+      for (vector<Node*>::iterator o = (*e)->outputs_.begin();
+           o != (*e)->outputs_.end(); ++o) {
+        if (!seen.insert(*o).second)
+          continue;
+        dependents.push_back(*o);
+        if (transitive)
+          queue.push_back(*o);
+      }
+    }
+  }
+  AppendPathList(dependents.begin(), dependents.end(), result);
+}
+
+bool QueryServer::AppendDeps(Node* node, string* result, string* err) {
+  DepsLog::Deps* deps = deps_log_ ? deps_log_->GetDeps(node) : NULL;
+  if (!deps) {
+    *err = "no deps recorded for '" + node->path() + "'";
+    return false;
+  }
+  char mtime[32];
+  snprintf(mtime, sizeof(mtime), "%d", (int)deps->mtime);
+  *result += string("{\"mtime\": ") + mtime + ", \"deps\": ";
+  vector<Node*> nodes(deps->nodes, deps->nodes + deps->node_count);
+  AppendPathList(nodes.begin(), nodes.end(), result);
+  *result += "}";
+  return true;
+}
+
+void QueryServer::AppendCommands(Node* node, string* result) {
+  // Each edge's inputs come before it, as in -t commands.  Walk with a
+  // stack of edges and the next input to look at, so deep graphs don't
+  // run out of call stack.
+  result->push_back('[');
+  set<Edge*> seen;
+  vector<pair<Edge*, size_t> > stack;
+  if (Edge* edge = node->in_edge()) {
+    seen.insert(edge);
+    stack.push_back(make_pair(edge, (size_t)0));
+  }
+  bool first = true;
+  while (!stack.empty()) {
+    Edge* edge = stack.back().first;
+    size_t& next_input = stack.back().second;
+    if (next_input < edge->inputs_.size()) {
+      Edge* in_edge = edge->inputs_[next_input++]->in_edge();
+      if (in_edge && seen.insert(in_edge).second)
+        stack.push_back(make_pair(in_edge, (size_t)0));
+      continue;
+    }
+    stack.pop_back();
+    if (edge->is_phony())
+      continue;
+    if (!first)
+      *result += ", ";
+    first = false;
+    AppendJSONString(edge->EvaluateCommand(), result);
+  }
+  result->push_back(']');
+}
+
+bool QueryServer::Serve(int in_fd, int out_fd, string* err) {
+  string input;
+  char buf[64 << 10];
+  for (;;) {
+    int n = read(in_fd, buf, sizeof(buf));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      *err = string("read: ") + strerror(errno);
+      return false;
+    }
+    if (n == 0)
+      return true;
+    input.append(buf, n);
+
+    // Answer every complete line read so far before writing any of it.
+    string output;
+    size_t start = 0;
+    for (size_t end; (end = input.find('\n', start)) != string::npos;
+         start = end + 1) {
+      size_t line_end = end;
+      if (line_end > start && input[line_end - 1] == '\r')
+        --line_end;
+      if (line_end > start)
+        Answer(input.substr(start, line_end - start), &output);
+    }
+    input.erase(0, start);
+    if (!WriteAll(out_fd, output, err))
+      return false;
+  }
+}
+
+#ifndef _WIN32
+bool QueryServer::ServeSocket(const string& path, string* err) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    *err = "socket path too long: " + path;
+    return false;
+  }
+  strcpy(addr.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    *err = string("socket: ") + strerror(errno);
+    return false;
+  }
+  // A socket left behind by an earlier server is in the way.
+  struct stat st;
+  if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path.c_str());
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+    *err = path + ": " + strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  // A client that goes away mid-response only ends its own connection.
+  signal(SIGPIPE, SIG_IGN);
+  for (;;) {
+    int client = accept(fd, NULL, NULL);
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      *err = string("accept: ") + strerror(errno);
+      close(fd);
+      return false;
+    }
+    // Queries only read the graph, so clients can be answered at once.
+    std::thread(ServeClient, this, client).detach();
+  }
+}
+#endif  // _WIN32
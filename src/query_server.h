@@ -0,0 +1,71 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NINJA_QUERY_SERVER_H_
+#define NINJA_QUERY_SERVER_H_
+
+#include <map>
+#include <string>
+using namespace std;
+
+struct DepsLog;
+struct JSONValue;
+struct Node;
+struct State;
+
+/// Answers questions about a loaded build graph, so that tools such as
+/// IDEs don't have to start Ninja, and load the manifest and logs, for
+/// each one.  Requests and responses are JSON objects, one per line:
+///
+///   {"id": 1, "query": "inputs", "target": "foo.o"}
+///   {"id": 1, "target": "foo.o", "result": {"rule": "cc", ...}}
+///
+/// The queries are "inputs", "outputs", "reverse" (what uses the target;
+/// with "transitive": true, everything that does, however indirectly),
+/// "deps" (from the deps log) and "commands" (to build the target, in
+/// order).  A request that can't be answered gets an "error" string.
+struct QueryServer {
+  QueryServer(State* state, DepsLog* deps_log)
+      : state_(state), deps_log_(deps_log) {}
+
+  /// Append the response to \a request, and a newline, to \a response.
+  void Answer(const string& request, string* response);
+
+  /// Answer the requests read from \a in_fd on \a out_fd until \a in_fd
+  /// ends.  Responses to requests that arrive together are written
+  /// together.  Returns false on a read or write error.
+  bool Serve(int in_fd, int out_fd, string* err);
+
+#ifndef _WIN32
+  /// Listen on the unix domain socket \a path, and serve the clients that
+  /// connect, each on a thread of its own.  Only returns on error.
+  bool ServeSocket(const string& path, string* err);
+#endif
+
+ private:
+  /// Find the node for the "target" of a request.
+  Node* LookupTarget(const map<string, JSONValue>& request, string* err);
+
+  void AppendInputs(Node* node, string* result);
+  void AppendOutputs(Node* node, string* result);
+  void AppendReverse(Node* node, bool transitive, string* result);
+  bool AppendDeps(Node* node, string* result, string* err);
+  void AppendCommands(Node* node, string* result);
+
+  State* state_;
+  DepsLog* deps_log_;
+};
+
+#endif  // NINJA_QUERY_SERVER_H_
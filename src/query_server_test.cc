@@ -0,0 +1,231 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "query_server.h"
+
+#include "deps_log.h"
+#include "graph.h"
+#include "state.h"
+#include "test.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kTestDepsLog[] = "QueryServerTest-deps";
+const char kTestSocket[] = "QueryServerTest-socket";
+
+#ifndef _WIN32
+/// Connect to the unix domain socket \a path, giving a server that is
+/// starting up a few seconds to listen.  Returns -1 on failure.
+int ConnectTo(const char* path) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  for (int attempt = 0; attempt < 500; ++attempt) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      return -1;
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0)
+      return fd;
+    close(fd);
+    usleep(10 * 1000);
+  }
+  return -1;
+}
+
+/// Send \a request and a newline on \a fd, and read back a line, waiting
+/// a few seconds at most.
+string Request(int fd, const string& request) {
+  string line = request + "\n";
+  if (write(fd, line.data(), line.size()) != (int)line.size())
+    return "write failed";
+  string response;
+  while (response.empty() || response[response.size() - 1] != '\n') {
+    pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 5000) <= 0)
+      return "timed out: " + response;
+    char buf[512];
+    int n = read(fd, buf, sizeof(buf));
+    if (n <= 0)
+      return "read failed: " + response;
+    response.append(buf, n);
+  }
+  return response;
+}
+#endif
+
+struct QueryServerTest : public StateTestWithBuiltinRules {
+  QueryServerTest() : server_(&state_, &deps_log_) {}
+
+  virtual void SetUp() {
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"rule cc\n"
+"  command = cc $in -o $out\n"
+"build foo.o | foo.d: cc foo.c | gen.h || dir\n"
+"build gen.h: cat gen.in\n"
+"build dir: phony\n"
+"build app: cat foo.o bar.o\n"
+"build bar.o: cc bar.c\n"));
+  }
+
+  virtual void TearDown() {
+    unlink(kTestDepsLog);
+    unlink(kTestSocket);
+  }
+
+  string Ask(const string& request) {
+    string response;
+    server_.Answer(request, &response);
+    return response;
+  }
+
+  DepsLog deps_log_;
+  QueryServer server_;
+};
+
+TEST_F(QueryServerTest, Inputs) {
+  EXPECT_EQ("{\"id\": 7, \"target\": \"foo.o\", \"result\": "
+            "{\"rule\": \"cc\", \"explicit\": [\"foo.c\"], "
+            "\"implicit\": [\"gen.h\"], \"order_only\": [\"dir\"]}}\n",
+            Ask("{\"id\": 7, \"query\": \"inputs\", \"target\": \"foo.o\"}"));
+  EXPECT_EQ("{\"target\": \"foo.c\", \"result\": "
+            "{\"rule\": null, \"explicit\": [], \"implicit\": [], "
+            "\"order_only\": []}}\n",
+            Ask("{\"query\": \"inputs\", \"target\": \"./foo.c\"}"));
+}
+
+TEST_F(QueryServerTest, Outputs) {
+  EXPECT_EQ("{\"id\": \"x\", \"target\": \"foo.o\", \"result\": "
+            "{\"explicit\": [\"foo.o\"], \"implicit\": [\"foo.d\"]}}\n",
+            Ask("{\"id\": \"x\", \"query\": \"outputs\", "
+                "\"target\": \"foo.o\"}"));
+}
+
+TEST_F(QueryServerTest, Reverse) {
+  EXPECT_EQ("{\"target\": \"gen.h\", \"result\": [\"foo.o\", \"foo.d\"]}\n",
+            Ask("{\"query\": \"reverse\", \"target\": \"gen.h\"}"));
+  EXPECT_EQ("{\"target\": \"gen.h\", \"result\": "
+            "[\"foo.o\", \"foo.d\", \"app\"]}\n",
+            Ask("{\"query\": \"reverse\", \"target\": \"gen.h\", "
+                "\"transitive\": true}"));
+}
+
+TEST_F(QueryServerTest, Commands) {
+  EXPECT_EQ("{\"target\": \"app\", \"result\": "
+            "[\"cat gen.in > gen.h\", \"cc foo.c -o foo.o\", "
+            "\"cc bar.c -o bar.o\", \"cat foo.o bar.o > app\"]}\n",
+            Ask("{\"query\": \"commands\", \"target\": \"app\"}"));
+}
+
+TEST_F(QueryServerTest, Deps) {
+  EXPECT_EQ("{\"target\": \"bar.o\", "
+            "\"error\": \"no deps recorded for 'bar.o'\"}\n",
+            Ask("{\"query\": \"deps\", \"target\": \"bar.o\"}"));
+
+  string err;
+  ASSERT_TRUE(deps_log_.OpenForWrite(kTestDepsLog, &err));
+  vector<Node*> deps;
+  deps.push_back(GetNode("bar.h"));
+  ASSERT_TRUE(deps_log_.RecordDeps(GetNode("bar.o"), 5, deps));
+  deps_log_.Close();
+  EXPECT_EQ("{\"target\": \"bar.o\", \"result\": "
+            "{\"mtime\": 5, \"deps\": [\"bar.h\"]}}\n",
+            Ask("{\"query\": \"deps\", \"target\": \"bar.o\"}"));
+}
+
+TEST_F(QueryServerTest, Errors) {
+  EXPECT_EQ("{\"error\": \"bad request: expected '{'\"}\n", Ask("inputs"));
+  EXPECT_EQ("{\"id\": 1, \"error\": \"missing 'query'\"}\n",
+            Ask("{\"id\": 1}"));
+  EXPECT_EQ("{\"error\": \"missing 'target'\"}\n",
+            Ask("{\"query\": \"inputs\"}"));
+  EXPECT_EQ("{\"error\": \"unknown target 'fooo.o', "
+            "did you mean 'foo.o'?\"}\n",
+            Ask("{\"query\": \"inputs\", \"target\": \"fooo.o\"}"));
+  EXPECT_EQ("{\"target\": \"foo.o\", "
+            "\"error\": \"unknown query 'everything'\"}\n",
+            Ask("{\"query\": \"everything\", \"target\": \"foo.o\"}"));
+}
+
+#ifndef _WIN32
+TEST_F(QueryServerTest, Serve) {
+  int requests[2], responses[2];
+  ASSERT_EQ(0, pipe(requests));
+  ASSERT_EQ(0, pipe(responses));
+  const char kRequests[] =
+      "{\"id\": 1, \"query\": \"outputs\", \"target\": \"bar.o\"}\r\n"
+      "\n"
+      "{\"id\": 2, \"query\": \"reverse\", \"target\": \"bar.o\"}";
+  ASSERT_EQ((int)sizeof(kRequests) - 1,
+            write(requests[1], kRequests, sizeof(kRequests) - 1));
+  close(requests[1]);
+
+  string err;
+  EXPECT_TRUE(server_.Serve(requests[0], responses[1], &err));
+  close(requests[0]);
+  close(responses[1]);
+
+  // The last request has no newline, so it is never complete.
+  char buf[512];
+  int n = read(responses[0], buf, sizeof(buf));
+  close(responses[0]);
+  ASSERT_LT(0, n);
+  EXPECT_EQ("{\"id\": 1, \"target\": \"bar.o\", \"result\": "
+            "{\"explicit\": [\"bar.o\"], \"implicit\": []}}\n",
+            string(buf, n));
+}
+
+TEST_F(QueryServerTest, ServeSocketClientsAtOnce) {
+  pid_t pid = fork();
+  ASSERT_LE(0, pid);
+  if (pid == 0) {
+    string err;
+    server_.ServeSocket(kTestSocket, &err);
+    _exit(1);
+  }
+
+  // The first client stays connected while the second is answered.
+  const string kRequest = "{\"query\": \"outputs\", \"target\": \"bar.o\"}";
+  const string kResponse = "{\"target\": \"bar.o\", \"result\": "
+      "{\"explicit\": [\"bar.o\"], \"implicit\": []}}\n";
+  int first = ConnectTo(kTestSocket);
+  int second = ConnectTo(kTestSocket);
+  EXPECT_LE(0, first);
+  EXPECT_LE(0, second);
+  if (first >= 0 && second >= 0) {
+    EXPECT_EQ(kResponse, Request(first, kRequest));
+    EXPECT_EQ(kResponse, Request(second, kRequest));
+    EXPECT_EQ(kResponse, Request(first, kRequest));
+  }
+  close(first);
+  close(second);
+
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+}
+#endif
+
+}  // anonymous namespace
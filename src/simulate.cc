@@ -0,0 +1,254 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "simulate.h"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+
+#include "build.h"
+#include "build_log.h"
+#include "graph.h"
+#include "state.h"
+
+namespace {
+
+/// A command that runs until \a end_millis.
+struct SimulatedCommand {
+  int64_t end_millis;
+  Edge* edge;
+
+  /// priority_queue pops the largest element, which should be the command
+  /// that finishes first.  Ties go to the edge declared first, to keep the
+  /// simulation deterministic.
+  bool operator<(const SimulatedCommand& other) const {
+    if (end_millis != other.end_millis)
+      return end_millis > other.end_millis;
+    return edge->id_ > other.edge->id_;
+  }
+};
+
+/// A CommandRunner on a virtual clock: starting a command only notes when
+/// it will be done, and waiting for one advances the clock to that time.
+struct SimulatedCommandRunner : public CommandRunner {
+  SimulatedCommandRunner(const BuildSimulator* simulator, int parallelism)
+      : simulator_(simulator), parallelism_(parallelism), now_(0) {}
+  virtual ~SimulatedCommandRunner() {}
+  virtual bool CanRunMore();
+  virtual bool StartCommand(Edge* edge);
+  virtual bool WaitForCommand(Result* result);
+
+  int64_t now() const { return now_; }
+
+ private:
+  const BuildSimulator* simulator_;
+  int parallelism_;
+  int64_t now_;
+  priority_queue<SimulatedCommand> running_;
+};
+
+bool SimulatedCommandRunner::CanRunMore() {
+  return (int)running_.size() < parallelism_;
+}
+
+bool SimulatedCommandRunner::StartCommand(Edge* edge) {
+  SimulatedCommand command = { now_ + simulator_->Duration(edge), edge };
+  running_.push(command);
+  return true;
+}
+
+bool SimulatedCommandRunner::WaitForCommand(Result* result) {
+  if (running_.empty())
+    return false;
+  now_ = running_.top().end_millis;
+  result->edge = running_.top().edge;
+  result->status = ExitSuccess;
+  running_.pop();
+  return true;
+}
+
+/// Let the edges after the dyndep files the simulation "built" go ahead.
+/// The files may not exist, so the edges run with what the manifest says.
+bool ReleaseDyndeps(Plan* plan, string* err) {
+  while (Node* dyndep = plan->NextBuiltDyndep()) {
+    if (!plan->DyndepsLoaded(NULL, dyndep, DyndepFile(), err))
+      return false;
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+BuildSimulator::BuildSimulator(State* state, BuildLog* build_log)
+    : state_(state), build_log_(build_log), command_count_(0),
+      unknown_commands_(0), unknown_duration_millis_(0) {}
+
+void BuildSimulator::AddTarget(Node* target) {
+  targets_.push_back(target);
+
+  set<Edge*> seen;
+  vector<Node*> stack(1, target);
+  while (!stack.empty()) {
+    Node* node = stack.back();
+    stack.pop_back();
+    Edge* edge = node->in_edge();
+    // Sources are there; everything else has yet to be built.
+    node->set_dirty(edge != NULL);
+    if (!edge || !seen.insert(edge).second)
+      continue;
+    stack.insert(stack.end(), edge->inputs_.begin(), edge->inputs_.end());
+
+    if (edge->is_phony() || durations_.count(edge))
+      continue;
+    ++command_count_;
+    BuildLog::LogEntry* entry =
+        build_log_ ? build_log_->LookupByOutput(edge->outputs_[0]->path())
+                   : NULL;
+    if (entry)
+      durations_[edge] = entry->end_time - entry->start_time;
+    else
+      ++unknown_commands_;
+  }
+
+  int64_t total = 0;
+  for (map<Edge*, int64_t>::iterator i = durations_.begin();
+       i != durations_.end(); ++i) {
+    total += i->second;
+  }
+  unknown_duration_millis_ = durations_.empty() ? 0 : total / durations_.size();
+}
+
+int64_t BuildSimulator::Duration(Edge* edge) const {
+  map<Edge*, int64_t>::const_iterator i = durations_.find(edge);
+  return i != durations_.end() ? i->second : unknown_duration_millis_;
+}
+
+bool BuildSimulator::Run(int parallelism, SimulationResult* result,
+                         string* err) {
+  *result = SimulationResult();
+
+  // Nothing is built before the simulation starts.
+  for (vector<Edge*>::iterator e = state_->edges_.begin();
+       e != state_->edges_.end(); ++e) {
+    (*e)->outputs_ready_ = false;
+  }
+
+  Plan plan;
+  for (vector<Node*>::iterator i = targets_.begin(); i != targets_.end(); ++i) {
+    if (!plan.AddTarget(*i, err) && !err->empty())
+      return false;
+  }
+  plan.ComputeCriticalTimes(build_log_);
+
+  SimulatedCommandRunner runner(this, parallelism);
+  // When each edge finished, and the edge it waited for last before it
+  // could start.
+  map<Edge*, int64_t> finished;
+  map<Edge*, Edge*> waited_for;
+  Edge* last = NULL;
+
+  while (plan.more_to_do()) {
+    if (runner.CanRunMore()) {
+      if (Edge* edge = plan.FindWork()) {
+        int64_t ready_millis = 0;
+        Edge* before = NULL;
+        for (vector<Node*>::iterator i = edge->inputs_.begin();
+             i != edge->inputs_.end(); ++i) {
+          map<Edge*, int64_t>::iterator input =
+              finished.find((*i)->in_edge());
+          if (input != finished.end() &&
+              (!before || input->second > ready_millis)) {
+            ready_millis = input->second;
+            before = input->first;
+          }
+        }
+        if (before)
+          waited_for[edge] = before;
+
+        // Phony edges finish as soon as their inputs do.
+        if (edge->is_phony()) {
+          finished[edge] = ready_millis;
+          plan.EdgeFinished(edge, Plan::kEdgeSucceeded);
+          if (!ReleaseDyndeps(&plan, err))
+            return false;
+          continue;
+        }
+
+        runner.StartCommand(edge);
+        ++result->commands;
+        result->command_millis += Duration(edge);
+        continue;
+      }
+    }
+
+    CommandRunner::Result command;
+    if (!runner.WaitForCommand(&command)) {
+      *err = "simulated build stuck [this is a bug]";
+      return false;
+    }
+    finished[command.edge] = runner.now();
+    last = command.edge;
+    plan.EdgeFinished(command.edge, Plan::kEdgeSucceeded);
+    if (!ReleaseDyndeps(&plan, err))
+      return false;
+  }
+
+  result->wall_millis = runner.now();
+  for (Edge* edge = last; edge; ) {
+    if (!edge->is_phony()) {
+      result->critical_path.push_back(edge);
+      result->critical_path_millis += Duration(edge);
+    }
+    map<Edge*, Edge*>::iterator i = waited_for.find(edge);
+    edge = i != waited_for.end() ? i->second : NULL;
+  }
+  reverse(result->critical_path.begin(), result->critical_path.end());
+  return true;
+}
+
+int BuildSimulator::FindFlatParallelism(double slack, SimulationResult* result,
+                                        SimulationResult* fastest,
+                                        string* err) {
+  // With a job for every command, nothing ever waits for a free job.
+  if (!Run(max(command_count_, 1), fastest, err))
+    return 0;
+  int64_t good_enough = (int64_t)(fastest->wall_millis * (1 + slack));
+
+  // Double the jobs until the build is fast enough, then narrow it down.
+  // Adding jobs can, rarely, make a schedule slower, so this finds a
+  // parallelism that is good enough rather than the smallest one.
+  int high = 1;
+  for (;;) {
+    if (!Run(high, result, err))
+      return 0;
+    if (result->wall_millis <= good_enough)
+      break;
+    high *= 2;
+  }
+  SimulationResult candidate;
+  int low = high / 2 + 1;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (!Run(mid, &candidate, err))
+      return 0;
+    if (candidate.wall_millis <= good_enough) {
+      high = mid;
+      *result = candidate;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return high;
+}
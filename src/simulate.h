@@ -0,0 +1,90 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NINJA_SIMULATE_H_
+#define NINJA_SIMULATE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "util.h"  // int64_t
+
+struct BuildLog;
+struct Edge;
+struct Node;
+struct State;
+
+/// The predicted timings of a simulated build.
+struct SimulationResult {
+  SimulationResult()
+      : commands(0), wall_millis(0), command_millis(0),
+        critical_path_millis(0) {}
+
+  /// Number of commands run.
+  int commands;
+  /// Time from the start of the build until the last command finished.
+  int64_t wall_millis;
+  /// Sum of the durations of all commands.
+  int64_t command_millis;
+  /// The chain of commands, each waiting for the one before it, that ended
+  /// last, from first to last.  With enough jobs this is the critical path.
+  vector<Edge*> critical_path;
+  int64_t critical_path_millis;
+};
+
+/// Predicts how long a clean build of some targets would take, by running
+/// a Plan against a CommandRunner that doesn't spawn anything: each command
+/// takes as long as it took according to the build log.
+struct BuildSimulator {
+  BuildSimulator(State* state, BuildLog* build_log);
+
+  /// Add \a node, and everything it depends on, to the simulated build.
+  /// All commands are run as if their outputs were missing.
+  void AddTarget(Node* node);
+
+  /// Simulate the build with \a parallelism jobs.
+  bool Run(int parallelism, SimulationResult* result, string* err);
+
+  /// A number of jobs whose build is within \a slack (e.g. 0.05 for 5%) of
+  /// the fastest possible one, so that more jobs barely help.  It is found
+  /// by doubling and then bisecting the jobs; since more jobs can rarely
+  /// make a schedule slower, it may not be the smallest such number.  Sets
+  /// \a result to that build, and \a fastest to the one with a job for
+  /// every command, whose critical path is that of the targets.
+  int FindFlatParallelism(double slack, SimulationResult* result,
+                          SimulationResult* fastest, string* err);
+
+  /// The number of commands with no build log entry.
+  int unknown_commands() const { return unknown_commands_; }
+  /// The duration assumed for those commands: the average of the others.
+  int64_t unknown_duration_millis() const { return unknown_duration_millis_; }
+
+  /// How long \a edge is expected to run.
+  int64_t Duration(Edge* edge) const;
+
+ private:
+  State* state_;
+  BuildLog* build_log_;
+  vector<Node*> targets_;
+
+  /// Durations of commands found in the build log.
+  map<Edge*, int64_t> durations_;
+  int command_count_;
+  int unknown_commands_;
+  int64_t unknown_duration_millis_;
+};
+
+#endif  // NINJA_SIMULATE_H_
@@ -0,0 +1,92 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "simulate.h"
+
+#include "build_log.h"
+#include "graph.h"
+#include "test.h"
+
+namespace {
+
+struct SimulateTest : public StateTestWithBuiltinRules {
+  virtual void SetUp() {
+    // a then b form a chain; c1 and c2 can run alongside it.
+    ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build a: cat in\n"
+"build b: cat a\n"
+"build c1: cat in\n"
+"build c2: cat in\n"
+"build all: phony b c1 c2\n"));
+    Record("a", 100);
+    Record("b", 200);
+    Record("c1", 50);
+    Record("c2", 50);
+  }
+
+  void Record(const string& output, int duration) {
+    build_log_.RecordCommand(GetNode(output)->in_edge(), 0, duration);
+  }
+
+  BuildLog build_log_;
+};
+
+TEST_F(SimulateTest, Parallelism) {
+  BuildSimulator simulator(&state_, &build_log_);
+  simulator.AddTarget(GetNode("all"));
+  EXPECT_EQ(0, simulator.unknown_commands());
+
+  SimulationResult result;
+  string err;
+  EXPECT_TRUE(simulator.Run(1, &result, &err));
+  EXPECT_EQ("", err);
+  EXPECT_EQ(4, result.commands);
+  EXPECT_EQ(400, result.wall_millis);
+  EXPECT_EQ(400, result.command_millis);
+
+  // c1 and c2 run while a does.
+  EXPECT_TRUE(simulator.Run(2, &result, &err));
+  EXPECT_EQ(300, result.wall_millis);
+  ASSERT_EQ(2u, result.critical_path.size());
+  EXPECT_EQ("a", result.critical_path[0]->outputs_[0]->path());
+  EXPECT_EQ("b", result.critical_path[1]->outputs_[0]->path());
+  EXPECT_EQ(300, result.critical_path_millis);
+
+  // More jobs don't help.
+  SimulationResult fastest;
+  EXPECT_EQ(2, simulator.FindFlatParallelism(0.05, &result, &fastest, &err));
+  EXPECT_EQ(300, result.wall_millis);
+  EXPECT_EQ(300, fastest.wall_millis);
+  EXPECT_EQ(2u, fastest.critical_path.size());
+}
+
+TEST_F(SimulateTest, UnknownDuration) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build d: cat b\n"));
+  BuildSimulator simulator(&state_, &build_log_);
+  simulator.AddTarget(GetNode("d"));
+
+  // d takes the average of a and b.
+  EXPECT_EQ(1, simulator.unknown_commands());
+  EXPECT_EQ(150, simulator.unknown_duration_millis());
+
+  SimulationResult result;
+  string err;
+  EXPECT_TRUE(simulator.Run(4, &result, &err));
+  EXPECT_EQ(3, result.commands);
+  EXPECT_EQ(450, result.wall_millis);
+  EXPECT_EQ(3u, result.critical_path.size());
+}
+
+}  // anonymous namespace
@@ -16,6 +16,10 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "edit_distance.h"
 #include "graph.h"
@@ -23,36 +27,129 @@
 #include "util.h"
 
 
+bool ParseResourceList(const string& text, ResourceList* resources) {
+  const char* p = text.c_str();
+  for (;;) {
+    while (*p == ' ')
+      ++p;
+    if (!*p)
+      return true;
+    const char* equals = strchr(p, '=');
+    if (!equals || equals == p || memchr(p, ' ', equals - p))
+      return false;
+    char* end;
+    long amount = strtol(equals + 1, &end, 10);
+    if (end == equals + 1 || (*end && *end != ' ') || amount < 0)
+      return false;
+    resources->push_back(make_pair(string(p, equals - p), (int)amount));
+    p = end;
+  }
+}
+
+void Pool::AddResource(const string& name, int capacity) {
+  Resource resource = { name, capacity, 0 };
+  resources_.push_back(resource);
+}
+
+bool Pool::ParseResourceUsage(const string& text, vector<int>* usage,
+                              string* err) const {
+  ResourceList list;
+  if (!ParseResourceList(text, &list)) {
+    *err = "invalid resources '" + text + "'";
+    return false;
+  }
+
+  usage->assign(resources_.size(), 0);
+  for (ResourceList::iterator r = list.begin(); r != list.end(); ++r) {
+    size_t i = 0;
+    while (i < resources_.size() && resources_[i].name != r->first)
+      ++i;
+    if (i == resources_.size()) {
+      *err = "pool '" + name_ + "' has no resource '" + r->first + "'";
+      return false;
+    }
+    if (r->second > resources_[i].capacity) {
+      // The edge could never run.
+      char capacity[32];
+      snprintf(capacity, sizeof(capacity), "%d", resources_[i].capacity);
+      *err = "pool '" + name_ + "' has only " + capacity + " of '" +
+             r->first + "'";
+      return false;
+    }
+    (*usage)[i] = r->second;
+  }
+  return true;
+}
+
+bool Pool::EdgeFits(const Edge& edge) const {
+  if (depth_ != 0 && current_use_ + edge.weight() > depth_)
+    return false;
+  for (size_t i = 0; i < edge.resources_.size(); ++i) {
+    if (resources_[i].use + edge.resources_[i] > resources_[i].capacity)
+      return false;
+  }
+  return true;
+}
+
 void Pool::EdgeScheduled(const Edge& edge) {
   if (depth_ != 0)
     current_use_ += edge.weight();
+  for (size_t i = 0; i < edge.resources_.size(); ++i)
+    resources_[i].use += edge.resources_[i];
 }
 
 void Pool::EdgeFinished(const Edge& edge) {
   if (depth_ != 0)
     current_use_ -= edge.weight();
+  for (size_t i = 0; i < edge.resources_.size(); ++i)
+    resources_[i].use -= edge.resources_[i];
 }
 
 void Pool::DelayEdge(Edge* edge) {
-  assert(depth_ != 0);
-  delayed_.insert(edge);
+  assert(ShouldDelayEdge());
+  if (edge->delayed_)
+    return;
+  edge->delayed_ = true;
+  delayed_.push_back(edge);
+  push_heap(delayed_.begin(), delayed_.end(), DelayedEdgeCmp());
 }
 
 void Pool::RetrieveReadyEdges(EdgeSet* ready_queue) {
-  DelayedEdges::iterator it = delayed_.begin();
-  while (it != delayed_.end()) {
-    Edge* edge = *it;
-    if (current_use_ + edge->weight() > depth_)
-      break;
+  // Release edges in order for as long as they fit.  With resources, an
+  // edge that doesn't fit may still leave room for a later one that needs
+  // less of something; set it aside, and put it back afterwards.
+  vector<Edge*> held_back;
+  while (!delayed_.empty()) {
+    Edge* edge = delayed_.front();
+    pop_heap(delayed_.begin(), delayed_.end(), DelayedEdgeCmp());
+    delayed_.pop_back();
+    if (!EdgeFits(*edge)) {
+      held_back.push_back(edge);
+      if (resources_.empty())
+        break;
+      continue;
+    }
+    edge->delayed_ = false;
     ready_queue->insert(edge);
     EdgeScheduled(*edge);
-    ++it;
   }
-  delayed_.erase(delayed_.begin(), it);
+  for (vector<Edge*>::iterator i = held_back.begin(); i != held_back.end();
+       ++i) {
+    delayed_.push_back(*i);
+    push_heap(delayed_.begin(), delayed_.end(), DelayedEdgeCmp());
+  }
+}
+
+void Pool::ReorderDelayedEdges() {
+  make_heap(delayed_.begin(), delayed_.end(), DelayedEdgeCmp());
 }
 
 void Pool::Dump() const {
   printf("%s (%d/%d) ->\n", name_.c_str(), current_use_, depth_);
+  for (vector<Resource>::const_iterator r = resources_.begin();
+       r != resources_.end(); ++r) {
+    printf("\t%s (%d/%d)\n", r->name.c_str(), r->use, r->capacity);
+  }
   for (DelayedEdges::const_iterator it = delayed_.begin();
        it != delayed_.end(); ++it)
   {
@@ -174,6 +271,123 @@ vector<Node*> State::DefaultNodes(string* err) const {
   return defaults_.empty() ? RootNodes(err) : defaults_;
 }
 
+namespace {
+
+/// Whether edges can read the inputs of \a node's phony edge instead of it.
+bool IsCollapsibleAlias(Node* node) {
+  Edge* edge = node->in_edge();
+  return edge && edge->is_phony() && !edge->inputs_.empty() &&
+         !edge->dyndep_ && !node->dyndep_pending() &&
+         (edge->inputs_.size() == 1 || node->out_edges().size() == 1);
+}
+
+}  // anonymous namespace
+
+void State::CollapsePhonyAliases(int* nodes, int* edges) {
+  METRIC_RECORD("collapse phony aliases");
+  *nodes = *edges = 0;
+
+  // Order the edges so that each comes after the edges it reads from, so
+  // that aliases of aliases are already collapsed when they are read.
+  enum { kUnvisited, kInStack, kDone };
+  vector<char> visited(edges_.size(), kUnvisited);
+  vector<Edge*> order;
+  vector<pair<Edge*, size_t> > stack;
+  for (vector<Edge*>::iterator e = edges_.begin(); e != edges_.end(); ++e) {
+    if (visited[(*e)->id_] != kUnvisited)
+      continue;
+    visited[(*e)->id_] = kInStack;
+    stack.push_back(make_pair(*e, 0));
+    while (!stack.empty()) {
+      Edge* edge = stack.back().first;
+      size_t input = stack.back().second++;
+      if (input == edge->inputs_.size()) {
+        visited[edge->id_] = kDone;
+        order.push_back(edge);
+        stack.pop_back();
+        continue;
+      }
+      Edge* in_edge = edge->inputs_[input]->in_edge();
+      if (!in_edge || visited[in_edge->id_] == kDone)
+        continue;
+      // The scan reports the cycle.
+      if (visited[in_edge->id_] == kInStack)
+        return;
+      visited[in_edge->id_] = kInStack;
+      stack.push_back(make_pair(in_edge, 0));
+    }
+  }
+
+  set<Node*> bypassed;
+  for (vector<Edge*>::iterator e = order.begin(); e != order.end(); ++e) {
+    Edge* edge = *e;
+    size_t order_only_start = edge->inputs_.size() - edge->order_only_deps_;
+    size_t implicit_start = order_only_start - edge->implicit_deps_;
+    vector<Node*> sections[3];  // Explicit, implicit and order-only.
+    // What the edge reads already, so that aliases sharing inputs don't
+    // repeat them.  An order-only input doesn't stand in for a regular one.
+    set<Node*> seen, seen_order_only;
+    bool changed = false;
+    for (size_t i = 0; i < edge->inputs_.size(); ++i) {
+      int section = i < implicit_start ? 0 : i < order_only_start ? 1 : 2;
+      Node* input = edge->inputs_[i];
+      if ((!edge->is_phony() && section != 2) || !IsCollapsibleAlias(input)) {
+        sections[section].push_back(input);
+        (section == 2 ? seen_order_only : seen).insert(input);
+        continue;
+      }
+      changed = true;
+      bypassed.insert(input);
+      Edge* alias = input->in_edge();
+      for (size_t j = 0; j < alias->inputs_.size(); ++j) {
+        Node* node = alias->inputs_[j];
+        int to = alias->is_order_only(j) ? 2 : section;
+        if (seen.count(node) || (to == 2 && seen_order_only.count(node)))
+          continue;
+        (to == 2 ? seen_order_only : seen).insert(node);
+        sections[to].push_back(node);
+      }
+    }
+    if (!changed)
+      continue;
+    edge->inputs_ = sections[0];
+    edge->inputs_.insert(edge->inputs_.end(), sections[1].begin(),
+                         sections[1].end());
+    edge->inputs_.insert(edge->inputs_.end(), sections[2].begin(),
+                         sections[2].end());
+    edge->implicit_deps_ = sections[1].size();
+    edge->order_only_deps_ = sections[2].size();
+  }
+  if (bypassed.empty())
+    return;
+
+  for (Paths::iterator i = paths_.begin(); i != paths_.end(); ++i)
+    i->second->ClearOutEdges();
+  for (vector<Edge*>::iterator e = edges_.begin(); e != edges_.end(); ++e) {
+    for (vector<Node*>::iterator i = (*e)->inputs_.begin();
+         i != (*e)->inputs_.end(); ++i) {
+      (*i)->AddOutEdge(*e);
+    }
+  }
+
+  set<Edge*> aliases;
+  for (set<Node*>::iterator n = bypassed.begin(); n != bypassed.end(); ++n) {
+    if (!(*n)->out_edges().empty())
+      continue;
+    ++*nodes;
+    aliases.insert((*n)->in_edge());
+  }
+  for (set<Edge*>::iterator e = aliases.begin(); e != aliases.end(); ++e) {
+    bool read = false;
+    for (vector<Node*>::iterator o = (*e)->outputs_.begin();
+         o != (*e)->outputs_.end(); ++o) {
+      read = read || !(*o)->out_edges().empty();
+    }
+    if (!read)
+      ++*edges;
+  }
+}
+
 void State::Reset() {
   for (Paths::iterator i = paths_.begin(); i != paths_.end(); ++i)
     i->second->ResetState();
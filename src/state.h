@@ -30,6 +30,13 @@ struct Edge;
 struct Node;
 struct Rule;
 
+/// Amounts of named resources, such as "mem=8 cpu=4" parses to.
+typedef vector<pair<string, int> > ResourceList;
+
+/// Parse a space separated list of name=amount pairs, where amounts are
+/// not negative, into \a resources.
+bool ParseResourceList(const string& text, ResourceList* resources);
+
 /// A pool for delayed edges.
 /// Pools are scoped to a State. Edges within a State will share Pools. A Pool
 /// will keep a count of the total 'weight' of the currently scheduled edges. If
@@ -38,6 +45,10 @@ struct Rule;
 /// allowing the Plan to schedule it. The Pool will relinquish queued Edges when
 /// the total scheduled weight diminishes enough (i.e. when a scheduled edge
 /// completes).
+///
+/// A Pool can also have named resources, such as memory or licenses, each
+/// with a capacity.  Edges state how much of each they use, and are only
+/// scheduled once all of it is available.
 struct Pool {
   Pool(const string& name, int depth)
     : name_(name), current_use_(0), depth_(depth), delayed_() {}
@@ -48,8 +59,18 @@ struct Pool {
   const string& name() const { return name_; }
   int current_use() const { return current_use_; }
 
+  /// Add a resource of which edges in this pool may use up to \a capacity
+  /// at a time.
+  void AddResource(const string& name, int capacity);
+  /// Parse an edge's "resources" binding, e.g. "mem=8 cpu=4", into
+  /// \a usage, indexed like this pool's resources.
+  bool ParseResourceUsage(const string& text, vector<int>* usage,
+                          string* err) const;
+  /// How much of the resource at \a index is in use.
+  int resource_use(size_t index) const { return resources_[index].use; }
+
   /// true if the Pool might delay this edge
-  bool ShouldDelayEdge() const { return depth_ != 0; }
+  bool ShouldDelayEdge() const { return depth_ != 0 || !resources_.empty(); }
 
   /// informs this Pool that the given edge is committed to be run.
   /// Pool will count this edge as using resources from this pool.
@@ -65,10 +86,17 @@ struct Pool {
   /// Pool will add zero or more edges to the ready_queue
   void RetrieveReadyEdges(EdgeSet* ready_queue);
 
+  /// Restore the order of the delayed edges after their critical times
+  /// changed.
+  void ReorderDelayedEdges();
+
   /// Dump the Pool and its edges (useful for debugging).
   void Dump() const;
 
  private:
+  /// Whether \a edge fits in what's left of the depth and the resources.
+  bool EdgeFits(const Edge& edge) const;
+
   string name_;
 
   /// |current_use_| is the total of the weights of the edges which are
@@ -76,16 +104,31 @@ struct Pool {
   int current_use_;
   int depth_;
 
-  struct WeightedEdgeCmp {
+  struct Resource {
+    string name;
+    int capacity;
+    /// Like |current_use_|, for this resource.
+    int use;
+  };
+  vector<Resource> resources_;
+
+  /// Orders the delayed edges so that the one to release first is the
+  /// largest: by priority, then by critical time, then by lowest weight,
+  /// then by declaration order.
+  struct DelayedEdgeCmp {
     bool operator()(const Edge* a, const Edge* b) const {
-      if (!a) return b;
-      if (!b) return false;
-      int weight_diff = a->weight() - b->weight();
-      return ((weight_diff < 0) || (weight_diff == 0 && EdgeCmp()(a, b)));
+      if (a->priority_ != b->priority_)
+        return a->priority_ < b->priority_;
+      if (a->critical_time_ != b->critical_time_)
+        return a->critical_time_ < b->critical_time_;
+      if (a->weight() != b->weight())
+        return a->weight() > b->weight();
+      return EdgeCmp()(b, a);
     }
   };
 
-  typedef set<Edge*, WeightedEdgeCmp> DelayedEdges;
+  /// A heap of the delayed edges, with the next one to release in front.
+  typedef vector<Edge*> DelayedEdges;
   DelayedEdges delayed_;
 };
 
@@ -122,6 +165,17 @@ struct State {
   vector<Node*> RootNodes(string* error) const;
   vector<Node*> DefaultNodes(string* error) const;
 
+  /// Have edges read the inputs of the phony aliases they name directly,
+  /// so that scanning and planning skip the aliases.  Only phony edges and
+  /// order-only inputs are rewritten, as neither cares about the alias's
+  /// mtime or $in; aliases without inputs stand for files that may be
+  /// missing and are kept.  An alias is bypassed if it names one input or
+  /// is read once, so the graph never grows.  The aliases stay in the
+  /// graph to be built by name.  Does nothing if the graph has a cycle.
+  /// Sets \a nodes and \a edges to how many aliases and phony edges
+  /// nothing reads any more.
+  void CollapsePhonyAliases(int* nodes, int* edges);
+
   /// Mapping of path -> Node.
   typedef ExternalStringHashMap<Node*>::Type Paths;
   Paths paths_;
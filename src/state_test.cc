@@ -43,4 +43,72 @@ TEST(State, Basic) {
   EXPECT_FALSE(state.GetNode("out", 0)->dirty());
 }
 
+struct CollapsePhonyTest : public StateTestWithBuiltinRules {
+  string Inputs(const char* path) {
+    Edge* edge = GetNode(path)->in_edge();
+    string inputs;
+    for (size_t i = 0; i < edge->inputs_.size(); ++i) {
+      inputs += edge->is_order_only(i) ? " |" : " ";
+      inputs += edge->inputs_[i]->path();
+    }
+    return inputs;
+  }
+};
+
+TEST_F(CollapsePhonyTest, Aliases) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build out: cat in || alias\n"
+"build alias: phony group\n"
+"build group: phony x y || z\n"
+"build x y z: cat src\n"
+"build out2: cat alias2\n"
+"build alias2: phony in\n"
+"build missing: phony\n"
+"build all: phony out out2 missing\n"));
+
+  int nodes, edges;
+  state_.CollapsePhonyAliases(&nodes, &edges);
+  EXPECT_EQ(2, nodes);
+  EXPECT_EQ(2, edges);
+  EXPECT_EQ(" in |x |y |z", Inputs("out"));
+  EXPECT_EQ(" x y |z", Inputs("alias"));
+  // Commands read their explicit inputs as $in; aliases without inputs
+  // may stand for missing files.
+  EXPECT_EQ(" alias2", Inputs("out2"));
+  EXPECT_EQ(" out out2 missing", Inputs("all"));
+
+  EXPECT_TRUE(GetNode("alias")->out_edges().empty());
+  EXPECT_EQ(1u, GetNode("alias2")->out_edges().size());
+  VerifyGraph(state_);
+}
+
+// An input both aliases lead to stays a regular one.
+TEST_F(CollapsePhonyTest, OrderOnlyDoesNotHideInput) {
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build all: phony a1 a2\n"
+"build a1: phony || x\n"
+"build a2: phony x\n"
+"build x: cat src\n"));
+
+  int nodes, edges;
+  state_.CollapsePhonyAliases(&nodes, &edges);
+  EXPECT_EQ(2, nodes);
+  EXPECT_EQ(" x |x", Inputs("all"));
+}
+
+TEST_F(CollapsePhonyTest, Cycle) {
+  ManifestParserOptions parser_opts;
+  parser_opts.phony_cycle_action_ = kPhonyCycleActionError;
+  ASSERT_NO_FATAL_FAILURE(AssertParse(&state_,
+"build all: phony a\n"
+"build a: phony b\n"
+"build b: phony a\n", parser_opts));
+
+  int nodes, edges;
+  state_.CollapsePhonyAliases(&nodes, &edges);
+  EXPECT_EQ(0, nodes);
+  EXPECT_EQ(0, edges);
+  EXPECT_EQ(" a", Inputs("all"));
+}
+
 }  // namespace
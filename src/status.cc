@@ -24,7 +24,8 @@
 StatusPrinter::StatusPrinter(const BuildConfig& config)
     : config_(config),
       started_edges_(0), finished_edges_(0), total_edges_(0), running_edges_(0),
-      time_millis_(0), progress_status_format_(NULL),
+      time_millis_(0), last_print_millis_(-1), pending_edge_(NULL),
+      pending_time_millis_(0), progress_status_format_(NULL),
       current_rate_(config.parallelism) {
 
   // Don't do anything fancy in verbose mode.
@@ -63,8 +64,10 @@ void StatusPrinter::BuildEdgeFinished(Edge* edge, int64_t end_time_millis,
   if (config_.verbosity == BuildConfig::QUIET)
     return;
 
+  // Show which edge the output below belongs to.
+  bool has_output = !result->success() || !result->output.empty();
   if (!edge->use_console())
-    PrintStatus(edge, end_time_millis);
+    PrintStatus(edge, end_time_millis, has_output);
 
   --running_edges_;
 
@@ -109,7 +112,19 @@ void StatusPrinter::BuildStarted() {
 
 void StatusPrinter::BuildFinished() {
   printer_.SetConsoleLocked(false);
+  PrintPendingStatus();
   printer_.PrintOnNewLine("");
+  last_print_millis_ = -1;
+}
+
+int64_t StatusPrinter::Refresh(int64_t cur_time_millis) {
+  if (!pending_edge_)
+    return -1;
+  int64_t next_print_millis = last_print_millis_ + kRefreshIntervalMillis;
+  if (cur_time_millis < next_print_millis)
+    return next_print_millis;
+  PrintPendingStatus();
+  return -1;
 }
 
 string StatusPrinter::FormatProgressStatus(const char* progress_status_format,
@@ -194,10 +209,23 @@ string StatusPrinter::FormatProgressStatus(const char* progress_status_format,
   return out;
 }
 
-void StatusPrinter::PrintStatus(Edge* edge, int64_t time_millis) {
+void StatusPrinter::PrintStatus(Edge* edge, int64_t time_millis, bool force) {
   if (config_.verbosity == BuildConfig::QUIET)
     return;
 
+  // With thousands of tiny edges a second, redrawing the status line for
+  // every one of them slows the build down.  Every line is kept when they
+  // aren't overwritten, though.
+  if (!force && printer_.is_smart_terminal() && !edge->use_console() &&
+      last_print_millis_ >= 0 &&
+      time_millis - last_print_millis_ < kRefreshIntervalMillis) {
+    pending_edge_ = edge;
+    pending_time_millis_ = time_millis;
+    return;
+  }
+  pending_edge_ = NULL;
+  last_print_millis_ = time_millis;
+
   bool force_full_command = config_.verbosity == BuildConfig::VERBOSE;
 
   string to_print = edge->GetBinding("description");
@@ -211,6 +239,11 @@ void StatusPrinter::PrintStatus(Edge* edge, int64_t time_millis) {
                  force_full_command ? LinePrinter::FULL : LinePrinter::ELIDE);
 }
 
+void StatusPrinter::PrintPendingStatus() {
+  if (pending_edge_)
+    PrintStatus(pending_edge_, pending_time_millis_, /*force=*/true);
+}
+
 void StatusPrinter::Warning(const char* msg, ...) {
   va_list ap;
   va_start(ap, msg);
@@ -235,52 +268,88 @@ void StatusPrinter::Info(const char* msg, ...) {
 #ifndef _WIN32
 
 StatusSerializer::StatusSerializer(const BuildConfig& config) :
-    config_(config), serializer_(NULL), subprocess_(NULL) {
+    config_(config), serializer_(NULL), subprocess_(NULL),
+    writer_(/*flush_interval_millis=*/0), dropped_outputs_(0) {
   int output_pipe[2];
   if (pipe(output_pipe) < 0)
     Fatal("pipe: %s", strerror(errno));
   SetCloseOnExec(output_pipe[1]);
 
-  serializer_ = new Serializer(output_pipe[1]);
+  serializer_ = new Serializer(&message_);
+  writer_.Open(fdopen(output_pipe[1], "wb"));
 
   subprocess_ = subprocess_set_.Add(config.frontend, /*use_console=*/true,
                                     output_pipe[0]);
   close(output_pipe[0]);
 
   serializer_->Uint(kHeader);
+  Send();
 }
 
 StatusSerializer::~StatusSerializer() {
-  serializer_->Flush();
+  writer_.Close();
   delete serializer_;
   subprocess_->Finish();
   subprocess_set_.Clear();
 }
 
+void StatusSerializer::Send() {
+  // A frontend that is gone is noticed when it is reaped; ignore errors.
+  writer_.Append(message_.str());
+  message_.str(string());
+  // The messages that can't be dropped still mustn't queue without bound.
+  if (writer_.pending_size() > kMaxQueuedBytes)
+    writer_.Flush();
+}
+
 void StatusSerializer::PlanHasTotalEdges(int total) {
   serializer_->Array(2);
   serializer_->Uint(kTotalEdges);
   serializer_->Uint(total);
-  serializer_->Flush();
+  Send();
+}
+
+unsigned StatusSerializer::PathId(Node* node) {
+  pair<map<Node*, unsigned>::iterator, bool> inserted =
+      path_ids_.insert(make_pair(node, (unsigned)path_ids_.size()));
+  if (inserted.second) {
+    serializer_->Array(3);
+    serializer_->Uint(kDefinePath);
+    serializer_->Uint(inserted.first->second);
+    serializer_->String(node->path());
+  }
+  return inserted.first->second;
 }
 
 void StatusSerializer::BuildEdgeStarted(Edge* edge, int64_t start_time_millis) {
+  // Define the paths the frontend hasn't seen yet ahead of the edge, which
+  // then refers to them by id.
+  vector<unsigned> inputs, outputs;
+  inputs.reserve(edge->inputs_.size());
+  for (vector<Node*>::iterator it = edge->inputs_.begin(); it != edge->inputs_.end(); ++it) {
+    inputs.push_back(PathId(*it));
+  }
+  outputs.reserve(edge->outputs_.size());
+  for (vector<Node*>::iterator it = edge->outputs_.begin(); it != edge->outputs_.end(); ++it) {
+    outputs.push_back(PathId(*it));
+  }
+
   serializer_->Array(8);
   serializer_->Uint(kEdgeStarted);
   serializer_->Uint(edge->id_);
   serializer_->Uint(start_time_millis);
-  serializer_->Array(edge->inputs_.size());
-  for (vector<Node*>::iterator it = edge->inputs_.begin(); it != edge->inputs_.end(); ++it) {
-    serializer_->String((*it)->path());
+  serializer_->Array(inputs.size());
+  for (vector<unsigned>::iterator it = inputs.begin(); it != inputs.end(); ++it) {
+    serializer_->Uint(*it);
   }
-  serializer_->Array(edge->outputs_.size());
-  for (vector<Node*>::iterator it = edge->outputs_.begin(); it != edge->outputs_.end(); ++it) {
-    serializer_->String((*it)->path());
+  serializer_->Array(outputs.size());
+  for (vector<unsigned>::iterator it = outputs.begin(); it != outputs.end(); ++it) {
+    serializer_->Uint(*it);
   }
   serializer_->String(edge->GetBinding("description"));
   serializer_->String(edge->GetBinding("command"));
   serializer_->Bool(edge->use_console());
-  serializer_->Flush();
+  Send();
 }
 
 void StatusSerializer::BuildEdgeFinished(Edge* edge, int64_t end_time_millis,
@@ -290,8 +359,29 @@ void StatusSerializer::BuildEdgeFinished(Edge* edge, int64_t end_time_millis,
   serializer_->Uint(edge->id_);
   serializer_->Uint(end_time_millis);
   serializer_->Int(result->status);
-  serializer_->String(result->output);
-  serializer_->Flush();
+  // The output of a failed command is what the user needs to see.
+  Output(result->output, result->success());
+  Send();
+}
+
+void StatusSerializer::BuildEdgeOutput(Edge* edge, const string& output) {
+  serializer_->Array(3);
+  serializer_->Uint(kEdgeOutput);
+  serializer_->Uint(edge->id_);
+  Output(output, true);
+  Send();
+}
+
+void StatusSerializer::Output(const string& output, bool may_drop) {
+  // Rather than stall the build or buffer without bound when the frontend
+  // doesn't keep up, drop command output and say so.
+  if (may_drop && !output.empty() &&
+      writer_.pending_size() > kMaxPendingBytes) {
+    ++dropped_outputs_;
+    serializer_->String("ninja: output dropped, the frontend is behind\n");
+  } else {
+    serializer_->String(output);
+  }
 }
 
 void StatusSerializer::BuildStarted() {
@@ -299,11 +389,18 @@ void StatusSerializer::BuildStarted() {
   serializer_->Uint(kBuildStarted);
   serializer_->Uint(config_.parallelism);
   serializer_->Bool(config_.verbosity == BuildConfig::VERBOSE);
+  Send();
 }
 
 void StatusSerializer::BuildFinished() {
+  if (dropped_outputs_) {
+    Warning("the frontend fell behind; dropped %d command outputs",
+            dropped_outputs_);
+    dropped_outputs_ = 0;
+  }
   serializer_->Array(1);
   serializer_->Uint(kBuildFinished);
+  Send();
 }
 
 void StatusSerializer::Message(messageType type, const char* msg,
@@ -326,7 +423,8 @@ void StatusSerializer::Message(messageType type, const char* msg,
   serializer_->Array(2);
   serializer_->Uint(type);
   serializer_->String(buf);
-  serializer_->Flush();
+  Send();
+  delete[] buf;
 }
 
 void StatusSerializer::Info(const char* msg, ...) {
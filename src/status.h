@@ -18,11 +18,13 @@
 #include <stdarg.h>
 
 #include <map>
+#include <sstream>
 #include <string>
 using namespace std;
 
 #include "build.h"
 #include "line_printer.h"
+#include "log_writer.h"
 #include "subprocess.h"
 
 /// Abstract interface to object that tracks the status of a build:
@@ -32,9 +34,17 @@ struct Status {
   virtual void BuildEdgeStarted(Edge* edge, int64_t start_time_millis) = 0;
   virtual void BuildEdgeFinished(Edge* edge, int64_t end_time_millis,
                                  const CommandRunner::Result* result) = 0;
+  /// Output of a command that is still running.  Only called if
+  /// BuildConfig::partial_output_millis is set.
+  virtual void BuildEdgeOutput(Edge* edge, const string& output) {}
   virtual void BuildStarted() = 0;
   virtual void BuildFinished() = 0;
 
+  /// Show any update that was held back to limit the redraw rate, if it
+  /// is time for it.  Returns when to call this again, or -1 if there is
+  /// nothing left to show.
+  virtual int64_t Refresh(int64_t cur_time_millis) { return -1; }
+
   virtual void Info(const char* msg, ...) = 0;
   virtual void Warning(const char* msg, ...) = 0;
   virtual void Error(const char* msg, ...) = 0;
@@ -52,6 +62,7 @@ struct StatusPrinter : Status {
                                  const CommandRunner::Result* result);
   virtual void BuildStarted();
   virtual void BuildFinished();
+  virtual int64_t Refresh(int64_t cur_time_millis);
 
   virtual void Info(const char* msg, ...);
   virtual void Warning(const char* msg, ...);
@@ -59,6 +70,10 @@ struct StatusPrinter : Status {
 
   virtual ~StatusPrinter() { }
 
+  /// On a smart terminal, the status line is redrawn at most this often;
+  /// updates in between are held back until Refresh().
+  static const int kRefreshIntervalMillis = 50;
+
   /// Format the progress status string by replacing the placeholders.
   /// See the user manual for more information about the available
   /// placeholders.
@@ -68,13 +83,22 @@ struct StatusPrinter : Status {
                               int64_t time_millis) const;
 
  private:
-  void PrintStatus(Edge* edge, int64_t time_millis);
+  /// Print the status line for \a edge, unless the last one was printed
+  /// less than kRefreshIntervalMillis ago and \a force is false.
+  void PrintStatus(Edge* edge, int64_t time_millis, bool force = false);
+  void PrintPendingStatus();
 
   const BuildConfig& config_;
 
   int started_edges_, finished_edges_, total_edges_, running_edges_;
   int64_t time_millis_;
 
+  /// When the status line was last printed, and the edge for the status
+  /// line that was held back since, if any.
+  int64_t last_print_millis_;
+  Edge* pending_edge_;
+  int64_t pending_time_millis_;
+
   /// Prints progress output.
   LinePrinter printer_;
 
@@ -128,6 +152,7 @@ struct StatusSerializer : Status {
   virtual void BuildEdgeStarted(Edge* edge, int64_t start_time);
   virtual void BuildEdgeFinished(Edge* edge, int64_t end_time_millis,
                                  const CommandRunner::Result* result);
+  virtual void BuildEdgeOutput(Edge* edge, const string& output);
   virtual void BuildStarted();
   virtual void BuildFinished();
 
@@ -136,7 +161,7 @@ struct StatusSerializer : Status {
   virtual void Error(const char* msg, ...);
 
   enum messageType {
-    kHeader          = 0x4e4a5331, // NJS1
+    kHeader          = 0x4e4a5332, // NJS2
     kTotalEdges      = 0,
     kBuildStarted    = 1,
     kBuildFinished   = 2,
@@ -145,8 +170,17 @@ struct StatusSerializer : Status {
     kNinjaInfo       = 5,
     kNinjaWarning    = 6,
     kNinjaError      = 7,
+    kDefinePath      = 8,
+    kEdgeOutput      = 9,
   };
 
+  /// Command output is dropped rather than queued once this many bytes
+  /// are waiting for the frontend, except for that of failed commands.
+  static const size_t kMaxPendingBytes = 16 << 20;
+  /// Past this many bytes waiting for the frontend, which only messages
+  /// that can't be dropped add to, the build waits for it to catch up.
+  static const size_t kMaxQueuedBytes = 4 * kMaxPendingBytes;
+
   const BuildConfig& config_;
 
   Serializer* serializer_;
@@ -154,6 +188,23 @@ struct StatusSerializer : Status {
   Subprocess* subprocess_;
 private:
   void Message(messageType type, const char* msg, va_list ap);
+  /// Queue the message serialized into message_ for the frontend.
+  void Send();
+  /// Return the id that edge messages use for \a node's path, first
+  /// serializing a message that defines it if the frontend hasn't seen it.
+  unsigned PathId(Node* node);
+  /// Serialize \a output, or a note that it was dropped if \a may_drop
+  /// and the frontend is too far behind.
+  void Output(const string& output, bool may_drop);
+
+  /// Ids of the paths that were sent to the frontend.
+  map<Node*, unsigned> path_ids_;
+
+  /// Messages are serialized here, then written to the frontend's pipe on
+  /// a background thread so that a slow frontend doesn't block the build.
+  ostringstream message_;
+  LogWriter writer_;
+  int dropped_outputs_;
 };
 
 #endif // !_WIN32
@@ -41,7 +41,7 @@ Subprocess::~Subprocess() {
 }
 
 bool Subprocess::Start(SubprocessSet* set, const string& command,
-                       int extra_fd) {
+                       int extra_fd, const string& cgroup) {
   int output_pipe[2];
   if (pipe(output_pipe) < 0)
     Fatal("pipe: %s", strerror(errno));
@@ -107,8 +107,17 @@ bool Subprocess::Start(SubprocessSet* set, const string& command,
     Fatal("posix_spawnattr_setflags: %s", strerror(errno));
 
   const char* spawned_args[] = { "/bin/sh", "-c", command.c_str(), NULL };
+  // To run in a cgroup, the shell moves itself there before running the
+  // command, so that everything the command starts is in it too.
+  string cgroup_procs = cgroup + "/cgroup.procs";
+  const char* cgroup_args[] = {
+    "/bin/sh", "-c", "echo $$ >\"$0\" && exec /bin/sh -c \"$1\"",
+    cgroup_procs.c_str(), command.c_str(), NULL
+  };
   if (posix_spawn(&pid_, "/bin/sh", &action, &attr,
-                  const_cast<char**>(spawned_args), environ) != 0)
+                  const_cast<char**>(cgroup.empty() ? spawned_args
+                                                    : cgroup_args),
+                  environ) != 0)
     Fatal("posix_spawn: %s", strerror(errno));
 
   if (posix_spawnattr_destroy(&attr) != 0)
@@ -160,6 +169,11 @@ const string& Subprocess::GetOutput() const {
   return buf_;
 }
 
+void Subprocess::TakeOutput(string* output) {
+  output->clear();
+  output->swap(buf_);
+}
+
 int SubprocessSet::interrupted_;
 
 void SubprocessSet::SetInterruptedFlag(int signum) {
@@ -181,7 +195,15 @@ void SubprocessSet::HandlePendingInterruption() {
     interrupted_ = SIGHUP;
 }
 
-SubprocessSet::SubprocessSet() {
+SubprocessSet::SubprocessSet() : woken_(false) {
+  if (pipe(wake_pipe_) < 0)
+    Fatal("pipe: %s", strerror(errno));
+  for (int i = 0; i < 2; ++i) {
+    SetCloseOnExec(wake_pipe_[i]);
+    if (fcntl(wake_pipe_[i], F_SETFL, O_NONBLOCK) < 0)
+      Fatal("fcntl: %s", strerror(errno));
+  }
+
   sigset_t set;
   sigemptyset(&set);
   sigaddset(&set, SIGINT);
@@ -212,12 +234,33 @@ SubprocessSet::~SubprocessSet() {
     Fatal("sigaction: %s", strerror(errno));
   if (sigprocmask(SIG_SETMASK, &old_mask_, 0) < 0)
     Fatal("sigprocmask: %s", strerror(errno));
+
+  close(wake_pipe_[0]);
+  close(wake_pipe_[1]);
+}
+
+void SubprocessSet::Wake() {
+  // If the pipe is full, DoWork() will wake up anyway.
+  char c = 0;
+  while (write(wake_pipe_[1], &c, 1) < 0 && errno == EINTR) {
+  }
 }
 
+namespace {
+
+/// Empty the wake pipe after DoWork() saw it readable.
+void DrainWakePipe(int fd) {
+  char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+}
+
+}  // namespace
+
 Subprocess *SubprocessSet::Add(const string& command, bool use_console,
-                               int extra_fd) {
+                               int extra_fd, const string& cgroup) {
   Subprocess *subprocess = new Subprocess(use_console);
-  if (!subprocess->Start(this, command, extra_fd)) {
+  if (!subprocess->Start(this, command, extra_fd, cgroup)) {
     delete subprocess;
     return 0;
   }
@@ -226,7 +269,7 @@ Subprocess *SubprocessSet::Add(const string& command, bool use_console,
 }
 
 #ifdef USE_PPOLL
-bool SubprocessSet::DoWork() {
+bool SubprocessSet::DoWork(int timeout_millis) {
   vector<pollfd> fds;
   nfds_t nfds = 0;
 
@@ -239,9 +282,15 @@ bool SubprocessSet::DoWork() {
     fds.push_back(pfd);
     ++nfds;
   }
+  pollfd wake_pfd = { wake_pipe_[0], POLLIN, 0 };
+  fds.push_back(wake_pfd);
 
   interrupted_ = 0;
-  int ret = ppoll(&fds.front(), nfds, NULL, &old_mask_);
+  woken_ = false;
+  timespec timeout = { timeout_millis / 1000,
+                       (timeout_millis % 1000) * 1000000 };
+  int ret = ppoll(&fds.front(), nfds + 1,
+                  timeout_millis < 0 ? NULL : &timeout, &old_mask_);
   if (ret == -1) {
     if (errno != EINTR) {
       perror("ninja: ppoll");
@@ -254,6 +303,11 @@ bool SubprocessSet::DoWork() {
   if (IsInterrupted())
     return true;
 
+  if (fds[nfds].revents) {
+    DrainWakePipe(wake_pipe_[0]);
+    woken_ = true;
+  }
+
   nfds_t cur_nfd = 0;
   for (vector<Subprocess*>::iterator i = running_.begin();
        i != running_.end(); ) {
@@ -276,7 +330,7 @@ bool SubprocessSet::DoWork() {
 }
 
 #else  // !defined(USE_PPOLL)
-bool SubprocessSet::DoWork() {
+bool SubprocessSet::DoWork(int timeout_millis) {
   fd_set set;
   int nfds = 0;
   FD_ZERO(&set);
@@ -290,9 +344,16 @@ bool SubprocessSet::DoWork() {
         nfds = fd+1;
     }
   }
+  FD_SET(wake_pipe_[0], &set);
+  if (nfds < wake_pipe_[0] + 1)
+    nfds = wake_pipe_[0] + 1;
 
   interrupted_ = 0;
-  int ret = pselect(nfds, &set, 0, 0, 0, &old_mask_);
+  woken_ = false;
+  timespec timeout = { timeout_millis / 1000,
+                       (timeout_millis % 1000) * 1000000 };
+  int ret = pselect(nfds, &set, 0, 0, timeout_millis < 0 ? NULL : &timeout,
+                    &old_mask_);
   if (ret == -1) {
     if (errno != EINTR) {
       perror("ninja: pselect");
@@ -305,6 +366,11 @@ bool SubprocessSet::DoWork() {
   if (IsInterrupted())
     return true;
 
+  if (FD_ISSET(wake_pipe_[0], &set)) {
+    DrainWakePipe(wake_pipe_[0]);
+    woken_ = true;
+  }
+
   for (vector<Subprocess*>::iterator i = running_.begin();
        i != running_.end(); ) {
     int fd = (*i)->fd_;
@@ -196,9 +196,14 @@ const string& Subprocess::GetOutput() const {
   return buf_;
 }
 
+void Subprocess::TakeOutput(string* output) {
+  output->clear();
+  output->swap(buf_);
+}
+
 HANDLE SubprocessSet::ioport_;
 
-SubprocessSet::SubprocessSet() {
+SubprocessSet::SubprocessSet() : woken_(false) {
   ioport_ = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
   if (!ioport_)
     Win32Fatal("CreateIoCompletionPort");
@@ -236,13 +241,23 @@ Subprocess *SubprocessSet::Add(const string& command, bool use_console) {
   return subprocess;
 }
 
-bool SubprocessSet::DoWork() {
+void SubprocessSet::Wake() {
+  // Use the set itself as the completion key, to tell it from a subprocess.
+  if (!PostQueuedCompletionStatus(ioport_, 0, (ULONG_PTR)this, NULL))
+    Win32Fatal("PostQueuedCompletionStatus");
+}
+
+bool SubprocessSet::DoWork(int timeout_millis) {
   DWORD bytes_read;
   Subprocess* subproc;
   OVERLAPPED* overlapped;
 
+  woken_ = false;
   if (!GetQueuedCompletionStatus(ioport_, &bytes_read, (PULONG_PTR)&subproc,
-                                 &overlapped, INFINITE)) {
+                                 &overlapped,
+                                 timeout_millis < 0 ? INFINITE : timeout_millis)) {
+    if (!overlapped && GetLastError() == WAIT_TIMEOUT)
+      return false;
     if (GetLastError() != ERROR_BROKEN_PIPE)
       Win32Fatal("GetQueuedCompletionStatus");
   }
@@ -251,6 +266,11 @@ bool SubprocessSet::DoWork() {
                 // delivered by NotifyInterrupted above.
     return true;
 
+  if ((void*)subproc == this) {  // Delivered by Wake() above.
+    woken_ = true;
+    return false;
+  }
+
   subproc->OnPipeReady();
 
   if (subproc->Done()) {
@@ -51,9 +51,14 @@ struct Subprocess {
 
   const string& GetOutput() const;
 
+  /// Move the output read so far into \a output, so that a long running
+  /// command's output can be shown before it finishes.
+  void TakeOutput(string* output);
+
  private:
   Subprocess(bool use_console);
-  bool Start(struct SubprocessSet* set, const string& command, int extra_fd);
+  bool Start(struct SubprocessSet* set, const string& command, int extra_fd,
+             const string& cgroup);
   void OnPipeReady();
 
   string buf_;
@@ -85,13 +90,22 @@ struct SubprocessSet {
   ~SubprocessSet();
 
   Subprocess* Add(const string& command, bool use_console = false,
-                  int extra_fd = -1);
-  bool DoWork();
+                  int extra_fd = -1, const string& cgroup = string());
+  /// Wait for a subprocess to be ready, for at most \a timeout_millis if
+  /// it isn't negative.  Returns true if interrupted.
+  bool DoWork(int timeout_millis = -1);
   Subprocess* NextFinished();
   void Clear();
 
+  /// Make DoWork() return if it is waiting, or else the next time it is
+  /// called.  Can be called from any thread.
+  void Wake();
+  /// Whether the last DoWork() returned because of Wake().
+  bool woken() const { return woken_; }
+
   vector<Subprocess*> running_;
   queue<Subprocess*> finished_;
+  bool woken_;
 
 #ifdef _WIN32
   static BOOL WINAPI NotifyInterrupted(DWORD dwCtrlType);
@@ -109,6 +123,9 @@ struct SubprocessSet {
   struct sigaction old_term_act_;
   struct sigaction old_hup_act_;
   sigset_t old_mask_;
+
+  /// Wake() writes to the second fd; DoWork() polls the first.
+  int wake_pipe_[2];
 #endif
 };
 
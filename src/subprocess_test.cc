@@ -159,6 +159,28 @@ TEST_F(SubprocessTest, Console) {
   }
 }
 
+TEST_F(SubprocessTest, PartialOutput) {
+  Subprocess* subproc = subprocs_.Add("echo one; sleep 1; echo two");
+  ASSERT_NE((Subprocess*)0, subproc);
+
+  // Wait for the first line; DoWork() times out while the command sleeps.
+  while (subproc->GetOutput().empty())
+    ASSERT_FALSE(subprocs_.DoWork(100));
+  EXPECT_FALSE(subprocs_.DoWork(100));
+  EXPECT_FALSE(subproc->Done());
+
+  string output = "stale";
+  subproc->TakeOutput(&output);
+  EXPECT_EQ("one\n", output);
+  EXPECT_EQ("", subproc->GetOutput());
+
+  // The rest of the output doesn't repeat what was taken.
+  while (!subproc->Done())
+    subprocs_.DoWork();
+  EXPECT_EQ(ExitSuccess, subproc->Finish());
+  EXPECT_EQ("two\n", subproc->GetOutput());
+}
+
 #endif
 
 TEST_F(SubprocessTest, SetWithSingle) {
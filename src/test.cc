@@ -142,12 +142,14 @@ void VerifyGraph(const State& state) {
 
 void VirtualFileSystem::Create(const string& path,
                                const string& contents) {
+  std::lock_guard<std::mutex> lock(mutex_);
   files_[path].mtime = now_;
   files_[path].contents = contents;
   files_created_.insert(path);
 }
 
 TimeStamp VirtualFileSystem::Stat(const string& path, string* err) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   FileMap::const_iterator i = files_.find(path);
   if (i != files_.end()) {
     *err = i->second.stat_error;
@@ -156,12 +158,21 @@ TimeStamp VirtualFileSystem::Stat(const string& path, string* err) const {
   return 0;
 }
 
+int64_t VirtualFileSystem::FileSize(const string& path) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FileMap::const_iterator i = files_.find(path);
+  if (i == files_.end())
+    return -1;
+  return i->second.contents.size();
+}
+
 bool VirtualFileSystem::WriteFile(const string& path, const string& contents) {
   Create(path, contents);
   return true;
 }
 
 bool VirtualFileSystem::MakeDir(const string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
   directories_made_.push_back(path);
   return true;  // success
 }
@@ -169,6 +180,7 @@ bool VirtualFileSystem::MakeDir(const string& path) {
 FileReader::Status VirtualFileSystem::ReadFile(const string& path,
                                                string* contents,
                                                string* err) {
+  std::lock_guard<std::mutex> lock(mutex_);
   files_read_.push_back(path);
   FileMap::iterator i = files_.find(path);
   if (i != files_.end()) {
@@ -180,6 +192,7 @@ FileReader::Status VirtualFileSystem::ReadFile(const string& path,
 }
 
 int VirtualFileSystem::RemoveFile(const string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (find(directories_made_.begin(), directories_made_.end(), path)
       != directories_made_.end())
     return -1;
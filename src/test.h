@@ -15,6 +15,8 @@
 #ifndef NINJA_TEST_H_
 #define NINJA_TEST_H_
 
+#include <mutex>
+
 #include "disk_interface.h"
 #include "manifest_parser.h"
 #include "state.h"
@@ -146,6 +148,7 @@ struct VirtualFileSystem : public DiskInterface {
 
   // DiskInterface
   virtual TimeStamp Stat(const string& path, string* err) const;
+  virtual int64_t FileSize(const string& path) const;
   virtual bool WriteFile(const string& path, const string& contents);
   virtual bool MakeDir(const string& path);
   virtual Status ReadFile(const string& path, string* contents, string* err);
@@ -167,6 +170,10 @@ struct VirtualFileSystem : public DiskInterface {
 
   /// A simple fake timestamp for file operations.
   int now_;
+
+  /// The builder can make directories and write response files from other
+  /// threads, so the DiskInterface methods lock this.
+  mutable std::mutex mutex_;
 };
 
 struct ScopedTempDir {
@@ -0,0 +1,272 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// It's easiest just to ask for the printf format macros right away.
+#ifndef _WIN32
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#endif
+
+#include "trace.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <inttypes.h>
+#endif
+
+#include <algorithm>
+
+#include "build_log.h"
+#include "graph.h"
+#include "json.h"
+#include "metrics.h"
+
+namespace {
+
+/// The row of the phases of ninja's own work; job slots follow.
+const int kNinjaTid = 0;
+
+string SlotName(int slot) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "job slot %d", slot + 1);
+  return buf;
+}
+
+/// A command from the build log, with the outputs it wrote.
+struct LoggedCommand {
+  const BuildLog::LogEntry* entry;
+  string outputs;
+};
+
+bool CompareStartTime(const LoggedCommand& a, const LoggedCommand& b) {
+  return a.entry->start_time < b.entry->start_time;
+}
+
+}  // anonymous namespace
+
+TraceWriter::TraceWriter(FILE* file) : file_(file), first_(true) {
+  fputs("[", file_);
+}
+
+TraceWriter::~TraceWriter() {
+  Close();
+}
+
+void TraceWriter::Event(const string& json) {
+  fputs(first_ ? "\n" : ",\n", file_);
+  fputs(json.c_str(), file_);
+  first_ = false;
+}
+
+void TraceWriter::ThreadName(int tid, const string& name) {
+  char buf[64];
+  snprintf(buf, sizeof(buf),
+           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+           "\"args\":{\"name\":", tid);
+  string json = buf;
+  AppendJSONString(name, &json);
+  json += "}}";
+  Event(json);
+}
+
+void TraceWriter::Complete(const string& name, const char* category, int tid,
+                           int64_t start_millis, int64_t end_millis,
+                           const string& args) {
+  string json = "{\"name\":";
+  AppendJSONString(name, &json);
+  char buf[128];
+  snprintf(buf, sizeof(buf),
+           ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+           "\"ts\":%" PRIu64 ",\"dur\":%" PRIu64,
+           category, tid, (uint64_t)start_millis * 1000,
+           (uint64_t)(end_millis - start_millis) * 1000);
+  json += buf;
+  if (!args.empty())
+    json += ",\"args\":" + args;
+  json += "}";
+  Event(json);
+}
+
+bool TraceWriter::Close() {
+  if (!file_)
+    return true;
+  fputs("\n]\n", file_);
+  bool success = fflush(file_) == 0 && !ferror(file_);
+  file_ = NULL;
+  return success;
+}
+
+void WriteBuildLogTrace(const BuildLog& build_log, TraceWriter* writer) {
+  // The outputs of one command are logged one after the other, with the
+  // same times and command.
+  vector<LoggedCommand> commands;
+  const vector<BuildLog::LogEntry*>& entries = build_log.last_build_entries();
+  for (vector<BuildLog::LogEntry*>::const_iterator i = entries.begin();
+       i != entries.end(); ++i) {
+    if (!commands.empty()) {
+      const BuildLog::LogEntry* prev = commands.back().entry;
+      if (prev->start_time == (*i)->start_time &&
+          prev->end_time == (*i)->end_time &&
+          prev->command_hash == (*i)->command_hash) {
+        commands.back().outputs += ", " + (*i)->output;
+        continue;
+      }
+    }
+    LoggedCommand command = { *i, (*i)->output };
+    commands.push_back(command);
+  }
+
+  // Sort by start time, then put each command in the first slot that is
+  // free by then.
+  stable_sort(commands.begin(), commands.end(), CompareStartTime);
+
+  vector<int> slot_end_times;
+  for (vector<LoggedCommand>::iterator i = commands.begin();
+       i != commands.end(); ++i) {
+    const BuildLog::LogEntry* command = i->entry;
+    size_t slot = 0;
+    while (slot < slot_end_times.size() &&
+           slot_end_times[slot] > command->start_time)
+      ++slot;
+    if (slot == slot_end_times.size()) {
+      slot_end_times.push_back(0);
+      writer->ThreadName(slot + 1, SlotName(slot));
+    }
+    slot_end_times[slot] = command->end_time;
+    writer->Complete(i->outputs, "command", slot + 1, command->start_time,
+                     command->end_time);
+  }
+}
+
+BuildTrace::BuildTrace()
+    : file_(NULL), writer_(NULL), start_millis_(GetTimeMillis()),
+      build_started_millis_(0) {}
+
+BuildTrace::~BuildTrace() {
+  string err;
+  Close(&err);
+}
+
+bool BuildTrace::Open(const string& path, string* err) {
+  file_ = fopen(path.c_str(), "wb");
+  if (!file_) {
+    *err = strerror(errno);
+    return false;
+  }
+  path_ = path;
+  start_millis_ = GetTimeMillis();
+  writer_ = new TraceWriter(file_);
+  writer_->ThreadName(kNinjaTid, "ninja");
+  return true;
+}
+
+bool BuildTrace::Close(string* err) {
+  if (!file_)
+    return true;
+  bool success = writer_->Close();
+  delete writer_;
+  writer_ = NULL;
+  if (fclose(file_) != 0)
+    success = false;
+  file_ = NULL;
+  if (!success)
+    *err = "writing " + path_ + ": " + strerror(errno);
+  return success;
+}
+
+int64_t BuildTrace::Now() const {
+  return GetTimeMillis() - start_millis_;
+}
+
+void BuildTrace::Phase(const char* name, int64_t start_millis) {
+  if (!writer_)
+    return;
+  writer_->Complete(name, "ninja", kNinjaTid, start_millis - start_millis_,
+                    Now());
+}
+
+void BuildTrace::BuildStarted() {
+  build_started_millis_ = Now();
+}
+
+void BuildTrace::EdgeStarted(Edge* edge) {
+  if (!writer_)
+    return;
+  int64_t now = Now();
+
+  // The edge became ready when the last of the edges it depends on was
+  // done, or when the build started.
+  int64_t ready_millis = build_started_millis_;
+  for (vector<Node*>::iterator i = edge->inputs_.begin();
+       i != edge->inputs_.end(); ++i) {
+    if (!(*i)->in_edge())
+      continue;
+    map<Edge*, int64_t>::iterator finished =
+        finished_millis_.find((*i)->in_edge());
+    if (finished != finished_millis_.end())
+      ready_millis = max(ready_millis, finished->second);
+  }
+
+  // Phony edges finish as soon as they start.
+  if (edge->is_phony()) {
+    finished_millis_[edge] = ready_millis;
+    return;
+  }
+
+  size_t slot = find(slots_.begin(), slots_.end(), false) - slots_.begin();
+  if (slot == slots_.size()) {
+    slots_.push_back(false);
+    writer_->ThreadName(slot + 1, SlotName(slot));
+  }
+  slots_[slot] = true;
+  Running running = { (int)slot, now, ready_millis };
+  running_[edge] = running;
+}
+
+void BuildTrace::EdgeFinished(Edge* edge, bool success, int64_t cpu_micros,
+                              int64_t peak_memory_bytes) {
+  if (!writer_)
+    return;
+  map<Edge*, Running>::iterator i = running_.find(edge);
+  if (i == running_.end())
+    return;
+  int64_t now = Now();
+  finished_millis_[edge] = now;
+  slots_[i->second.slot] = false;
+
+  string name = edge->GetBinding("description");
+  if (name.empty())
+    name = edge->outputs_[0]->path();
+  char buf[64];
+  snprintf(buf, sizeof(buf), "{\"queued_ms\":%" PRIu64,
+           (uint64_t)(i->second.start_millis - i->second.ready_millis));
+  string args = buf;
+  if (cpu_micros >= 0) {
+    snprintf(buf, sizeof(buf), ",\"cpu_ms\":%" PRIu64,
+             (uint64_t)cpu_micros / 1000);
+    args += buf;
+  }
+  if (peak_memory_bytes >= 0) {
+    snprintf(buf, sizeof(buf), ",\"peak_memory_kb\":%" PRIu64,
+             (uint64_t)peak_memory_bytes / 1024);
+    args += buf;
+  }
+  args += success ? ",\"success\":true}" : ",\"success\":false}";
+  writer_->Complete(name, edge->rule().name().c_str(), i->second.slot + 1,
+                    i->second.start_millis, now, args);
+  running_.erase(i);
+}
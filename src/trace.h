@@ -0,0 +1,113 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NINJA_TRACE_H_
+#define NINJA_TRACE_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "util.h"  // int64_t
+
+struct BuildLog;
+struct Edge;
+
+/// Writes events in the Chrome trace event format, as read by
+/// chrome://tracing and Perfetto.  Each event is drawn on a row ("thread")
+/// identified by \a tid.
+struct TraceWriter {
+  /// Start writing events to \a file, which stays owned by the caller.
+  explicit TraceWriter(FILE* file);
+  /// Finish the trace, if Close() wasn't called.
+  ~TraceWriter();
+
+  /// Name the row \a tid.
+  void ThreadName(int tid, const string& name);
+
+  /// An event from \a start_millis to \a end_millis.  \a args, if not empty,
+  /// is a JSON object with details shown for the event.
+  void Complete(const string& name, const char* category, int tid,
+                int64_t start_millis, int64_t end_millis,
+                const string& args = string());
+
+  /// Finish the trace.  Returns false, with errno set, if writing failed.
+  bool Close();
+
+ private:
+  void Event(const string& json);
+
+  FILE* file_;
+  bool first_;
+};
+
+/// Convert the timings of the last build in \a build_log to trace events.
+/// Commands are laid out on as few rows as possible, like the job slots
+/// that ran them.
+void WriteBuildLogTrace(const BuildLog& build_log, TraceWriter* writer);
+
+/// Records a build as it runs: the phases of ninja's own work and every
+/// command, on the row of the job slot it ran in and with the time it
+/// waited for a slot after its inputs were ready.
+struct BuildTrace {
+  BuildTrace();
+  ~BuildTrace();
+
+  /// Start writing the trace to \a path.
+  bool Open(const string& path, string* err);
+  /// Finish writing the trace.
+  bool Close(string* err);
+
+  /// Record a phase of ninja's own work, such as loading the manifest, that
+  /// started at \a start_millis, as returned by GetTimeMillis(), and ends
+  /// now.
+  void Phase(const char* name, int64_t start_millis);
+
+  /// Note that a build started now, so that commands whose inputs were all
+  /// there are counted as ready from this point.
+  void BuildStarted();
+  void EdgeStarted(Edge* edge);
+  /// \a cpu_micros and \a peak_memory_bytes are what the command used, if
+  /// known, or -1.
+  void EdgeFinished(Edge* edge, bool success, int64_t cpu_micros = -1,
+                    int64_t peak_memory_bytes = -1);
+
+ private:
+  /// Milliseconds since the trace was opened.
+  int64_t Now() const;
+
+  string path_;
+  FILE* file_;
+  TraceWriter* writer_;
+  int64_t start_millis_;
+  int64_t build_started_millis_;
+
+  /// Whether each job slot is running a command.
+  vector<bool> slots_;
+
+  struct Running {
+    int slot;
+    int64_t start_millis;
+    int64_t ready_millis;
+  };
+  map<Edge*, Running> running_;
+  /// When edges finished, to know when the edges using their outputs
+  /// became ready.
+  map<Edge*, int64_t> finished_millis_;
+};
+
+#endif  // NINJA_TRACE_H_
@@ -0,0 +1,98 @@
+// Copyright 2016 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trace.h"
+
+#include "build_log.h"
+#include "util.h"
+#include "test.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kTestFilename[] = "TraceTest-tempfile";
+
+struct TraceTest : public testing::Test {
+  virtual void SetUp() {
+    // In case a crashing test left a stale file behind.
+    unlink(kTestFilename);
+  }
+  virtual void TearDown() {
+    unlink(kTestFilename);
+  }
+
+  string Contents() {
+    string contents, err;
+    EXPECT_EQ(0, ::ReadFile(kTestFilename, &contents, &err));
+    return contents;
+  }
+};
+
+TEST_F(TraceTest, Writer) {
+  FILE* f = fopen(kTestFilename, "wb");
+  TraceWriter writer(f);
+  writer.ThreadName(1, "job slot 1");
+  writer.Complete("out \"quoted\"", "cc", 1, 5, 7, "{\"x\":1}");
+  EXPECT_TRUE(writer.Close());
+  fclose(f);
+
+  EXPECT_EQ(
+"[\n"
+"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,"
+"\"args\":{\"name\":\"job slot 1\"}},\n"
+"{\"name\":\"out \\\"quoted\\\"\",\"cat\":\"cc\",\"ph\":\"X\",\"pid\":0,"
+"\"tid\":1,\"ts\":5000,\"dur\":2000,\"args\":{\"x\":1}}\n"
+"]\n", Contents());
+}
+
+TEST_F(TraceTest, BuildLog) {
+  FILE* f = fopen(kTestFilename, "wb");
+  fprintf(f, "# ninja log v5\n"
+             // An older build, which isn't traced.
+             "0\t100\t0\told\t1\n"
+             // The last build: b and c run in parallel, then d takes the
+             // first free slot; e1 and e2 are outputs of one command.
+             "0\t10\t0\tb\t2\n"
+             "5\t20\t0\tc\t3\n"
+             "12\t30\t0\td\t4\n"
+             "31\t40\t0\te1\t5\n"
+             "31\t40\t0\te2\t5\n");
+  fclose(f);
+
+  BuildLog log;
+  string err;
+  EXPECT_TRUE(log.Load(kTestFilename, &err));
+  ASSERT_EQ("", err);
+  ASSERT_EQ(5u, log.last_build_entries().size());
+
+  f = fopen(kTestFilename, "wb");
+  TraceWriter writer(f);
+  WriteBuildLogTrace(log, &writer);
+  EXPECT_TRUE(writer.Close());
+  fclose(f);
+
+  string trace = Contents();
+  EXPECT_EQ(string::npos, trace.find("\"old\""));
+  EXPECT_NE(string::npos, trace.find("\"job slot 2\""));
+  EXPECT_EQ(string::npos, trace.find("\"job slot 3\""));
+  EXPECT_NE(string::npos,
+            trace.find("\"name\":\"d\",\"cat\":\"command\",\"ph\":\"X\","
+                       "\"pid\":0,\"tid\":1,\"ts\":12000"));
+  EXPECT_NE(string::npos, trace.find("\"name\":\"e1, e2\""));
+}
+
+}  // anonymous namespace
@@ -617,6 +617,23 @@ string ElideMiddle(const string& str, size_t width) {
   return result;
 }
 
+string FormatBytes(int64_t bytes) {
+  char buf[32];
+  if (bytes < 1024) {
+    snprintf(buf, sizeof(buf), "%d bytes", (int)bytes);
+    return buf;
+  }
+  const char* kUnits[] = { "KiB", "MiB", "GiB", "TiB" };
+  double size = bytes / 1024.0;
+  size_t unit = 0;
+  while (size >= 1024 && unit + 1 < sizeof(kUnits) / sizeof(kUnits[0])) {
+    size /= 1024;
+    ++unit;
+  }
+  snprintf(buf, sizeof(buf), "%.1f %s", size, kUnits[unit]);
+  return buf;
+}
+
 bool Truncate(const string& path, size_t size, string* err) {
 #ifdef _WIN32
   int fh = _sopen(path.c_str(), _O_RDWR | _O_CREAT, _SH_DENYNO,
@@ -634,3 +651,17 @@ bool Truncate(const string& path, size_t size, string* err) {
   }
   return true;
 }
+
+bool RenameOverwriting(const string& from, const string& to, string* err) {
+#ifdef _WIN32
+  if (unlink(to.c_str()) < 0 && errno != ENOENT) {
+    *err = strerror(errno);
+    return false;
+  }
+#endif
+  if (rename(from.c_str(), to.c_str()) < 0) {
+    *err = strerror(errno);
+    return false;
+  }
+  return true;
+}
@@ -95,9 +95,17 @@ double GetLoadAverage();
 /// exceeds @a width.
 string ElideMiddle(const string& str, size_t width);
 
+/// Format @a bytes for people, e.g. "512 bytes" or "1.5 MiB".
+string FormatBytes(int64_t bytes);
+
 /// Truncates a file to the given size.
 bool Truncate(const string& path, size_t size, string* err);
 
+/// Renames \a from to \a to, replacing any existing file.  This is atomic
+/// on POSIX; Windows' rename() won't replace, so the old file is removed
+/// first there.
+bool RenameOverwriting(const string& from, const string& to, string* err);
+
 #ifdef _MSC_VER
 #define snprintf _snprintf
 #define fileno _fileno
@@ -416,6 +416,14 @@ TEST(StripAnsiEscapeCodes, StripColors) {
             stripped);
 }
 
+TEST(FormatBytes, Units) {
+  EXPECT_EQ("0 bytes", FormatBytes(0));
+  EXPECT_EQ("1023 bytes", FormatBytes(1023));
+  EXPECT_EQ("1.0 KiB", FormatBytes(1024));
+  EXPECT_EQ("1.5 MiB", FormatBytes(3 * 512 * 1024));
+  EXPECT_EQ("2048.0 TiB", FormatBytes((int64_t)2 << 50));
+}
+
 TEST(ElideMiddle, NothingToElide) {
   string input = "Nothing to elide in this short string.";
   EXPECT_EQ(input, ElideMiddle(input, 80));
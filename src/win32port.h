@@ -21,8 +21,9 @@ typedef unsigned short uint16_t;
 typedef signed long long int64_t;
 typedef unsigned long long uint64_t;
 
-// printf format specifier for uint64_t, from C99.
+// printf format specifiers for int64_t and uint64_t, from C99.
 #ifndef PRIu64
+#define PRId64 "I64d"
 #define PRIu64 "I64u"
 #define PRIx64 "I64x"
 #endif